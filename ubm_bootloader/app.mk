@@ -28,6 +28,29 @@ INCLUDES+=\
      $(MBEDTLS_PATH)/include\
      $(MBEDTLS_PATH)/library\
 
+################################################################################
+# Crypto Hardware Acceleration Files
+################################################################################
+
+# The mbedtls *_ALT implementations on top of the PSoC 6 Crypto block. They
+# replace the software SHA-256 and ECDSA verification used by the image
+# validation; everything else stays on the software mbedtls code above.
+ifeq ($(USE_CRYPTO_HW), 1)
+CRYPTO_ACC_PATH=$(MCUBOOT_PATH)/ext/cy-mbedtls-acceleration
+
+# Only the Crypto block driver glue and the two enabled *_ALT modules. The
+# other modules of the directory (AES, SHA-1, SHA-512, ECP, TRNG) are not
+# enabled by crypto_hw_acc_config.h and are left out of the build.
+SOURCES+=\
+     $(CRYPTO_ACC_PATH)/mbedtls_MXCRYPTO/crypto_common.c\
+     $(CRYPTO_ACC_PATH)/mbedtls_MXCRYPTO/sha256_alt.c\
+     $(CRYPTO_ACC_PATH)/mbedtls_MXCRYPTO/ecdsa_alt.c
+
+INCLUDES+=\
+     $(CRYPTO_ACC_PATH)\
+     $(CRYPTO_ACC_PATH)/mbedtls_MXCRYPTO
+endif
+
 ################################################################################
 # MCUboot Files
 ################################################################################
@@ -47,10 +70,12 @@ SOURCES+=\
     $(MCUBOOT_UTIL_PATH)/cyw_platform_utils.c
 
 # Do not include QSPI API from flash PAL when external flash is not used.
+# The QSPI adaptation layer is the one shared with ubm_controller, which
+# supports bringing up the SMIF on first use (see flash_qspi_ext.h).
 ifeq ($(USE_EXTERNAL_FLASH), 1)  
 SOURCES+=\
     $(wildcard $(MCUBOOT_CY_PATH)/platforms/cy_flash_pal/flash_psoc6/cy_smif_psoc6.c)\
-    $(wildcard $(MCUBOOT_CY_PATH)/platforms/cy_flash_pal/flash_psoc6/flash_qspi/*.c)
+    ../ubm_controller/source/flash_qspi.c
 endif
     
 INCLUDES+=\
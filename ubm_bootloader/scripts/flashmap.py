@@ -5,6 +5,7 @@ Copyright (c) 2022 Infineon Technologies AG
 import sys
 import getopt
 import json
+import csv
 
 # Supported Platforms
 cm0pCore = {
@@ -36,6 +37,9 @@ allCores_PSOC_06x = {**cm0pCore, **cm4Core}
 common_PSOC_061 = {
     'flashAddr': 0x10000000,
     'eraseSize': 0x200,  # 512 bytes
+    'rowEraseTime': 11,  # ms (max)
+    'rowProgramTime': 5,  # ms (max)
+    'hashTime': 0.4,  # SHA-256 of 1 KiB in software at 100 MHz, ms (approx.)
     'smifAddr': 0x18000000,
     'smifSize': 0x8000000,  # i.e., window size
     'VTAlign': 0x400,  # Vector Table alignment
@@ -47,6 +51,9 @@ common_PSOC_061 = {
 common_PSOC_06x = {
     'flashAddr': 0x10000000,
     'eraseSize': 0x200,  # 512 bytes
+    'rowEraseTime': 11,  # ms (max)
+    'rowProgramTime': 5,  # ms (max)
+    'hashTime': 0.4,  # SHA-256 of 1 KiB in software at 100 MHz, ms (approx.)
     'smifAddr': 0x18000000,
     'smifSize': 0x8000000,  # i.e., window size
     'VTAlign': 0x400,  # Vector Table alignment
@@ -182,6 +189,16 @@ class CmdLineParams:
         self.img_id = None
         self.policy = None
         self.set_core = False
+        self.optimize = False
+        self.strategy = 'swap'
+        self.boot_size = 0x18000
+        self.reserve = 0
+        self.estimate = False
+        self.image_size = None
+        self.csv_file = None
+        self.ext_timing = None
+        self.status_encoding = 'row'
+        self.hash_time = None
 
         usage = 'USAGE:\n' + sys.argv[0] + \
                 ''' -p <platform> -i <flash_map.json> -o <flash_map.h> -d <img_id>
@@ -194,12 +211,31 @@ OPTIONS:
 -d  --img_id     ID of application to build
 -c  --policy     Policy file in JSON format
 -m  --core       Detect and set Cortex-M CORE
+-O  --optimize   Write the internal flash layout with the largest slots to
+                 <flash_map.json> given with -o (no -i needed)
+    --strategy=  Upgrade strategy for -O: swap (default), overwrite, direct_xip
+    --boot-size= Minimum bootloader size for -O (default 0x18000)
+    --reserve=   Bytes kept free at the end of the flash for -O, e.g. for
+                 emulated EEPROM (default 0)
+-e  --estimate   Print the best and worst case upgrade duration of the flash
+                 map instead of the make variables
+    --image-size= Image size for the best case (default: slot size)
+    --csv=       Write the per-phase estimate to a CSV file
+    --ext-timing= External flash sector erase and page program times in ms,
+                 e.g. 400,3 (needed for slots in external flash)
+    --status=    Swap status encoding for -e: row (default), or compact to
+                 compare with an appended status journal
+    --hash-time= SHA-256 time of the image validation in ms per KiB, e.g.
+                 for the Crypto block (default: platform estimate)
 '''
 
         try:
             opts, unused = getopt.getopt(
-                sys.argv[1:], 'hi:o:p:d:c:m',
-                ['help', 'platform=', 'ifile=', 'ofile=', 'img_id=', 'policy=', 'core'])
+                sys.argv[1:], 'hi:o:p:d:c:mOe',
+                ['help', 'platform=', 'ifile=', 'ofile=', 'img_id=', 'policy=', 'core',
+                 'optimize', 'strategy=', 'boot-size=', 'reserve=',
+                 'estimate', 'image-size=', 'csv=', 'ext-timing=', 'status=',
+                 'hash-time='])
             if len(unused) > 0:
                 print(usage, file=sys.stderr)
                 sys.exit(1)
@@ -223,8 +259,48 @@ OPTIONS:
                 self.policy = arg
             elif opt in ('-m', '--core'):
                 self.set_core = True
+            elif opt in ('-O', '--optimize'):
+                self.optimize = True
+            elif opt == '--strategy':
+                self.strategy = arg.lower()
+            elif opt == '--boot-size':
+                self.boot_size = cvt_dec_or_hex(arg, 'boot-size')
+            elif opt == '--reserve':
+                self.reserve = cvt_dec_or_hex(arg, 'reserve')
+            elif opt in ('-e', '--estimate'):
+                self.estimate = True
+            elif opt == '--image-size':
+                self.image_size = cvt_dec_or_hex(arg, 'image-size')
+            elif opt == '--csv':
+                self.csv_file = arg
+            elif opt == '--ext-timing':
+                try:
+                    erase_ms, program_ms = arg.split(',')
+                    self.ext_timing = (float(erase_ms), float(program_ms))
+                except ValueError:
+                    print('Invalid value', arg, 'for ext-timing',
+                          file=sys.stderr)
+                    sys.exit(6)
+            elif opt == '--status':
+                self.status_encoding = arg.lower()
+            elif opt == '--hash-time':
+                try:
+                    self.hash_time = float(arg)
+                except ValueError:
+                    print('Invalid value', arg, 'for hash-time',
+                          file=sys.stderr)
+                    sys.exit(6)
+
+        if self.strategy not in ('swap', 'overwrite', 'direct_xip') or \
+                self.status_encoding not in ('row', 'compact'):
+            print(usage, file=sys.stderr)
+            sys.exit(1)
 
-        if len(self.in_file) == 0 or len(self.out_file) == 0:
+        if self.optimize and len(self.in_file) == 0:
+            self.in_file = None
+
+        if (self.in_file is not None and len(self.in_file) == 0) or \
+                len(self.out_file) == 0:
             print(usage, file=sys.stderr)
             sys.exit(1)
 
@@ -431,6 +507,9 @@ class AreaList:
     def generate_c_source(self, params):
         """Generate C source"""
         c_array = 'flash_areas'
+        c_lookup = 'flash_area_by_id'
+
+        areas = [area for area in self.areas if area['fa_id'] is not None]
 
         try:
             with open(params.out_file, "w", encoding='UTF-8') as out_f:
@@ -438,27 +517,76 @@ class AreaList:
                             ' ALL CHANGES WILL BE LOST! */\n\n'
                             '#ifndef CY_FLASH_MAP_H\n#define CY_FLASH_MAP_H\n')
                 out_f.write(f'\n/* Platform: {params.plat_id} */\n')
-                out_f.write(f'\nstatic struct flash_area {c_array}[] = {{\n')
-                comma = len(self.areas)
-                area_count = 0
-                for area in self.areas:
+                out_f.write(f'\nstatic const struct flash_area {c_array}[] = {{\n')
+                comma = len(areas)
+                for area in areas:
                     comma -= 1
-                    if area['fa_id'] is not None:
-                        sss = ' /* Shared secondary slot */' \
-                            if area['shared_slot'] else ''
-                        out_f.writelines('\n'.join([
-                            '    {' + sss,
-                            f"        .fa_id        = {area['fa_id']},",
-                            f"        .fa_device_id = {area['fa_device_id']},",
-                            f"        .fa_off       = {hex(area['fa_off'])}U,",
-                            f"        .fa_size      = {hex(area['fa_size'])}U",
-                            '    },' if comma else '    }', '']))
-                        area_count += 1
+                    sss = ' /* Shared secondary slot */' \
+                        if area['shared_slot'] else ''
+                    out_f.writelines('\n'.join([
+                        '    {' + sss,
+                        f"        .fa_id        = {area['fa_id']},",
+                        f"        .fa_device_id = {area['fa_device_id']},",
+                        f"        .fa_off       = {hex(area['fa_off'])}U,",
+                        f"        .fa_size      = {hex(area['fa_size'])}U",
+                        '    },' if comma else '    }', '']))
+                out_f.write('};\n\n')
+
+                # The areas are placed in flash, a table made writable again
+                # would silently move them back to RAM
+                out_f.write(f'_Static_assert(_Generic(&{c_array}[0], '
+                            'const struct flash_area *: 1, default: 0),\n'
+                            f'               "{c_array} must be const");\n')
+
+                # Layout checks repeated for the compiler, so that a hand
+                # edited header does not go unnoticed. External areas may be
+                # unaligned when their peer is (see process_ext_area()), this
+                # is only checked here.
+                for area in areas:
+                    if area['fa_device_id'] == 'FLASH_DEVICE_INTERNAL_FLASH':
+                        out_f.write(
+                            f"_Static_assert(({hex(area['fa_off'])}U % "
+                            'CY_FLASH_SIZEOF_ROW) == 0U,\n'
+                            f"               \"{area['title']} is not "
+                            'aligned to the flash row\");\n')
+                for idx, area in enumerate(areas):
+                    for peer in areas[idx + 1:]:
+                        if area['fa_device_id'] != peer['fa_device_id'] or \
+                                (area['shared_slot'] and peer['shared_slot']):
+                            continue
+                        out_f.write(
+                            f"_Static_assert((({hex(area['fa_off'])}U + "
+                            f"{hex(area['fa_size'])}U) <= "
+                            f"{hex(peer['fa_off'])}U) ||\n"
+                            f"               (({hex(peer['fa_off'])}U + "
+                            f"{hex(peer['fa_size'])}U) <= "
+                            f"{hex(area['fa_off'])}U),\n"
+                            f"               \"{area['title']} overlaps "
+                            f"with {peer['title']}\");\n")
+
+                # bootutil expects mutable pointers, the areas are never
+                # written through them
+                out_f.write('\nstruct flash_area *boot_area_descs[] = {\n')
+                for area_index in range(len(areas)):
+                    out_f.write('    (struct flash_area *)'
+                                f'&{c_array}[{area_index}U],\n')
+                out_f.write('    NULL\n};\n')
+
+                # Table of the constant time flash_area_open() in
+                # flash_area_open.c. The flash PAL includes this header, its
+                # own linear search of boot_area_descs[] is made weak so that
+                # its internal calls are replaced as well.
+                out_f.write('\n#if defined(CY_FLASH_MAP_OPEN_BY_ID)\n'
+                            '#pragma weak flash_area_open\n\n'
+                            f'const struct flash_area * const {c_lookup}[] = {{\n')
+                for area_index, area in enumerate(areas):
+                    out_f.write(f"    [{area['fa_id']}] = "
+                                f'&{c_array}[{area_index}U],\n')
                 out_f.write('};\n\n'
-                            'struct flash_area *boot_area_descs[] = {\n')
-                for area_index in range(area_count):
-                    out_f.write(f'    &{c_array}[{area_index}U],\n')
-                out_f.write('    NULL\n};\n\n#endif /* CY_FLASH_MAP_H */\n')
+                            f'const uint32_t {c_lookup}_count =\n'
+                            f'    sizeof({c_lookup}) / sizeof({c_lookup}[0]);\n'
+                            '#endif /* CY_FLASH_MAP_OPEN_BY_ID */\n')
+                out_f.write('\n#endif /* CY_FLASH_MAP_H */\n')
         except (FileNotFoundError, OSError):
             print('Cannot create', params.out_file, file=sys.stderr)
             sys.exit(4)
@@ -558,6 +686,333 @@ def calc_status_size(boot_swap_status_row_sz, max_img_sectors,
     return boot_swap_status_size * status_zone_cnt
 
 
+def align_up(val, align):
+    """Round up to a multiple of align"""
+    return (val + align - 1) // align * align
+
+
+class UpgradeModel:
+    """Flash operation costs of an upgrade, in ms. Internal flash is written
+    in rows, external flash in sectors (erase) and 256-byte pages (program).
+
+    The 'row' status encoding is the one of the bootloader: every swap status
+    update rewrites a status row. The 'compact' one is a journal of 4-byte
+    records (sector, state, CRC-8) programmed into an erased row behind a
+    header, a row is only erased when it is full. A record torn by a power
+    failure fails its CRC and the previous one stands. The records clear
+    bits of the erased row, so this only applies to the external flash: the
+    internal flash erases to 0 and a row is programmed as a whole."""
+
+    ext_page_size = 0x100
+    journal_header_size = 16
+    journal_record_size = 4
+
+    def __init__(self, plat, flash=None, ext_timing=None,
+                 status_encoding='row', hash_time=None):
+        self.plat = plat
+        self.flash = flash
+        self.ext_timing = ext_timing
+        self.status_encoding = status_encoding
+        self.hash_time = plat['hashTime'] if hash_time is None else hash_time
+
+    def is_ext(self, addr):
+        """Check whether an address is in the external flash"""
+        return self.plat['flashSize'] == 0 or \
+            addr >= self.plat['smifAddr']
+
+    def cost(self, addr, size):
+        """Erase and program time of size bytes at addr"""
+        if not self.is_ext(addr):
+            rows = (size + self.plat['eraseSize'] - 1) // self.plat['eraseSize']
+            return rows * self.plat['rowEraseTime'], \
+                rows * self.plat['rowProgramTime']
+        if self.ext_timing is None:
+            print('External flash timing is needed, see --ext-timing',
+                  file=sys.stderr)
+            sys.exit(1)
+        sectors = (size + self.flash['eraseSize'] - 1) // self.flash['eraseSize']
+        pages = (size + self.ext_page_size - 1) // self.ext_page_size
+        return sectors * self.ext_timing[0], pages * self.ext_timing[1]
+
+    def row_size(self, addr):
+        """Smallest unit written at addr"""
+        return self.flash['eraseSize'] if self.is_ext(addr) \
+            else self.plat['eraseSize']
+
+    def is_compact_status(self, status):
+        """Check whether the compact status encoding applies at status"""
+        return self.status_encoding == 'compact' and self.is_ext(status)
+
+    def status_phases(self, status, updates):
+        """Phases of writing updates swap status updates"""
+        row = self.row_size(status)
+        if not self.is_compact_status(status):
+            status_row = self.cost(status, row)
+            return [('swap status', updates * status_row[0],
+                     updates * status_row[1], 0, updates)]
+        records = (row - self.journal_header_size) // self.journal_record_size
+        rows = (updates + records - 1) // records
+        erase_ms = self.cost(status, row)[0]
+        page_ms = self.ext_timing[1]
+        return [('swap status', rows * (erase_ms + page_ms), 0, 0, rows),
+                ('swap status append', 0, updates * page_ms, 0, updates)]
+
+    def status_ops(self, status, updates):
+        """(erases, programs) of writing updates swap status updates. A
+        program is a page of the external flash or a row of the internal
+        flash."""
+        row = self.row_size(status)
+        programs = (row + self.ext_page_size - 1) // self.ext_page_size \
+            if self.is_ext(status) else 1
+        if not self.is_compact_status(status):
+            return updates, updates * programs
+        records = (row - self.journal_header_size) // self.journal_record_size
+        rows = (updates + records - 1) // records
+        return rows, rows + updates
+
+    def status_updates(self, strategy, image_size, scratch_size):
+        """Swap status updates of one upgrade, see phases()"""
+        if strategy != 'swap':
+            return 0
+        return 3 * ((image_size + scratch_size - 1) // scratch_size) + 4
+
+    def phases(self, strategy, slots, image_size, validate=True):
+        """List of (phase, erase_ms, program_ms, hash_ms, writes) for one
+        upgrade. slots holds the primary, secondary, scratch and status
+        addresses and the scratch size (0 without scratch). With validate,
+        the new image is hashed before it is installed (or, for direct-XIP,
+        booted); the signature check is not included."""
+        primary, secondary, scratch, status, scratch_size = slots
+        checks = [('validate secondary', 0, 0,
+                   image_size / 1024 * self.hash_time, 0)] if validate else []
+        if strategy == 'direct_xip':
+            return checks
+        if strategy == 'overwrite':
+            prim = self.cost(primary, image_size)
+            sec = self.cost(secondary, image_size)
+            trailer = self.cost(primary, self.row_size(primary))
+            return checks + \
+                [('secondary to primary', prim[0], prim[1], 0, 1),
+                 ('erase secondary', sec[0], 0, 0, 1),
+                 ('trailer', 2 * trailer[0], 2 * trailer[1], 0, 2)]
+        # Every scratch-sized chunk is moved three times (secondary to
+        # scratch, primary to secondary, scratch to primary), each move is
+        # followed by a swap status update; the trailer adds four more
+        chunks = (image_size + scratch_size - 1) // scratch_size
+        updates = self.status_updates(strategy, image_size, scratch_size)
+        to_scratch = self.cost(scratch, image_size)
+        to_secondary = self.cost(secondary, image_size)
+        to_primary = self.cost(primary, image_size)
+        return checks + \
+            [('secondary to scratch', to_scratch[0], to_scratch[1], 0, chunks),
+             ('primary to secondary', to_secondary[0], to_secondary[1], 0, chunks),
+             ('scratch to primary', to_primary[0], to_primary[1], 0, chunks)] + \
+            self.status_phases(status, updates)
+
+
+def phases_time(phases):
+    """Total time (ms) of a list of phases"""
+    return sum(erase_ms + program_ms + hash_ms
+               for _, erase_ms, program_ms, hash_ms, _ in phases)
+
+
+def estimate(params, model, strategy, apps_flash_map, scratch, swap_status):
+    """Print the best and worst case upgrade duration (-e). The best case
+    installs an image of --image-size, the worst case a full slot that fails
+    its test boot and is reverted by a second swap. All images are updated.
+    The hash of the image validation is included, the signature check and
+    the application restart are not.
+    With the compact status encoding the worst case is also compared with
+    the row encoding."""
+    rows = []
+    totals = {'best': 0, 'worst': 0}
+    compare = model.status_encoding == 'compact'
+    row_model = UpgradeModel(model.plat, model.flash, model.ext_timing,
+                             hash_time=model.hash_time)
+    row_worst = 0
+    # (erases, programs) of the swap status in the worst case
+    status_ops = {'row': [0, 0], 'compact': [0, 0]}
+
+    for app_index, app_flash_map in enumerate(apps_flash_map[1:], 1):
+        primary = int(app_flash_map['primary']['address'], 0)
+        secondary = int(app_flash_map['secondary']['address'], 0)
+        slot_size = int(app_flash_map['primary']['size'], 0)
+        if scratch is not None:
+            scratch_addr, scratch_size = scratch.fa_addr, scratch.fa_size
+        else:
+            scratch_addr, scratch_size = primary, model.row_size(primary)
+        status_addr = swap_status.fa_addr if swap_status is not None \
+            else primary
+        slots = (primary, secondary, scratch_addr, status_addr, scratch_size)
+        if compare and not model.is_compact_status(status_addr):
+            print('Note: the compact swap status needs bit-clearing writes,',
+                  'which the internal flash does not allow',
+                  file=sys.stderr)
+
+        image_size = slot_size if params.image_size is None \
+            else min(params.image_size, slot_size)
+        cases = [('best', 'upgrade', image_size),
+                 ('worst', 'upgrade', slot_size)]
+        if strategy == 'swap':
+            cases.append(('worst', 'revert', slot_size))
+
+        for case, step, size in cases:
+            validate = step == 'upgrade'
+            for phase, erase_ms, program_ms, hash_ms, writes in \
+                    model.phases(strategy, slots, size, validate):
+                total_ms = erase_ms + program_ms + hash_ms
+                rows.append([case, f'application_{app_index}', step, phase,
+                             writes, round(erase_ms, 1), round(program_ms, 1),
+                             round(hash_ms, 1), round(total_ms, 1)])
+                totals[case] += total_ms
+            if case == 'worst' and compare:
+                updates = model.status_updates(strategy, size, scratch_size)
+                for encoding, enc_model in (('compact', model),
+                                            ('row', row_model)):
+                    ops = enc_model.status_ops(status_addr, updates)
+                    status_ops[encoding][0] += ops[0]
+                    status_ops[encoding][1] += ops[1]
+                row_worst += phases_time(
+                    row_model.phases(strategy, slots, size, validate))
+
+    print('Upgrade mode:', strategy)
+    print('Best case downtime:', round(totals['best']), 'ms')
+    if strategy == 'swap':
+        print('Worst case downtime:', round(totals['worst']), 'ms (with revert)')
+    else:
+        print('Worst case downtime:', round(totals['worst']), 'ms')
+    if compare and strategy == 'swap':
+        print(f"Swap status erases: {status_ops['compact'][0]}, "
+              f"programs: {status_ops['compact'][1]} "
+              f"(row encoding: {status_ops['row'][0]} erases, "
+              f"{status_ops['row'][1]} programs)")
+        print('Compact swap status saves:', round(row_worst - totals['worst']),
+              'ms (worst case)')
+
+    if params.csv_file is not None:
+        try:
+            with open(params.csv_file, 'w', encoding='UTF-8',
+                      newline='') as csv_f:
+                writer = csv.writer(csv_f)
+                writer.writerow(['case', 'image', 'step', 'phase', 'writes',
+                                 'erase_ms', 'program_ms', 'hash_ms',
+                                 'total_ms'])
+                writer.writerows(rows)
+        except (FileNotFoundError, OSError):
+            print('Cannot create', params.csv_file, file=sys.stderr)
+            sys.exit(4)
+
+
+def optimize_layout(model, strategy, boot_size, reserve):
+    """Find the internal flash layout with the largest slots, and among
+    those the shortest upgrade time estimated with model for an update that
+    fills a slot"""
+    plat = model.plat
+    addr = plat['flashAddr']
+    erase = plat['eraseSize']
+    align = max(erase, plat['VTAlign'])
+    boot_size = align_up(boot_size, align)
+    avail = plat['flashSize'] - boot_size - reserve
+
+    if strategy == 'swap':
+        scratch_list = []
+        scratch = erase
+        while scratch <= avail // 4:
+            scratch_list.append(scratch)
+            scratch *= 2
+    else:
+        scratch_list = [0]
+
+    best = None
+    for scratch in scratch_list:
+        slot = (avail - scratch) // 2 // align * align
+        status = 0
+        while slot > 0:
+            if strategy == 'swap':
+                status = align_up(calc_status_size(erase, slot // erase, 1),
+                                  erase)
+            if 2 * slot + status + scratch <= avail:
+                break
+            slot -= align
+        if slot <= 0:
+            continue
+        layout = {'boot_size': boot_size,
+                  'slot_size': slot,
+                  'status_size': status,
+                  'scratch_size': scratch,
+                  'time': phases_time(model.phases(
+                      strategy, (addr, addr, addr, addr, scratch), slot))}
+        if best is None or \
+                (slot, -layout['time']) > (best['slot_size'], -best['time']):
+            best = layout
+    return best
+
+
+def write_layout(params, plat, layout):
+    """Write an optimized layout as a JSON flash map"""
+    def entry(desc, val):
+        return {'description': desc, 'value': hex(val)}
+
+    boot_addr = plat['flashAddr']
+    primary = boot_addr + layout['boot_size']
+    secondary = primary + layout['slot_size']
+    bootloader = {'address': entry('Address of the bootloader', boot_addr),
+                  'size': entry('Size of the bootloader', layout['boot_size'])}
+    if params.strategy == 'swap':
+        status = secondary + layout['slot_size']
+        scratch = status + layout['status_size']
+        bootloader.update({
+            'scratch_address': entry('Address of the scratch area', scratch),
+            'scratch_size': entry('Size of the scratch area',
+                                  layout['scratch_size']),
+            'status_address': entry('Address of the swap status partition',
+                                    status),
+            'status_size': entry('Size of the swap status partition',
+                                 layout['status_size'])})
+    elif params.strategy == 'direct_xip':
+        bootloader['direct_xip'] = {
+            'description': 'Run the newest valid image in place from either slot',
+            'value': True}
+    flash_map = {'boot_and_upgrade': {
+        'bootloader': bootloader,
+        'application_1': {
+            'address': entry('Address of the application primary slot',
+                             primary),
+            'size': entry('Size of the application primary slot',
+                          layout['slot_size']),
+            'upgrade_address': entry('Address of the application secondary slot',
+                                     secondary),
+            'upgrade_size': entry('Size of the application secondary slot',
+                                  layout['slot_size'])}}}
+    try:
+        with open(params.out_file, 'w', encoding='UTF-8') as out_f:
+            json.dump(flash_map, out_f, indent=4)
+    except (FileNotFoundError, OSError):
+        print('Cannot create', params.out_file, file=sys.stderr)
+        sys.exit(4)
+
+
+def optimize(params, plat):
+    """Generate the flash map with the largest slots (-O)"""
+    if plat['flashSize'] == 0:
+        print('No internal flash to optimize on this platform',
+              file=sys.stderr)
+        sys.exit(7)
+    layout = optimize_layout(UpgradeModel(plat, hash_time=params.hash_time),
+                             params.strategy,
+                             params.boot_size, params.reserve)
+    if layout is None:
+        print('No layout fits the constraints', file=sys.stderr)
+        sys.exit(7)
+    write_layout(params, plat, layout)
+    print('Bootloader size:', hex(layout['boot_size']))
+    print('Slot size:', hex(layout['slot_size']))
+    if params.strategy == 'swap':
+        print('Swap status size:', hex(layout['status_size']))
+        print('Scratch size:', hex(layout['scratch_size']))
+    print('Estimated upgrade time:', round(layout['time']), 'ms')
+
+
 def process_json(in_file):
     """Process JSON"""
     try:
@@ -594,7 +1049,20 @@ def process_json(in_file):
                       "is missing in 'external_flash'",
                       file=sys.stderr)
                 sys.exit(3)
-        flash.update({'XIP': str(mode).upper() == 'XIP'})
+        chips = flash_map['external_flash'][0].get('chips', 1)
+        try:
+            chips = int(chips)
+        except (TypeError, ValueError):
+            chips = 0
+        if not 1 <= chips <= 4:
+            print("'chips' in 'external_flash' must be 1 to 4",
+                  file=sys.stderr)
+            sys.exit(3)
+        # Identical chips on consecutive slave selects are concatenated
+        flash = dict(flash)
+        flash.update({'XIP': str(mode).upper() == 'XIP',
+                      'chips': chips,
+                      'flashSize': flash['flashSize'] * chips})
     return flash_map['boot_and_upgrade'], flash
 
 
@@ -696,6 +1164,10 @@ def main():
               file=sys.stderr)
         sys.exit(2)
 
+    if params.optimize:
+        optimize(params, plat)
+        return
+
     try:
         boot_and_upgrade, flash = process_json(params.in_file)
         bootloader = boot_and_upgrade['bootloader']
@@ -715,8 +1187,17 @@ def main():
     except KeyError:
         swap_status = None
 
+    # Direct-XIP: both slots run in place, no scratch or swap status needed
+    direct_xip = get_bool(bootloader, 'direct_xip')
+    if direct_xip and (scratch is not None or swap_status is not None):
+        print('Scratch area and swap status partition',
+              'are not used in direct-XIP mode',
+              file=sys.stderr)
+        sys.exit(7)
+
     # Create flash areas
-    area_list = AreaList(plat, flash, scratch is None and swap_status is None)
+    area_list = AreaList(plat, flash,
+                         scratch is None and swap_status is None and not direct_xip)
     area_list.add_area('bootloader', 'FLASH_AREA_BOOTLOADER',
                        boot.fa_addr, boot.fa_size)
 
@@ -760,6 +1241,21 @@ def main():
               file=sys.stderr)
         sys.exit(7)
 
+    if direct_xip:
+        if area_list.external_flash and not area_list.external_flash_xip:
+            print('Direct-XIP requires executable slots',
+                  '- set "mode" of the external flash to "XIP"',
+                  file=sys.stderr)
+            sys.exit(7)
+        for app_flash_map in apps_flash_map[1:]:
+            upgrade_start = int(app_flash_map.get("secondary").get("address"), 0) + cy_img_hdr_size
+            if upgrade_start % plat['VTAlign'] != 0:
+                print('Starting address', app_flash_map.get("secondary").get("address"),
+                      '+', hex(cy_img_hdr_size),
+                      'must be aligned to', hex(plat['VTAlign']),
+                      file=sys.stderr)
+                sys.exit(7)
+
     slot_sectors_max = max(slot_sectors_max, 32)
 
     if swap_status is not None:
@@ -782,6 +1278,19 @@ def main():
                            'FLASH_AREA_IMAGE_SCRATCH',
                            scratch.fa_addr, scratch.fa_size)
 
+    if params.estimate:
+        if direct_xip:
+            strategy = 'direct_xip'
+        elif area_list.use_overwrite:
+            strategy = 'overwrite'
+        else:
+            strategy = 'swap'
+        estimate(params, UpgradeModel(plat, flash, params.ext_timing,
+                                      params.status_encoding,
+                                      params.hash_time),
+                 strategy, apps_flash_map, scratch, swap_status)
+        return
+
     # Image id parameter is not used for MCUBootApp
     if params.img_id is None:
         area_list.generate_c_source(params)
@@ -801,6 +1310,14 @@ def main():
         print('PRIMARY_IMG_START := ' + primary_img_start)
         print('SECONDARY_IMG_START := ' + secondary_img_start)
         print('SLOT_SIZE := ' + slot_size)
+        if direct_xip:
+            # Offsets in the flash device, which MCUboot compares with the
+            # ROM address of an image signed with --rom-fixed
+            slot_offs = {area['fa_id']: area['fa_off'] for area in area_list.areas}
+            print('PRIMARY_IMG_OFFSET :=',
+                  hex(slot_offs[f'FLASH_AREA_IMG_{params.img_id}_PRIMARY']))
+            print('SECONDARY_IMG_OFFSET :=',
+                  hex(slot_offs[f'FLASH_AREA_IMG_{params.img_id}_SECONDARY']))
         print('MAX_IMG_SECTORS :=', slot_sectors_max)
     else:
         print('MCUBOOT_IMAGE_NUMBER :=', app_count)
@@ -808,10 +1325,14 @@ def main():
 
     if area_list.use_overwrite:
         print('USE_OVERWRITE := 1')
+    if direct_xip:
+        print('USE_DIRECT_XIP := 1')
     if area_list.external_flash:
         print('USE_EXTERNAL_FLASH := 1')
         if area_list.external_flash_xip:
             print('USE_XIP := 1')
+        if area_list.flash['chips'] > 1:
+            print('EXT_FLASH_CHIPS :=', area_list.flash['chips'])
     if shared_slot:
         print('USE_SHARED_SLOT := 1')
     if service_app is not None:
@@ -0,0 +1,176 @@
+/******************************************************************************
+* File Name:   boot_timing.h
+*
+* Description: Boot phase timestamps handed over from the UBM bootloader to
+*              the UBM controller application.
+*
+*              The timestamps are DWT cycle counter values. The counter is
+*              cleared at bootloader entry and keeps running across the jump
+*              to the application, so every stamp is relative to the reset.
+*              The 32-bit counter wraps after 30 s at 144 MHz, less than a
+*              swap can take: boot_timing_poll() counts the wraps and the
+*              stamps are extended to 64 bits. The bootloader polls from the
+*              SysTick interrupt, every 2^24 CPU cycles, and the application
+*              from each boot_timing_mark().
+*              The record lives in the ".boot_shared" RAM section, which is
+*              placed at the same address by both linker scripts and is not
+*              initialized by either startup code.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(BOOT_TIMING_H)
+#define BOOT_TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "cy_device_headers.h"
+#include "cy_syslib.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Marks the record as written by the bootloader during the current boot */
+#define BOOT_TIMING_MAGIC                   (0x54424D55UL)
+
+/* Places a variable in the RAM block shared between bootloader and application */
+#define BOOT_SHARED_SECTION                 CY_SECTION(".boot_shared")
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+/* Boot phases, in the order they are reached. Stamps taken before
+ * BOOT_TIMING_BSP_INIT are counted at the reset clock, later ones at the
+ * clock configured by cybsp_init().
+ */
+typedef enum
+{
+    BOOT_TIMING_BSP_INIT = 0,   /* cybsp_init() done in the bootloader */
+    BOOT_TIMING_QSPI_INIT,      /* External flash initialized on first access */
+    BOOT_TIMING_BOOT_GO,        /* boot_go() returned, swap (if any) done */
+    BOOT_TIMING_WDG_INIT,       /* Watchdog armed */
+    BOOT_TIMING_LAUNCH,         /* About to jump to the application */
+    BOOT_TIMING_APP_ENTRY,      /* Application main() entered */
+    BOOT_TIMING_APP_READY,      /* UBM middleware ready to answer the hosts */
+    BOOT_TIMING_PHASE_NUM
+} boot_timing_phase_t;
+
+typedef struct
+{
+    uint32_t magic;                             /* BOOT_TIMING_MAGIC when valid */
+    uint32_t clock_hz;                          /* Core clock after cybsp_init() */
+    uint32_t reset_reason;                      /* Cy_SysLib_GetResetReason() */
+    int32_t  swap_type;                         /* boot_swap_type() before boot_go() */
+    uint32_t last;                              /* DWT cycle count at the last poll */
+    uint32_t wraps;                             /* DWT cycle counter wraps */
+    uint64_t stamp[BOOT_TIMING_PHASE_NUM];      /* Extended cycle count, 0 if skipped */
+    uint32_t crypto_sha256_cycles;              /* Self-test SHA-256 of 4 KiB, 0 if not run */
+    uint32_t crypto_ecdsa_cycles;               /* Self-test ECDSA verification, 0 if not run */
+} boot_timing_t;
+
+extern boot_timing_t boot_timing;
+
+/*******************************************************************************
+* Function Name: boot_timing_start
+********************************************************************************
+* Summary:
+*  Enables and clears the DWT cycle counter and resets the record. Called by
+*  the bootloader as the very first thing in main().
+*
+*******************************************************************************/
+static inline void boot_timing_start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0UL;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    (void)memset(&boot_timing, 0, sizeof(boot_timing));
+    boot_timing.magic = BOOT_TIMING_MAGIC;
+}
+
+/*******************************************************************************
+* Function Name: boot_timing_is_valid
+********************************************************************************
+* Summary:
+*  Checks whether the record was filled in by the bootloader. It is not when
+*  the application is started directly, e.g. from a debugger.
+*
+* Return:
+*  bool
+*
+*******************************************************************************/
+static inline bool boot_timing_is_valid(void)
+{
+    return (BOOT_TIMING_MAGIC == boot_timing.magic);
+}
+
+/*******************************************************************************
+* Function Name: boot_timing_poll
+********************************************************************************
+* Summary:
+*  Counts a wrap of the DWT cycle counter since the previous poll. Must be
+*  called at least once every 2^32 cycles.
+*
+* Return:
+*  uint64_t - Cycle count since the reset
+*
+*******************************************************************************/
+static inline uint64_t boot_timing_poll(void)
+{
+    uint32_t saved = Cy_SysLib_EnterCriticalSection();
+    uint32_t now = DWT->CYCCNT;
+    uint64_t cycles;
+
+    if (now < boot_timing.last)
+    {
+        boot_timing.wraps++;
+    }
+    boot_timing.last = now;
+    cycles = ((uint64_t)boot_timing.wraps << 32U) | now;
+
+    Cy_SysLib_ExitCriticalSection(saved);
+
+    return cycles;
+}
+
+/*******************************************************************************
+* Function Name: boot_timing_mark
+********************************************************************************
+* Summary:
+*  Records the current cycle count for the given phase.
+*
+* Parameters:
+*  phase - Boot phase that has just completed
+*
+*******************************************************************************/
+static inline void boot_timing_mark(boot_timing_phase_t phase)
+{
+    boot_timing.stamp[phase] = boot_timing_poll();
+}
+
+/*******************************************************************************
+* Function Name: boot_timing_to_us
+********************************************************************************
+* Summary:
+*  Converts a cycle count from the record to microseconds.
+*
+* Parameters:
+*  cycles - Cycle count
+*
+* Return:
+*  uint32_t - Microseconds, saturated at UINT32_MAX
+*
+*******************************************************************************/
+static inline uint32_t boot_timing_to_us(uint64_t cycles)
+{
+    uint32_t cycles_per_us = boot_timing.clock_hz / 1000000UL;
+    uint64_t us = (0UL != cycles_per_us) ? (cycles / cycles_per_us) : 0U;
+
+    return (us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+}
+
+#endif /* BOOT_TIMING_H */
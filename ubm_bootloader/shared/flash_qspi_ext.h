@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name:   flash_qspi_ext.h
+*
+* Description: Extensions of the MCUboot external flash adaptation layer
+*              (flash_qspi.h) implemented by ubm_controller/source/flash_qspi.c.
+*
+*              The SMIF can be brought up on first use: qspi_defer_init()
+*              only records the slave select line. The first call that needs
+*              the memory configuration (every external flash access of the
+*              flash PAL goes through qspi_get_memory_config()) runs the SFDP
+*              detection. Its retries start at
+*              CY_SMIF_INIT_RETRY_DELAY_MIN_MS and double up to
+*              CY_SMIF_INIT_RETRY_DELAY_MAX_MS. The bootloader reads the
+*              secondary slot trailer on every boot, so with an external
+*              secondary slot the init is not skipped, only moved.
+*
+*              With CY_SMIF_USE_SFDP_CACHE the parameters found by the SFDP
+*              detection are kept in an internal flash row (".cy_boot_data")
+*              together with the JEDEC ID of the part. Later inits read the
+*              ID and reuse them, SFDP runs again only for a different part.
+*
+*              The read and program commands are the fastest ones the SFDP
+*              tables advertise. The QE bit is set when they need the quad
+*              pins; if that fails, single-width commands are used instead.
+*
+*              qspi_read_start() reads through the memory-mapped window with
+*              a DataWire channel, so the caller can work on the previous
+*              buffer while the next one is transferred.
+*
+*              qspi_erase_start() and qspi_program_start() return as soon as
+*              the first sector or page is started. qspi_async_process() polls
+*              the device at intervals derived from the SFDP erase and program
+*              times and calls the completion callback at the end. A read
+*              made with qspi_read_start() during an erase suspends it using
+*              the SFDP suspend and resume commands. Code that reads the XIP
+*              window directly brackets the access with qspi_erase_suspend()
+*              and qspi_erase_resume(). The suspend does not wait: while the
+*              part still needs time after the last resume, or has to finish
+*              its running sector, qspi_erase_suspend() returns CY_SMIF_BUSY
+*              and qspi_erase_suspend_pending() or qspi_async_process()
+*              completes it. A read made with qspi_read_start() starts its
+*              transfer only then.
+*
+*              With CY_BOOT_EXT_FLASH_CHIPS > 1, identical chips on the slave
+*              select lines following the first one are concatenated into a
+*              single address space. An asynchronous erase that spans chips
+*              erases them in parallel.
+*
+*              With CY_SMIF_AUTO_TUNE, the SMIF clock and RX sampling clock
+*              are calibrated against a read-back of the SFDP tables and of
+*              non-uniform array data when a part is first seen; a blank part
+*              keeps the default timing until it holds such data. The result
+*              is kept in the SFDP cache and qspi_get_tune_results() lists
+*              the read bandwidth of each setting that was tried. The
+*              bootloader hands the timing over to the application in the
+*              boot_shared RAM, so a build without CY_SMIF_AUTO_TUNE uses it
+*              too.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(FLASH_QSPI_EXT_H)
+#define FLASH_QSPI_EXT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+/* Called once when the deferred initialization has been attempted */
+typedef void (*qspi_init_callback_t)(cy_en_smif_status_t status);
+
+/* Called when an asynchronous erase or program has completed */
+typedef void (*qspi_op_callback_t)(cy_en_smif_status_t status, void *arg);
+
+/* One SMIF timing setting tried by the auto-tuning */
+typedef struct
+{
+    uint32_t clk_hz;                    /* SMIF interface clock, SPI clock is half */
+    uint8_t rx_clock_sel;               /* cy_en_smif_clk_select_rx_t */
+    bool pass;                          /* Calibration pattern read back correctly */
+    uint32_t read_kBps;                 /* Measured read bandwidth, 0 if failed */
+} qspi_tune_result_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void qspi_defer_init(uint32_t smif_id, qspi_init_callback_t callback);
+cy_en_smif_status_t qspi_ensure_init(void);
+bool qspi_is_initialized(void);
+uint32_t qspi_get_chip_count(void);
+cy_en_smif_txfr_width_t qspi_get_read_width(void);
+void qspi_xip_cache_enable(void);
+cy_en_smif_txfr_width_t qspi_get_program_width(void);
+
+cy_en_smif_status_t qspi_read_start(uint32_t address, uint8_t *data, uint32_t len);
+bool qspi_read_busy(void);
+cy_en_smif_status_t qspi_read_wait(void);
+cy_en_smif_status_t qspi_read(uint32_t address, uint8_t *data, uint32_t len);
+
+cy_en_smif_status_t qspi_erase_start(uint32_t address, uint32_t len,
+                                     qspi_op_callback_t callback, void *arg);
+cy_en_smif_status_t qspi_program_start(uint32_t address, const uint8_t *data, uint32_t len,
+                                       qspi_op_callback_t callback, void *arg);
+bool qspi_async_process(void);
+cy_en_smif_status_t qspi_async_wait(void);
+cy_en_smif_status_t qspi_erase_suspend(void);
+bool qspi_erase_suspend_pending(void);
+cy_en_smif_status_t qspi_erase_resume(void);
+const qspi_tune_result_t *qspi_get_tune_results(uint32_t *count);
+
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+cy_en_flashdrv_status_t qspi_flash_erase_row(uint32_t rowAddr);
+cy_en_flashdrv_status_t qspi_flash_program_row(uint32_t rowAddr, const uint32_t *data);
+cy_en_flashdrv_status_t qspi_flash_write_row(uint32_t rowAddr, const uint32_t *data);
+#endif
+
+#endif /* FLASH_QSPI_EXT_H */
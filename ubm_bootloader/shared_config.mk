@@ -14,6 +14,13 @@
 
 
 # Flashmap JSON file name
+# psoc62_swap_single_custom.json - swap with scratch, upgrade always runs from
+#                                  the primary slot
+# psoc62_direct_xip_custom.json  - direct-XIP, the newest valid image runs in
+#                                  place from either slot without a swap
+# psoc62_swap_ext_custom.json    - swap with scratch, the secondary slot,
+#                                  swap status and scratch are in the
+#                                  external QSPI flash
 FLASH_MAP=psoc62_swap_single_custom.json
 
 # Device family name. Ex: PSOC6, CYW20289
@@ -38,6 +45,10 @@ SIGN_KEY_FILE=cypress-test-ec-p256
 # Flash and RAM size for MCUBoot Bootloader app; 
 BOOTLOADER_APP_RAM_SIZE=0x10000
 
+# Size of the RAM block at the top of the bootloader RAM that survives the jump
+# to the application (boot phase timestamps).
+BOOT_SHARED_RAM_SIZE=0x100
+
 # MCUBoot header size
 # Must be a multiple of 1024 because of the following reason. 
 # CM4 image starts right after the header and the CM4 image begins with the
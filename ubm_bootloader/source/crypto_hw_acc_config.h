@@ -0,0 +1,24 @@
+/******************************************************************************
+* File Name:   crypto_hw_acc_config.h
+*
+* Description: mbedtls user configuration that routes the primitives used by
+*              MCUboot image validation to the PSoC 6 Crypto block. Included
+*              through MBEDTLS_USER_CONFIG_FILE when USE_CRYPTO_HW=1, on top
+*              of mcuboot_crypto_config.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(CRYPTO_HW_ACC_CONFIG_H)
+#define CRYPTO_HW_ACC_CONFIG_H
+
+/* Image hash (SHA-256 over the header, image and protected TLVs) */
+#define MBEDTLS_SHA256_ALT
+
+/* Image signature (ECDSA P-256 verification with the embedded public key) */
+#define MBEDTLS_ECDSA_VERIFY_ALT
+
+#endif /* CRYPTO_HW_ACC_CONFIG_H */
@@ -0,0 +1,228 @@
+/******************************************************************************
+* File Name:   crypto_self_test.c
+*
+* Description: Optional known-answer self-test of the image validation
+*              primitives of the UBM bootloader.
+*
+*              The test runs the SHA-256 and ECDSA P-256 code MCUboot
+*              validates the images with against published vectors:
+*              - SHA-256 of "abc" and of the two-block message of FIPS 180-2,
+*              - the RFC 6979 A.2.5 P-256/SHA-256 signature of "sample",
+*                which must verify, and the same signature over a digest with
+*                one bit flipped, which must not.
+*              A backend that fails any of these could accept an image that
+*              MCUboot would reject, so the bootloader does not boot then.
+*
+*              The DWT cycles of the SHA-256 of CRYPTO_SELF_TEST_HASH_SIZE
+*              bytes and of one signature verification are stored in the
+*              boot timing record, the application logs them. Building once
+*              with USE_CRYPTO_HW=0 and once with USE_CRYPTO_HW=1 compares
+*              the software and the Crypto block backends.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifdef CY_BOOT_CRYPTO_SELF_TEST
+
+#include <stddef.h>
+#include <string.h>
+#include "cy_pdl.h"
+
+#include "bootutil/crypto/sha256.h"
+#include "mbedtls/ecdsa.h"
+
+#include "boot_timing.h"
+#include "crypto_self_test.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define CRYPTO_SELF_TEST_DIGEST_SIZE        (32U)
+#define CRYPTO_SELF_TEST_COORD_SIZE         (32U)
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* FIPS 180-2 SHA-256 examples, one block and two blocks */
+static const char crypto_test_sha_msg1[] = "abc";
+static const uint8_t crypto_test_sha_digest1[CRYPTO_SELF_TEST_DIGEST_SIZE] =
+{
+    0xBAU, 0x78U, 0x16U, 0xBFU, 0x8FU, 0x01U, 0xCFU, 0xEAU,
+    0x41U, 0x41U, 0x40U, 0xDEU, 0x5DU, 0xAEU, 0x22U, 0x23U,
+    0xB0U, 0x03U, 0x61U, 0xA3U, 0x96U, 0x17U, 0x7AU, 0x9CU,
+    0xB4U, 0x10U, 0xFFU, 0x61U, 0xF2U, 0x00U, 0x15U, 0xADU
+};
+
+static const char crypto_test_sha_msg2[] =
+    "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+static const uint8_t crypto_test_sha_digest2[CRYPTO_SELF_TEST_DIGEST_SIZE] =
+{
+    0x24U, 0x8DU, 0x6AU, 0x61U, 0xD2U, 0x06U, 0x38U, 0xB8U,
+    0xE5U, 0xC0U, 0x26U, 0x93U, 0x0CU, 0x3EU, 0x60U, 0x39U,
+    0xA3U, 0x3CU, 0xE4U, 0x59U, 0x64U, 0xFFU, 0x21U, 0x67U,
+    0xF6U, 0xECU, 0xEDU, 0xD4U, 0x19U, 0xDBU, 0x06U, 0xC1U
+};
+
+/* RFC 6979 A.2.5: P-256 public key, uncompressed point */
+static const uint8_t crypto_test_ecdsa_key[1U + (2U * CRYPTO_SELF_TEST_COORD_SIZE)] =
+{
+    0x04U,
+    0x60U, 0xFEU, 0xD4U, 0xBAU, 0x25U, 0x5AU, 0x9DU, 0x31U,
+    0xC9U, 0x61U, 0xEBU, 0x74U, 0xC6U, 0x35U, 0x6DU, 0x68U,
+    0xC0U, 0x49U, 0xB8U, 0x92U, 0x3BU, 0x61U, 0xFAU, 0x6CU,
+    0xE6U, 0x69U, 0x62U, 0x2EU, 0x60U, 0xF2U, 0x9FU, 0xB6U,
+    0x79U, 0x03U, 0xFEU, 0x10U, 0x08U, 0xB8U, 0xBCU, 0x99U,
+    0xA4U, 0x1AU, 0xE9U, 0xE9U, 0x56U, 0x28U, 0xBCU, 0x64U,
+    0xF2U, 0xF1U, 0xB2U, 0x0CU, 0x2DU, 0x7EU, 0x9FU, 0x51U,
+    0x77U, 0xA3U, 0xC2U, 0x94U, 0xD4U, 0x46U, 0x22U, 0x99U
+};
+
+/* RFC 6979 A.2.5: SHA-256 of "sample" */
+static const uint8_t crypto_test_ecdsa_digest[CRYPTO_SELF_TEST_DIGEST_SIZE] =
+{
+    0xAFU, 0x2BU, 0xDBU, 0xE1U, 0xAAU, 0x9BU, 0x6EU, 0xC1U,
+    0xE2U, 0xADU, 0xE1U, 0xD6U, 0x94U, 0xF4U, 0x1FU, 0xC7U,
+    0x1AU, 0x83U, 0x1DU, 0x02U, 0x68U, 0xE9U, 0x89U, 0x15U,
+    0x62U, 0x11U, 0x3DU, 0x8AU, 0x62U, 0xADU, 0xD1U, 0xBFU
+};
+
+/* RFC 6979 A.2.5: signature of "sample" with SHA-256 */
+static const uint8_t crypto_test_ecdsa_r[CRYPTO_SELF_TEST_COORD_SIZE] =
+{
+    0xEFU, 0xD4U, 0x8BU, 0x2AU, 0xACU, 0xB6U, 0xA8U, 0xFDU,
+    0x11U, 0x40U, 0xDDU, 0x9CU, 0xD4U, 0x5EU, 0x81U, 0xD6U,
+    0x9DU, 0x2CU, 0x87U, 0x7BU, 0x56U, 0xAAU, 0xF9U, 0x91U,
+    0xC3U, 0x4DU, 0x0EU, 0xA8U, 0x4EU, 0xAFU, 0x37U, 0x16U
+};
+
+static const uint8_t crypto_test_ecdsa_s[CRYPTO_SELF_TEST_COORD_SIZE] =
+{
+    0xF7U, 0xCBU, 0x1CU, 0x94U, 0x2DU, 0x65U, 0x7CU, 0x41U,
+    0xD4U, 0x36U, 0xC7U, 0xA1U, 0xB6U, 0xE2U, 0x9FU, 0x65U,
+    0xF3U, 0xE9U, 0x00U, 0xDBU, 0xB9U, 0xAFU, 0xF4U, 0x06U,
+    0x4DU, 0xC4U, 0xABU, 0x2FU, 0x84U, 0x3AU, 0xCDU, 0xA8U
+};
+
+/******************************************************************************
+ * Function Name: crypto_self_test_sha256
+ ******************************************************************************
+ * Summary:
+ *  Computes the SHA-256 of a buffer with the bootutil SHA-256 port.
+ *
+ ******************************************************************************/
+static void crypto_self_test_sha256(const void *data, uint32_t len,
+                                    uint8_t digest[CRYPTO_SELF_TEST_DIGEST_SIZE])
+{
+    bootutil_sha256_context sha;
+
+    bootutil_sha256_init(&sha);
+    bootutil_sha256_update(&sha, data, len);
+    bootutil_sha256_finish(&sha, digest);
+    bootutil_sha256_drop(&sha);
+}
+
+/******************************************************************************
+ * Function Name: crypto_self_test_ecdsa
+ ******************************************************************************
+ * Summary:
+ *  Verifies the RFC 6979 signature over the given digest, through the same
+ *  mbedtls entry point as the MCUboot EC256 signature check.
+ *
+ * Return:
+ *  bool - true if the signature is valid for the digest
+ *
+ ******************************************************************************/
+static bool crypto_self_test_ecdsa(const uint8_t digest[CRYPTO_SELF_TEST_DIGEST_SIZE])
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point q;
+    mbedtls_mpi r;
+    mbedtls_mpi s;
+    int rc;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    rc = mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1);
+    if (0 == rc)
+    {
+        rc = mbedtls_ecp_point_read_binary(&grp, &q, crypto_test_ecdsa_key,
+                                           sizeof(crypto_test_ecdsa_key));
+    }
+    if (0 == rc)
+    {
+        rc = mbedtls_mpi_read_binary(&r, crypto_test_ecdsa_r, sizeof(crypto_test_ecdsa_r));
+    }
+    if (0 == rc)
+    {
+        rc = mbedtls_mpi_read_binary(&s, crypto_test_ecdsa_s, sizeof(crypto_test_ecdsa_s));
+    }
+    if (0 == rc)
+    {
+        rc = mbedtls_ecdsa_verify(&grp, digest, CRYPTO_SELF_TEST_DIGEST_SIZE, &q, &r, &s);
+    }
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_point_free(&q);
+    mbedtls_ecp_group_free(&grp);
+
+    return (0 == rc);
+}
+
+/******************************************************************************
+ * Function Name: crypto_self_test
+ ******************************************************************************
+ * Summary:
+ *  Checks the SHA-256 and ECDSA P-256 backends against the known answers and
+ *  stores their timing in boot_timing. The timing is left at 0 on a failure.
+ *
+ * Return:
+ *  bool - true if every known answer matched
+ *
+ ******************************************************************************/
+bool crypto_self_test(void)
+{
+    uint8_t digest[CRYPTO_SELF_TEST_DIGEST_SIZE];
+    uint32_t sha256_cycles;
+    uint32_t ecdsa_cycles;
+    uint32_t start;
+    bool passed;
+
+    crypto_self_test_sha256(crypto_test_sha_msg1, sizeof(crypto_test_sha_msg1) - 1U, digest);
+    passed = (0 == memcmp(digest, crypto_test_sha_digest1, sizeof(digest)));
+
+    crypto_self_test_sha256(crypto_test_sha_msg2, sizeof(crypto_test_sha_msg2) - 1U, digest);
+    passed = passed && (0 == memcmp(digest, crypto_test_sha_digest2, sizeof(digest)));
+
+    /* The bootloader code itself, read as the image slots are */
+    start = DWT->CYCCNT;
+    crypto_self_test_sha256((const void *)CY_FLASH_BASE, CRYPTO_SELF_TEST_HASH_SIZE, digest);
+    sha256_cycles = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    passed = passed && crypto_self_test_ecdsa(crypto_test_ecdsa_digest);
+    ecdsa_cycles = DWT->CYCCNT - start;
+
+    /* A backend that accepts everything must not pass */
+    (void)memcpy(digest, crypto_test_ecdsa_digest, sizeof(digest));
+    digest[0] ^= 0x01U;
+    passed = passed && !crypto_self_test_ecdsa(digest);
+
+    if (passed)
+    {
+        boot_timing.crypto_sha256_cycles = sha256_cycles;
+        boot_timing.crypto_ecdsa_cycles = ecdsa_cycles;
+    }
+
+    return passed;
+}
+
+#endif /* CY_BOOT_CRYPTO_SELF_TEST */
+
+/* [] END OF FILE */
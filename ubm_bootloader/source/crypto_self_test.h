@@ -0,0 +1,32 @@
+/******************************************************************************
+* File Name:   crypto_self_test.h
+*
+* Description: Optional known-answer self-test of the image validation
+*              primitives (SHA-256, ECDSA P-256 verification), run by the UBM
+*              bootloader before it validates any image. It checks whichever
+*              backend is built in, the mbedtls software code or the Crypto
+*              block, and records how long each primitive takes.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(CRYPTO_SELF_TEST_H)
+#define CRYPTO_SELF_TEST_H
+
+#include <stdbool.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Bytes of the bootloader's own flash hashed to time SHA-256 */
+#define CRYPTO_SELF_TEST_HASH_SIZE          (4096UL)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+bool crypto_self_test(void);
+
+#endif /* CRYPTO_SELF_TEST_H */
@@ -5,7 +5,7 @@
 
 /* Platform: PSOC_061_512K */
 
-static struct flash_area flash_areas[] = {
+static const struct flash_area flash_areas[] = {
     {
         .fa_id        = FLASH_AREA_BOOTLOADER,
         .fa_device_id = FLASH_DEVICE_INTERNAL_FLASH,
@@ -38,13 +38,71 @@ static struct flash_area flash_areas[] = {
     }
 };
 
+_Static_assert(_Generic(&flash_areas[0], const struct flash_area *: 1, default: 0),
+               "flash_areas must be const");
+_Static_assert((0x0U % CY_FLASH_SIZEOF_ROW) == 0U,
+               "bootloader is not aligned to the flash row");
+_Static_assert((0x18000U % CY_FLASH_SIZEOF_ROW) == 0U,
+               "application_1 (primary slot) is not aligned to the flash row");
+_Static_assert((0x38000U % CY_FLASH_SIZEOF_ROW) == 0U,
+               "application_1 (secondary slot) is not aligned to the flash row");
+_Static_assert((0x58000U % CY_FLASH_SIZEOF_ROW) == 0U,
+               "swap status partition is not aligned to the flash row");
+_Static_assert((0x5a000U % CY_FLASH_SIZEOF_ROW) == 0U,
+               "scratch area is not aligned to the flash row");
+_Static_assert(((0x0U + 0x18000U) <= 0x18000U) ||
+               ((0x18000U + 0x20000U) <= 0x0U),
+               "bootloader overlaps with application_1 (primary slot)");
+_Static_assert(((0x0U + 0x18000U) <= 0x38000U) ||
+               ((0x38000U + 0x20000U) <= 0x0U),
+               "bootloader overlaps with application_1 (secondary slot)");
+_Static_assert(((0x0U + 0x18000U) <= 0x58000U) ||
+               ((0x58000U + 0x1800U) <= 0x0U),
+               "bootloader overlaps with swap status partition");
+_Static_assert(((0x0U + 0x18000U) <= 0x5a000U) ||
+               ((0x5a000U + 0x2000U) <= 0x0U),
+               "bootloader overlaps with scratch area");
+_Static_assert(((0x18000U + 0x20000U) <= 0x38000U) ||
+               ((0x38000U + 0x20000U) <= 0x18000U),
+               "application_1 (primary slot) overlaps with application_1 (secondary slot)");
+_Static_assert(((0x18000U + 0x20000U) <= 0x58000U) ||
+               ((0x58000U + 0x1800U) <= 0x18000U),
+               "application_1 (primary slot) overlaps with swap status partition");
+_Static_assert(((0x18000U + 0x20000U) <= 0x5a000U) ||
+               ((0x5a000U + 0x2000U) <= 0x18000U),
+               "application_1 (primary slot) overlaps with scratch area");
+_Static_assert(((0x38000U + 0x20000U) <= 0x58000U) ||
+               ((0x58000U + 0x1800U) <= 0x38000U),
+               "application_1 (secondary slot) overlaps with swap status partition");
+_Static_assert(((0x38000U + 0x20000U) <= 0x5a000U) ||
+               ((0x5a000U + 0x2000U) <= 0x38000U),
+               "application_1 (secondary slot) overlaps with scratch area");
+_Static_assert(((0x58000U + 0x1800U) <= 0x5a000U) ||
+               ((0x5a000U + 0x2000U) <= 0x58000U),
+               "swap status partition overlaps with scratch area");
+
 struct flash_area *boot_area_descs[] = {
-    &flash_areas[0U],
-    &flash_areas[1U],
-    &flash_areas[2U],
-    &flash_areas[3U],
-    &flash_areas[4U],
+    (struct flash_area *)&flash_areas[0U],
+    (struct flash_area *)&flash_areas[1U],
+    (struct flash_area *)&flash_areas[2U],
+    (struct flash_area *)&flash_areas[3U],
+    (struct flash_area *)&flash_areas[4U],
     NULL
 };
 
+#if defined(CY_FLASH_MAP_OPEN_BY_ID)
+#pragma weak flash_area_open
+
+const struct flash_area * const flash_area_by_id[] = {
+    [FLASH_AREA_BOOTLOADER] = &flash_areas[0U],
+    [FLASH_AREA_IMG_1_PRIMARY] = &flash_areas[1U],
+    [FLASH_AREA_IMG_1_SECONDARY] = &flash_areas[2U],
+    [FLASH_AREA_IMAGE_SWAP_STATUS] = &flash_areas[3U],
+    [FLASH_AREA_IMAGE_SCRATCH] = &flash_areas[4U],
+};
+
+const uint32_t flash_area_by_id_count =
+    sizeof(flash_area_by_id) / sizeof(flash_area_by_id[0]);
+#endif /* CY_FLASH_MAP_OPEN_BY_ID */
+
 #endif /* CY_FLASH_MAP_H */
@@ -0,0 +1,305 @@
+/******************************************************************************
+* File Name:   fast_boot.c
+*
+* Description: Optional fast-boot path of the UBM bootloader.
+*
+*              After every boot that passed the full MCUboot validation, the
+*              SHA-256 digest of the primary image, as given by its hash TLV,
+*              is stored in the last row of the bootloader flash area. MCUboot
+*              has checked that digest against the image and its signature.
+*
+*              A later boot takes the fast path only when all of the following
+*              hold. Otherwise it falls back to boot_go():
+*              - the reset was caused by the watchdog or by software,
+*              - no swap or revert is pending,
+*              - fewer than FAST_BOOT_FULL_VERIFY_PERIOD fast boots happened
+*                since the last full validation,
+*              - the SHA-256 of the image header, body and protected TLVs, the
+*                data MCUboot hashes, matches the stored digest.
+*
+*              The fast path thus skips the signature verification only. The
+*              hash uses the bootutil SHA-256 port, which runs on the Crypto
+*              block when the bootloader is built with USE_CRYPTO_HW=1.
+*
+*              The fast-boot counter is kept in the bootloader's .noinit RAM,
+*              so any power cycle also forces a full validation.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifdef CY_BOOT_USE_FAST_BOOT
+
+#include <stddef.h>
+#include <string.h>
+#include "cy_pdl.h"
+
+#include "bootutil/image.h"
+#include "bootutil/bootutil.h"
+#include "bootutil/crypto/sha256.h"
+#include "flash_map_backend/flash_map_backend.h"
+#include "sysflash/sysflash.h"
+
+#include "fast_boot.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define FAST_BOOT_RECORD_MAGIC              (0x46424F54UL)
+#define FAST_BOOT_STATE_MAGIC               (0x46425354UL)
+
+#define FAST_BOOT_DIGEST_SIZE               (32U)
+
+/* Size of the chunks the slot is read in */
+#define FAST_BOOT_READ_CHUNK_SIZE           (256U)
+
+/* Resets after which the previous validation result can be trusted */
+#define FAST_BOOT_RESET_REASONS             (CY_SYSLIB_RESET_HWWDT | CY_SYSLIB_RESET_SOFT)
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef struct
+{
+    uint32_t magic;
+    uint32_t hashed_size;               /* Header, body and protected TLVs */
+    uint8_t digest[FAST_BOOT_DIGEST_SIZE];  /* Hash TLV of the validated image */
+} fast_boot_record_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t fast_boots;                /* Fast boots since the last full validation */
+} fast_boot_state_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* The record row. Programming the bootloader clears it, which forces a full
+ * validation on the first boot. */
+CY_SECTION(".cy_boot_data") CY_ALIGN(CY_FLASH_SIZEOF_ROW)
+static const uint8_t fast_boot_row[CY_FLASH_SIZEOF_ROW] = { 0U };
+
+CY_NOINIT static fast_boot_state_t fast_boot_state;
+
+static uint32_t fast_boot_row_buf[CY_FLASH_SIZEOF_ROW / sizeof(uint32_t)];
+
+/* Header of the image booted through the fast path, referenced by boot_rsp */
+static struct image_header fast_boot_hdr;
+
+/******************************************************************************
+ * Function Name: fast_boot_read_header
+ ******************************************************************************
+ * Summary:
+ *  Reads the primary slot image header and checks the extent of the hashed
+ *  data.
+ *
+ * Parameters:
+ *  fap         - Primary slot flash area
+ *  hdr         - Receives the image header
+ *  hashed_size - Receives the size of the data covered by the hash TLV
+ *
+ * Return:
+ *  bool - true if the slot holds an image that fits in it
+ *
+ ******************************************************************************/
+static bool fast_boot_read_header(const struct flash_area *fap,
+                                  struct image_header *hdr,
+                                  uint32_t *hashed_size)
+{
+    if ((0 != flash_area_read(fap, 0U, hdr, sizeof(*hdr))) ||
+        (IMAGE_MAGIC != hdr->ih_magic))
+    {
+        return false;
+    }
+
+    *hashed_size = (uint32_t)hdr->ih_hdr_size + hdr->ih_img_size + hdr->ih_protect_tlv_size;
+
+    return (*hashed_size <= fap->fa_size);
+}
+
+/******************************************************************************
+ * Function Name: fast_boot_hash
+ ******************************************************************************
+ * Summary:
+ *  Computes the SHA-256 of the first len bytes of the primary slot, as
+ *  bootutil does for the hash TLV.
+ *
+ * Return:
+ *  bool - true if the slot could be read
+ *
+ ******************************************************************************/
+static bool fast_boot_hash(const struct flash_area *fap, uint32_t len,
+                           uint8_t digest[FAST_BOOT_DIGEST_SIZE])
+{
+    bootutil_sha256_context sha;
+    uint8_t buf[FAST_BOOT_READ_CHUNK_SIZE];
+    uint32_t off = 0U;
+    int rc = 0;
+
+    bootutil_sha256_init(&sha);
+
+    while ((len > 0U) && (0 == rc))
+    {
+        uint32_t chunk = (len < sizeof(buf)) ? len : sizeof(buf);
+
+        rc = flash_area_read(fap, off, buf, chunk);
+        if (0 == rc)
+        {
+            bootutil_sha256_update(&sha, buf, chunk);
+            off += chunk;
+            len -= chunk;
+        }
+    }
+
+    bootutil_sha256_finish(&sha, digest);
+    bootutil_sha256_drop(&sha);
+
+    return (0 == rc);
+}
+
+/******************************************************************************
+ * Function Name: fast_boot_read_digest
+ ******************************************************************************
+ * Summary:
+ *  Reads the SHA-256 hash TLV of the primary image.
+ *
+ * Return:
+ *  bool - true if the image has a hash TLV of the expected size
+ *
+ ******************************************************************************/
+static bool fast_boot_read_digest(const struct flash_area *fap,
+                                  struct image_header *hdr,
+                                  uint8_t digest[FAST_BOOT_DIGEST_SIZE])
+{
+    struct image_tlv_iter it;
+    uint32_t off;
+    uint16_t len;
+
+    if ((0 != bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_SHA256, false)) ||
+        (0 != bootutil_tlv_iter_next(&it, &off, &len, NULL)) ||
+        (FAST_BOOT_DIGEST_SIZE != len))
+    {
+        return false;
+    }
+
+    return (0 == flash_area_read(fap, off, digest, FAST_BOOT_DIGEST_SIZE));
+}
+
+/******************************************************************************
+ * Function Name: fast_boot_try
+ ******************************************************************************
+ * Summary:
+ *  Checks whether the primary image can be booted without the full MCUboot
+ *  validation and fills in the boot response if so.
+ *
+ * Parameters:
+ *  rsp          - Boot response to fill in
+ *  reset_reason - Value of Cy_SysLib_GetResetReason() for this boot
+ *
+ * Return:
+ *  bool - true if rsp is valid and boot_go() can be skipped
+ *
+ ******************************************************************************/
+bool fast_boot_try(struct boot_rsp *rsp, uint32_t reset_reason)
+{
+    const fast_boot_record_t *stored = (const fast_boot_record_t *)fast_boot_row;
+    const struct flash_area *fap = NULL;
+    uint8_t digest[FAST_BOOT_DIGEST_SIZE];
+    uint32_t hashed_size;
+    bool ok = false;
+
+    if ((0U == (reset_reason & FAST_BOOT_RESET_REASONS)) ||
+        (FAST_BOOT_STATE_MAGIC != fast_boot_state.magic) ||
+        (fast_boot_state.fast_boots >= FAST_BOOT_FULL_VERIFY_PERIOD))
+    {
+        return false;
+    }
+
+    if (FAST_BOOT_RECORD_MAGIC != stored->magic)
+    {
+        return false;
+    }
+
+    if (BOOT_SWAP_TYPE_NONE != boot_swap_type())
+    {
+        return false;
+    }
+
+    if (0 != flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0U), &fap))
+    {
+        return false;
+    }
+
+    if (fast_boot_read_header(fap, &fast_boot_hdr, &hashed_size) &&
+        (hashed_size == stored->hashed_size) &&
+        fast_boot_hash(fap, hashed_size, digest) &&
+        (0 == memcmp(digest, stored->digest, sizeof(digest))))
+    {
+        (void)memset(rsp, 0, sizeof(*rsp));
+        rsp->br_hdr = &fast_boot_hdr;
+        rsp->br_flash_dev_id = fap->fa_device_id;
+        rsp->br_image_off = fap->fa_off;
+
+        fast_boot_state.fast_boots++;
+        ok = true;
+    }
+
+    flash_area_close(fap);
+
+    return ok;
+}
+
+/******************************************************************************
+ * Function Name: fast_boot_update
+ ******************************************************************************
+ * Summary:
+ *  Records the image that has just passed the full validation. Its hash TLV
+ *  is read back, the image is not hashed again. The flash row is only
+ *  written when the record changes.
+ *
+ * Parameters:
+ *  rsp - Boot response returned by boot_go()
+ *
+ ******************************************************************************/
+void fast_boot_update(const struct boot_rsp *rsp)
+{
+    const struct flash_area *fap = NULL;
+    struct image_header hdr;
+    fast_boot_record_t rec;
+
+    fast_boot_state.magic = FAST_BOOT_STATE_MAGIC;
+    fast_boot_state.fast_boots = 0U;
+
+    /* Only a confirmed image running from the primary slot is recorded */
+    if (BOOT_SWAP_TYPE_NONE != boot_swap_type())
+    {
+        return;
+    }
+
+    if (0 != flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0U), &fap))
+    {
+        return;
+    }
+
+    (void)memset(&rec, 0, sizeof(rec));
+    rec.magic = FAST_BOOT_RECORD_MAGIC;
+
+    if ((rsp->br_image_off == fap->fa_off) &&
+        fast_boot_read_header(fap, &hdr, &rec.hashed_size) &&
+        fast_boot_read_digest(fap, &hdr, rec.digest) &&
+        (0 != memcmp(&rec, fast_boot_row, sizeof(rec))))
+    {
+        (void)memset(fast_boot_row_buf, 0, sizeof(fast_boot_row_buf));
+        (void)memcpy(fast_boot_row_buf, &rec, sizeof(rec));
+        (void)Cy_Flash_WriteRow((uint32_t)fast_boot_row, fast_boot_row_buf);
+    }
+
+    flash_area_close(fap);
+}
+
+#endif /* CY_BOOT_USE_FAST_BOOT */
+
+/* [] END OF FILE */
@@ -0,0 +1,37 @@
+/******************************************************************************
+* File Name:   fast_boot.h
+*
+* Description: Optional fast-boot path of the UBM bootloader. A record of the
+*              last fully validated primary image is kept in a dedicated flash
+*              row. On warm resets with no upgrade pending, only the image
+*              hash is computed and checked against that record: the MCUboot
+*              signature verification is skipped.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(FAST_BOOT_H)
+#define FAST_BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bootutil/bootutil.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of consecutive fast boots after which a full validation is forced */
+#ifndef FAST_BOOT_FULL_VERIFY_PERIOD
+#define FAST_BOOT_FULL_VERIFY_PERIOD        (16UL)
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+bool fast_boot_try(struct boot_rsp *rsp, uint32_t reset_reason);
+void fast_boot_update(const struct boot_rsp *rsp);
+
+#endif /* FAST_BOOT_H */
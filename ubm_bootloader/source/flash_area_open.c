@@ -0,0 +1,68 @@
+/******************************************************************************
+* File Name:   flash_area_open.c
+*
+* Description: Constant time flash_area_open() of the UBM bootloader.
+*
+*              The flash PAL looks a flash area up by a linear search of
+*              boot_area_descs[], and bootutil opens the slot, scratch and
+*              swap status areas many times per boot. This implementation
+*              reads the area from the ID-indexed flash_area_by_id[] table
+*              generated in cy_flash_map.h instead.
+*
+*              cy_flash_map.h, which the flash PAL includes, declares the PAL
+*              definition weak. The linker thus resolves every call to the
+*              function below, including the calls inside the flash PAL
+*              itself.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifdef CY_FLASH_MAP_OPEN_BY_ID
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flash_map_backend/flash_map_backend.h"
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Defined in cy_flash_map.h, indexed by fa_id, NULL for unused IDs */
+extern const struct flash_area * const flash_area_by_id[];
+extern const uint32_t flash_area_by_id_count;
+
+/******************************************************************************
+ * Function Name: flash_area_open
+ ******************************************************************************
+ * Summary:
+ *  Opens a flash area for use.
+ *
+ * Parameters:
+ *  id  - Flash area ID (fa_id)
+ *  fa  - Receives the flash area
+ *
+ * Return:
+ *  0 on success, -1 if no area has the ID
+ *
+ ******************************************************************************/
+int flash_area_open(uint8_t id, const struct flash_area **fa)
+{
+    int ret = -1;
+
+    if ((NULL != fa) &&
+        (id < flash_area_by_id_count) &&
+        (NULL != flash_area_by_id[id]))
+    {
+        *fa = flash_area_by_id[id];
+        ret = 0;
+    }
+
+    return ret;
+}
+
+#endif /* CY_FLASH_MAP_OPEN_BY_ID */
+
+/* [] END OF FILE */
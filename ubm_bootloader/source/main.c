@@ -20,9 +20,14 @@
 #include "cycfg_peripherals.h"
 #include "cycfg_pins.h"
 
+#ifdef CY_CRYPTO_HW
+#include "cy_crypto_core.h"
+#endif
+
 /* Flash PAL header files */
 #ifdef CY_BOOT_USE_EXTERNAL_FLASH
 #include "flash_qspi.h"
+#include "flash_qspi_ext.h"
 #endif
 
 /* MCUboot header files */
@@ -36,6 +41,17 @@
 #include "watchdog.h"
 #include "cyw_platform_utils.h"
 
+/* Boot phase timestamps handed over to the application */
+#include "boot_timing.h"
+
+#ifdef CY_BOOT_USE_FAST_BOOT
+#include "fast_boot.h"
+#endif
+
+#ifdef CY_BOOT_CRYPTO_SELF_TEST
+#include "crypto_self_test.h"
+#endif
+
 /*******************************************************************************
 * Macros
 ********************************************************************************/
@@ -55,6 +71,44 @@
 #define MCUBOOTAPP_RSLT_ERR \
     (CY_RSLT_CREATE_EX(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MCUBOOTAPP, CY_RSLT_MODULE_MCUBOOTAPP_MAIN, 0))
 
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Boot phase timestamps, read by the application after the jump */
+BOOT_SHARED_SECTION boot_timing_t boot_timing;
+
+/******************************************************************************
+ * Function Name: boot_timing_tick
+ ******************************************************************************
+ * Summary:
+ *  SysTick callback, counts the wraps of the DWT cycle counter during long
+ *  operations such as a swap.
+ *
+ ******************************************************************************/
+static void boot_timing_tick(void)
+{
+    (void)boot_timing_poll();
+}
+
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+/******************************************************************************
+ * Function Name: qspi_init_done
+ ******************************************************************************
+ * Summary:
+ *  Called when bootutil first accessed the external flash and the SMIF has
+ *  been brought up.
+ *
+ * Parameters:
+ *  status - Result of the external flash initialization
+ *
+ ******************************************************************************/
+static void qspi_init_done(cy_en_smif_status_t status)
+{
+    (void)status;
+    boot_timing_mark(BOOT_TIMING_QSPI_INIT);
+}
+#endif
+
 /******************************************************************************
  * Function Name: deinit_hw
  ******************************************************************************
@@ -64,9 +118,18 @@
  ******************************************************************************/
 static void hw_deinit(void)
 {
+    /* The application owns SysTick */
+    Cy_SysTick_Disable();
+    SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+
 #if defined(CY_BOOT_USE_EXTERNAL_FLASH) && !defined(MCUBOOT_ENC_IMAGES_XIP) && !defined(USE_XIP)
     qspi_deinit(QSPI_SLAVE_SELECT_LINE);
 #endif
+
+#ifdef CY_CRYPTO_HW
+    /* Hand the Crypto block over to the application in its reset state */
+    Cy_Crypto_Core_Disable(CRYPTO);
+#endif
 }
 
 
@@ -111,9 +174,20 @@ static bool do_boot(struct boot_rsp *rsp)
             hw_deinit();
 
 #ifdef USE_XIP
+            /* The image runs from the external flash, which bootutil has
+             * normally brought up already while validating it.
+             */
+            if (CY_SMIF_SUCCESS != qspi_ensure_init())
+            {
+                return false;
+            }
             qspi_set_mode(CY_SMIF_MEMORY);
+            qspi_xip_cache_enable();
 #endif
 
+            boot_timing.clock_hz = SystemCoreClock;
+            boot_timing_mark(BOOT_TIMING_LAUNCH);
+
             /* Jump to Application on M4 from here.*/
             psoc6_launch_cm4_app(app_addr);
             return true;
@@ -149,28 +223,62 @@ int main(void)
     bool boot_succeeded = false;
     fih_int fih_rc = FIH_FAILURE;
 
+    boot_timing_start();
+    boot_timing.reset_reason = Cy_SysLib_GetResetReason();
+    /* The reason is kept in boot_timing, a later reset must not see it again */
+    Cy_SysLib_ClearResetReason();
+    Cy_SysTick_Init(CY_SYSTICK_CLOCK_SOURCE_CLK_CPU, SysTick_LOAD_RELOAD_Msk);
+    (void)Cy_SysTick_SetCallback(0UL, boot_timing_tick);
+
     /* Initialize system resources and peripherals. */
     cybsp_init();
+    boot_timing_mark(BOOT_TIMING_BSP_INIT);
 
     /* enable global interrupts */
     __enable_irq();
 
 #ifdef CY_BOOT_USE_EXTERNAL_FLASH
-    cy_en_smif_status_t qspi_status = qspi_init_sfdp(QSPI_SLAVE_SELECT_LINE);
+    /* The SMIF is brought up when bootutil first accesses an external flash
+     * area. The external flash maps of this tree keep at least the secondary
+     * slot there, whose trailer boot_swap_type() below reads: the init still
+     * runs on every boot, only its retries back off instead of waiting
+     * 500 ms each.
+     */
+    qspi_defer_init(QSPI_SLAVE_SELECT_LINE, qspi_init_done);
+#endif
+
+    /* Tells a cold boot from a boot that performs a swap or a revert */
+    boot_timing.swap_type = boot_swap_type();
 
-    if (CY_SMIF_SUCCESS == qspi_status)
+    (void)memset(&rsp, 0, sizeof(rsp));
+#ifdef CY_BOOT_CRYPTO_SELF_TEST
+    /* A validation backend that gets a known answer wrong could accept a
+     * forged image: no image is booted then.
+     */
+    if (!crypto_self_test())
     {
-        rc = CY_RSLT_SUCCESS;
+        fih_rc = FIH_FAILURE;
     }
     else
+#endif
+#ifdef CY_BOOT_USE_FAST_BOOT
+    if (fast_boot_try(&rsp, boot_timing.reset_reason))
     {
-        rc = MCUBOOTAPP_RSLT_ERR;
+        fih_rc = FIH_SUCCESS;
     }
-
+    else
 #endif
+    {
+        FIH_CALL(boot_go, fih_rc, &rsp);
 
-    (void)memset(&rsp, 0, sizeof(rsp));
-    FIH_CALL(boot_go, fih_rc, &rsp);
+#ifdef CY_BOOT_USE_FAST_BOOT
+        if (true == fih_eq(fih_rc, FIH_SUCCESS))
+        {
+            fast_boot_update(&rsp);
+        }
+#endif
+    }
+    boot_timing_mark(BOOT_TIMING_BOOT_GO);
 
     if (true == fih_eq(fih_rc, FIH_SUCCESS))
     {
@@ -180,8 +288,10 @@ int main(void)
         * to mark successful start up of this app. if the watchdog is not updated,
         * reset will be initiated by watchdog timer and swap revert operation started
         * to roll back to operable image.
+        * With direct-XIP there is no revert: the reset boots the same image.
         */
         rc = cy_wdg_init(WDT_TIME_OUT_MS);
+        boot_timing_mark(BOOT_TIMING_WDG_INIT);
 
         if (CY_RSLT_SUCCESS == rc)
         {
@@ -0,0 +1,131 @@
+"""UBM Controller RAM Report (map file to per-component table)
+Copyright (c) 2023 Infineon Technologies AG
+
+Sums the static RAM used by each component of the application, from the map
+file written by the GNU linker. A component is a library of the shared repo,
+an archive, or the application sources.
+"""
+
+import sys
+import getopt
+import re
+
+# Output sections placed in the application RAM by linker_app.ld
+RAM_SECTIONS = ('.ramVectors', '.data', '.noinit', '.bss')
+
+OUT_SECTION = re.compile(r'^(\.\S+)(?:\s+0x[0-9a-f]+\s+0x[0-9a-f]+)?\s*$')
+IN_SECTION = re.compile(r'^ (?:\S+)?\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$')
+FILL = re.compile(r'^ \*fill\*\s+0x[0-9a-f]+\s+0x([0-9a-f]+)')
+
+
+class CmdLineParams:
+    """Command line parameters"""
+
+    def __init__(self):
+        self.map_file = ''
+
+        usage = 'USAGE:\n' + sys.argv[0] + \
+                ''' -m <app.map>
+
+OPTIONS:
+-h  --help       Display the usage information
+-m  --map=       Map file of the UBM controller application
+'''
+
+        try:
+            opts, unused = getopt.getopt(sys.argv[1:], 'hm:', ['help', 'map='])
+            if len(unused) > 0:
+                print(usage, file=sys.stderr)
+                sys.exit(1)
+        except getopt.GetoptError:
+            print(usage, file=sys.stderr)
+            sys.exit(1)
+
+        for opt, arg in opts:
+            if opt in ('-h', '--help'):
+                print(usage, file=sys.stderr)
+                sys.exit()
+            elif opt in ('-m', '--map'):
+                self.map_file = arg
+
+        if len(self.map_file) == 0:
+            print(usage, file=sys.stderr)
+            sys.exit(1)
+
+
+def component(path):
+    """Return the component an input file belongs to"""
+    path = path.replace('\\', '/')
+    archive = re.match(r'(.*)\(.*\)$', path)
+    if archive is not None:
+        return archive.group(1).split('/')[-1]
+    for marker in ('/mtb_shared/', '/libs/'):
+        if marker in path:
+            return path.split(marker, 1)[1].split('/')[0]
+    return 'app'
+
+
+def read_map(map_file):
+    """Return {component: {section: bytes}} for the RAM output sections"""
+    try:
+        with open(map_file, 'r', encoding='UTF-8', errors='replace') as map_f:
+            lines = map_f.read().splitlines()
+    except (FileNotFoundError, OSError):
+        print('Cannot open', map_file, file=sys.stderr)
+        sys.exit(4)
+
+    usage = {}
+    section = None
+    pending = None
+    for line in lines:
+        match = OUT_SECTION.match(line)
+        if match is not None:
+            section = match.group(1) if match.group(1) in RAM_SECTIONS else None
+            continue
+        if section is None:
+            continue
+
+        # A long input section name puts the address and size on the next line
+        if pending is not None and line.startswith(' ' * 16):
+            line = ' ' + pending + line
+        pending = None
+
+        match = FILL.match(line)
+        if match is not None:
+            name, size = '*fill*', int(match.group(1), 16)
+        else:
+            match = IN_SECTION.match(line)
+            if match is None:
+                if re.match(r'^ \S+$', line):
+                    pending = line.strip()
+                continue
+            # Discarded or empty
+            if int(match.group(1), 16) == 0 or int(match.group(2), 16) == 0:
+                continue
+            name, size = component(match.group(3)), int(match.group(2), 16)
+
+        sizes = usage.setdefault(name, dict.fromkeys(RAM_SECTIONS, 0))
+        sizes[section] += size
+
+    return usage
+
+
+def main():
+    """RAM report"""
+    params = CmdLineParams()
+    usage = read_map(params.map_file)
+
+    print(f'{"component":24}' + ''.join(f'{s:>12}' for s in RAM_SECTIONS) +
+          f'{"total":>12}')
+    totals = dict.fromkeys(RAM_SECTIONS, 0)
+    for name, sizes in sorted(usage.items(), key=lambda i: -sum(i[1].values())):
+        print(f'{name:24}' + ''.join(f'{sizes[s]:12}' for s in RAM_SECTIONS) +
+              f'{sum(sizes.values()):12}')
+        for sec in RAM_SECTIONS:
+            totals[sec] += sizes[sec]
+    print(f'{"total":24}' + ''.join(f'{totals[s]:12}' for s in RAM_SECTIONS) +
+          f'{sum(totals.values()):12}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,354 @@
+"""UBM Controller Log Decoder (records to text or Chrome trace)
+Copyright (c) 2023 Infineon Technologies AG
+
+Rebuilds the text of the records drained with ubm_log_drain(), or read from
+a dump of the ubm_log variable taken over SWD, using the format strings kept
+in the .ubm_log_fmt section of the application ELF file.
+The records, trace events included, can also be written as a Chrome trace
+(JSON) to be opened in chrome://tracing or ui.perfetto.dev.
+"""
+
+import sys
+import getopt
+import json
+import re
+import struct
+
+RECORD = struct.Struct('<IIII')
+TOKEN_MSK = 0x000FFFFF
+KIND_POS = 20
+NARGS_POS = 22
+SEQ_POS = 24
+TOKEN_LOST = 0
+
+KIND_TEXT = 0
+KIND_BEGIN = 1
+KIND_END = 2
+KIND_INSTANT = 3
+
+FMT_SECTION = '.ubm_log_fmt'
+LOG_SYMBOL = 'ubm_log'
+LOG_MAGIC = 0x474F4C55
+LOG_HEADER = struct.Struct('<III')
+HEADER_BUSY = 3 << NARGS_POS
+SHT_SYMTAB = 2
+CONVERSION = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diuxXoc%])')
+
+
+class CmdLineParams:
+    """Command line parameters"""
+
+    def __init__(self):
+        self.elf_file = ''
+        self.in_file = ''
+        self.hex_input = False
+        self.dump_input = False
+        self.print_address = False
+        self.clock_hz = None
+        self.trace_file = None
+
+        usage = 'USAGE:\n' + sys.argv[0] + \
+                ''' -e <app.elf> -i <records> [-x | -d] [-c <clock_hz>] [-t <trace.json>]
+       ''' + sys.argv[0] + ''' -e <app.elf> -a
+
+OPTIONS:
+-h  --help       Display the usage information
+-e  --elf=       ELF file of the running UBM controller image
+-i  --ifile=     Drained records, '-' for stdin
+-x  --hex        Records are given as hex text instead of binary
+-d  --dump       The input is a dump of the ubm_log variable (binary)
+-a  --address    Print the address and size of the ubm_log variable, to be
+                 dumped over SWD
+-c  --clock=     CPU clock in Hz, prints the timestamps in microseconds
+                 instead of cycles
+-t  --trace=     Write a Chrome trace instead of the text (needs -c)
+'''
+
+        try:
+            opts, unused = getopt.getopt(
+                sys.argv[1:], 'he:i:xdac:t:',
+                ['help', 'elf=', 'ifile=', 'hex', 'dump', 'address', 'clock=',
+                 'trace='])
+            if len(unused) > 0:
+                print(usage, file=sys.stderr)
+                sys.exit(1)
+        except getopt.GetoptError:
+            print(usage, file=sys.stderr)
+            sys.exit(1)
+
+        for opt, arg in opts:
+            if opt in ('-h', '--help'):
+                print(usage, file=sys.stderr)
+                sys.exit()
+            elif opt in ('-e', '--elf'):
+                self.elf_file = arg
+            elif opt in ('-i', '--ifile'):
+                self.in_file = arg
+            elif opt in ('-x', '--hex'):
+                self.hex_input = True
+            elif opt in ('-d', '--dump'):
+                self.dump_input = True
+            elif opt in ('-a', '--address'):
+                self.print_address = True
+            elif opt in ('-c', '--clock'):
+                try:
+                    self.clock_hz = int(arg, 0)
+                except ValueError:
+                    print('Invalid value', arg, 'for clock', file=sys.stderr)
+                    sys.exit(6)
+            elif opt in ('-t', '--trace'):
+                self.trace_file = arg
+
+        if len(self.elf_file) == 0 or \
+                (len(self.in_file) == 0 and not self.print_address) or \
+                (self.hex_input and self.dump_input) or \
+                (self.trace_file is not None and not self.clock_hz):
+            print(usage, file=sys.stderr)
+            sys.exit(1)
+
+
+def read_elf(elf_file):
+    """Return the content of the ELF file"""
+    try:
+        with open(elf_file, 'rb') as elf_f:
+            elf = elf_f.read()
+    except (FileNotFoundError, OSError):
+        print('Cannot open', elf_file, file=sys.stderr)
+        sys.exit(4)
+
+    if elf[:4] != b'\x7fELF' or elf[4] != 1 or elf[5] != 1:
+        print(elf_file, 'is not a 32-bit little endian ELF file',
+              file=sys.stderr)
+        sys.exit(5)
+
+    return elf
+
+
+def elf_string(elf, offset):
+    """Return the null terminated string at offset"""
+    return elf[offset:elf.index(b'\0', offset)].decode(errors='replace')
+
+
+def elf_sections(elf):
+    """Return the section headers: (name, sh_type, sh_addr, sh_offset,
+    sh_size, sh_link)"""
+    e_shoff, = struct.unpack_from('<I', elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from('<HHH', elf, 0x2E)
+
+    def section(index):
+        # sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size, sh_link
+        return struct.unpack_from('<IIIIIII', elf, e_shoff + index * e_shentsize)
+
+    names_off = section(e_shstrndx)[4]
+    sections = []
+    for index in range(e_shnum):
+        sh_name, sh_type, _, sh_addr, sh_offset, sh_size, sh_link = section(index)
+        sections.append((elf_string(elf, names_off + sh_name), sh_type,
+                         sh_addr, sh_offset, sh_size, sh_link))
+    return sections
+
+
+def read_fmt_section(elf_file, elf):
+    """Return the address and content of the format string section"""
+    for name, _, sh_addr, sh_offset, sh_size, _ in elf_sections(elf):
+        if name == FMT_SECTION:
+            return sh_addr, elf[sh_offset:sh_offset + sh_size]
+
+    print('No', FMT_SECTION, 'section in', elf_file, file=sys.stderr)
+    sys.exit(5)
+
+
+def read_symbol(elf_file, elf, symbol):
+    """Return the address and size of a data symbol, static ones included"""
+    sections = elf_sections(elf)
+    for _, sh_type, _, sh_offset, sh_size, sh_link in sections:
+        if sh_type != SHT_SYMTAB:
+            continue
+        names_off = sections[sh_link][3]
+        # st_name, st_value, st_size
+        for st_name, st_value, st_size in struct.iter_unpack(
+                '<III4x', elf[sh_offset:sh_offset + sh_size]):
+            if st_size != 0 and elf_string(elf, names_off + st_name) == symbol:
+                return st_value, st_size
+
+    print('No', symbol, 'symbol in', elf_file, '(stripped?)', file=sys.stderr)
+    sys.exit(5)
+
+
+def read_records(in_file, hex_input):
+    """Return the input as bytes"""
+    try:
+        if in_file == '-':
+            data = sys.stdin.buffer.read()
+        else:
+            with open(in_file, 'rb') as in_f:
+                data = in_f.read()
+    except (FileNotFoundError, OSError):
+        print('Cannot open', in_file, file=sys.stderr)
+        sys.exit(4)
+
+    if hex_input:
+        try:
+            data = bytes.fromhex(data.decode(errors='replace'))
+        except ValueError:
+            print('Invalid hex input', file=sys.stderr)
+            sys.exit(6)
+
+    return data
+
+
+def trim_records(data):
+    """Return the whole records of the drained data"""
+    if len(data) % RECORD.size != 0:
+        print('Note: ignoring', len(data) % RECORD.size,
+              'trailing bytes', file=sys.stderr)
+    return data[:len(data) - len(data) % RECORD.size]
+
+
+def read_dump(data, size):
+    """Return the records held in a dump of the ubm_log variable, oldest
+    first, as ubm_log_drain() would give them without the tail: the records
+    already drained by the application are included."""
+    if len(data) < size:
+        print('The dump has', len(data), 'bytes, ubm_log has', size,
+              file=sys.stderr)
+        sys.exit(6)
+
+    magic, head, _ = LOG_HEADER.unpack_from(data)
+    if magic != LOG_MAGIC:
+        print('No log in the dump (magic', hex(magic) + ')', file=sys.stderr)
+        sys.exit(6)
+
+    count = (size - LOG_HEADER.size) // RECORD.size
+    records = b''
+    for seq in range(max(head - count, 0), head):
+        offset = LOG_HEADER.size + (seq % count) * RECORD.size
+        header, = struct.unpack_from('<I', data, offset)
+        # Skip a record being written when the CPU was halted
+        if (header >> SEQ_POS) != (seq & 0xFF) or \
+                (header & HEADER_BUSY) == HEADER_BUSY:
+            continue
+        records += data[offset:offset + RECORD.size]
+    return records
+
+
+def format_record(fmt, args):
+    """Apply a C format string to 32-bit integer arguments"""
+    args = list(args)
+
+    def convert(match):
+        flags, conv = match.groups()
+        if conv == '%':
+            return '%'
+        val = args.pop(0) if args else 0
+        if conv in 'di':
+            conv = 'd'
+            val = val - (1 << 32) if val & 0x80000000 else val
+        elif conv == 'u':
+            conv = 'd'
+        elif conv == 'c':
+            val = chr(val & 0xFF)
+        return ('%' + flags + conv) % val
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(fmt_addr, fmt_data, data):
+    """Yield (cycles, seq, kind, text, args) for each record. The 32-bit
+    cycle count is extended, a record earlier than the previous one by more
+    than half the counter range is taken as a wrap."""
+    cycles = None
+    for header, stamp, arg0, arg1 in RECORD.iter_unpack(data):
+        token = header & TOKEN_MSK
+        kind = (header >> KIND_POS) & 0x3
+        nargs = (header >> NARGS_POS) & 0x3
+
+        if cycles is None:
+            cycles = stamp
+        else:
+            delta = (stamp - cycles) & 0xFFFFFFFF
+            cycles += delta - (1 << 32) if delta & 0x80000000 else delta
+
+        if token == TOKEN_LOST:
+            text = f'<{arg0} records lost>'
+        else:
+            offset = token - (fmt_addr & TOKEN_MSK)
+            if 0 <= offset < len(fmt_data):
+                end = fmt_data.find(b'\0', offset)
+                text = fmt_data[offset:end].decode(errors='replace')
+                if kind == KIND_TEXT:
+                    text = format_record(text, (arg0, arg1)[:nargs])
+            else:
+                text = f'<unknown token {token:#x}: {arg0:#x} {arg1:#x}>'
+        yield cycles, header >> SEQ_POS, kind, text, (arg0, arg1)
+
+
+def write_trace(trace_file, clock_hz, records):
+    """Write the records as a Chrome trace. Trace events are placed on the
+    track of the exception they were recorded in, log records on their own
+    track."""
+    phases = {KIND_BEGIN: 'B', KIND_END: 'E', KIND_INSTANT: 'i'}
+    events = []
+    for cycles, _, kind, text, args in records:
+        event = {'name': text, 'ph': phases.get(kind, 'i'),
+                 'ts': cycles * 1000000 / clock_hz, 'pid': 0}
+        if kind == KIND_TEXT:
+            event.update({'tid': 'log', 's': 't'})
+        else:
+            if args[1] == 0:
+                event['tid'] = 'main'
+            elif args[1] < 16:
+                event['tid'] = f'exception {args[1]}'
+            else:
+                event['tid'] = f'irq {args[1] - 16}'
+            event['cat'] = text.split(':')[0]
+            if kind == KIND_INSTANT:
+                event.update({'s': 't', 'args': {'value': args[0]}})
+        events.append(event)
+
+    try:
+        with open(trace_file, 'w', encoding='UTF-8') as out_f:
+            json.dump({'traceEvents': events, 'displayTimeUnit': 'ns'},
+                      out_f, indent=1)
+    except (FileNotFoundError, OSError):
+        print('Cannot create', trace_file, file=sys.stderr)
+        sys.exit(4)
+
+
+def main():
+    """Log decoder"""
+    params = CmdLineParams()
+    elf = read_elf(params.elf_file)
+
+    if params.print_address or params.dump_input:
+        log_addr, log_size = read_symbol(params.elf_file, elf, LOG_SYMBOL)
+        if params.print_address:
+            print(f'{log_addr:#010x} {log_size}')
+            return
+
+    data = read_records(params.in_file, params.hex_input)
+    if params.dump_input:
+        data = read_dump(data, log_size)
+    else:
+        data = trim_records(data)
+
+    fmt_addr, fmt_data = read_fmt_section(params.elf_file, elf)
+    records = decode(fmt_addr, fmt_data, data)
+
+    if params.trace_file is not None:
+        write_trace(params.trace_file, params.clock_hz, records)
+        return
+
+    marks = {KIND_BEGIN: 'begin ', KIND_END: 'end ', KIND_INSTANT: ''}
+    for cycles, seq, kind, text, args in records:
+        if params.clock_hz:
+            when = f'{cycles * 1000000 // params.clock_hz:>10} us'
+        else:
+            when = f'{cycles:>10}'
+        if kind == KIND_INSTANT:
+            text += f' {args[0]}'
+        print(when, f'{seq:3}', marks.get(kind, '') + text)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,382 @@
+/******************************************************************************
+* File Name:   cy_pdl.h
+*
+* Description: Host stand-in for the PDL header, with the subset of the SMIF,
+*              GPIO, SysClk, SysLib, Flash and DWT interfaces flash_qspi.c and
+*              the MCUboot flash PAL use. The names, types and enumerator
+*              values follow the PDL of the PSoC 6 CM4; the functions are
+*              implemented in pdl_sim.c on top of nor_sim.c.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(CY_PDL_H)
+#define CY_PDL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define CY_SECTION(name)                    __attribute__((section(name)))
+#define CY_ALIGN(align)                     __attribute__((aligned(align)))
+
+#define CY_CPU_CORTEX_M0P                   (0U)
+
+#define CY_XIP_BASE                         (0x18000000UL)
+#define CY_XIP_SIZE                         (0x08000000UL)
+#define CY_FLASH_SIZEOF_ROW                 (512UL)
+
+#define SMIF_CHIP_TOP_SPI_SEL_NR            (4U)
+
+#define SMIF_CTL_CLOCK_IF_RX_SEL_Pos        (12UL)
+#define SMIF_CTL_CLOCK_IF_RX_SEL_Msk        (0x7000UL)
+#define SMIF_CTL(base)                      (((SMIF_Type *)(base))->CTL)
+
+#define _VAL2FLD(field, value)              (((uint32_t)(value) << field ## _Pos) & field ## _Msk)
+#define _FLD2VAL(field, value)              (((uint32_t)(value) & field ## _Msk) >> field ## _Pos)
+#define _CLR_SET_FLD32U(reg, field, value)  (((reg) & ~(field ## _Msk)) | _VAL2FLD(field, value))
+
+#define CY_SMIF_FLAG_MEMORY_MAPPED          (1UL)
+#define CY_SMIF_FLAG_WR_EN                  (2UL)
+#define CY_SMIF_FLAG_DETECT_SFDP            (4UL)
+#define CY_SMIF_NO_COMMAND_OR_MODE          (0xFFFFFFFFUL)
+
+#define CY_SMIF_TX_NOT_LAST_BYTE            (0U)
+#define CY_SMIF_TX_LAST_BYTE                (1U)
+
+/* Register stand-ins, each access of DWT advances the simulated time */
+#define SMIF0                               (&pdl_sim_smif0)
+#define GPIO_PRT11                          (&pdl_sim_gpio[11])
+#define GPIO_PRT12                          (&pdl_sim_gpio[12])
+#define DWT                                 (pdl_sim_dwt())
+#define CoreDebug                           (&pdl_sim_core_debug)
+#define DWT_CTRL_CYCCNTENA_Msk              (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk          (1UL << 24)
+
+#define PDL_SIM_GPIO_PORT_NUM               (15U)
+#define PDL_SIM_GPIO_PIN_NUM                (8U)
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef struct
+{
+    volatile uint32_t CTL;
+} SMIF_Type;
+
+typedef struct
+{
+    uint32_t port;
+    uint32_t hsiom[PDL_SIM_GPIO_PIN_NUM];
+    uint32_t drive_mode[PDL_SIM_GPIO_PIN_NUM];
+} GPIO_PRT_Type;
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+/* The HSIOM value of the SMIF function of port 11 and P12_4 is the same */
+typedef enum
+{
+    HSIOM_SEL_GPIO = 0,
+    P11_0_SMIF_SPI_SELECT2 = 26,
+    P11_1_SMIF_SPI_SELECT1 = 26,
+    P11_2_SMIF_SPI_SELECT0 = 26,
+    P11_3_SMIF_SPI_DATA3 = 26,
+    P11_4_SMIF_SPI_DATA2 = 26,
+    P11_5_SMIF_SPI_DATA1 = 26,
+    P11_6_SMIF_SPI_DATA0 = 26,
+    P11_7_SMIF_SPI_CLK = 26,
+    P12_4_SMIF_SPI_SELECT3 = 26,
+} en_hsiom_sel_t;
+
+#define CY_GPIO_DM_ANALOG                   (0x00UL)
+#define CY_GPIO_DM_STRONG_IN_OFF            (0x06UL)
+#define CY_GPIO_DM_STRONG                   (0x0EUL)
+#define CY_GPIO_INTR_DISABLE                (0x00UL)
+#define CY_GPIO_VTRIP_CMOS                  (0x00UL)
+#define CY_GPIO_SLEW_FAST                   (0x00UL)
+#define CY_GPIO_DRIVE_1_2                   (0x01UL)
+
+typedef enum
+{
+    CY_GPIO_SUCCESS = 0x00U,
+    CY_GPIO_BAD_PARAM = 0x01U,
+} cy_en_gpio_status_t;
+
+typedef struct
+{
+    uint32_t outVal;
+    uint32_t driveMode;
+    en_hsiom_sel_t hsiom;
+    uint32_t intEdge;
+    uint32_t intMask;
+    uint32_t vtrip;
+    uint32_t slewRate;
+    uint32_t driveSel;
+    uint32_t vregEn;
+    uint32_t ibufMode;
+    uint32_t vtripSel;
+    uint32_t vrefSel;
+    uint32_t vohSel;
+} cy_stc_gpio_pin_config_t;
+
+typedef enum
+{
+    CY_SYSCLK_CLKHF_IN_CLKPATH0 = 0U,
+    CY_SYSCLK_CLKHF_IN_CLKPATH1 = 1U,
+    CY_SYSCLK_CLKHF_IN_CLKPATH2 = 2U,
+} cy_en_clkhf_in_sources_t;
+
+typedef enum
+{
+    CY_SYSCLK_CLKHF_NO_DIVIDE = 0U,
+    CY_SYSCLK_CLKHF_DIVIDE_BY_2 = 1U,
+    CY_SYSCLK_CLKHF_DIVIDE_BY_4 = 2U,
+    CY_SYSCLK_CLKHF_DIVIDE_BY_8 = 3U,
+} cy_en_clkhf_dividers_t;
+
+typedef enum
+{
+    CY_SYSCLK_SUCCESS = 0x00UL,
+    CY_SYSCLK_BAD_PARAM = 0x01UL,
+} cy_en_sysclk_status_t;
+
+typedef enum
+{
+    CY_FLASH_DRV_SUCCESS = 0x00UL,
+    CY_FLASH_DRV_INVALID_INPUT_PARAMETERS = 0x01UL,
+    CY_FLASH_DRV_ERR_UNC = 0x02UL,
+} cy_en_flashdrv_status_t;
+
+typedef enum
+{
+    CY_SMIF_SUCCESS = 0x00U,
+    CY_SMIF_EXCEED_TIMEOUT = 0x01U,
+    CY_SMIF_NO_QE_BIT = 0x02U,
+    CY_SMIF_BUSY = 0x03U,
+    CY_SMIF_BAD_PARAM = 0x04U,
+    CY_SMIF_NO_SFDP_SUPPORT = 0x05U,
+    CY_SMIF_SFDP_SS0_FAILED = 0x10U,
+} cy_en_smif_status_t;
+
+typedef enum
+{
+    CY_SMIF_NORMAL = 0U,
+    CY_SMIF_MEMORY = 1U,
+} cy_en_smif_mode_t;
+
+typedef enum
+{
+    CY_SMIF_SEL_OUTPUT_CLK = 0U,
+    CY_SMIF_SEL_INV_OUTPUT_CLK = 1U,
+    CY_SMIF_SEL_FEEDBACK_CLK = 2U,
+    CY_SMIF_SEL_INV_FEEDBACK_CLK = 3U,
+    CY_SMIF_SEL_INTERNAL_CLK = 4U,
+    CY_SMIF_SEL_INV_INTERNAL_CLK = 5U,
+} cy_en_smif_clk_select_rx_t;
+
+typedef enum
+{
+    CY_SMIF_WIDTH_SINGLE = 0U,
+    CY_SMIF_WIDTH_DUAL = 1U,
+    CY_SMIF_WIDTH_QUAD = 2U,
+    CY_SMIF_WIDTH_OCTAL = 3U,
+} cy_en_smif_txfr_width_t;
+
+typedef enum
+{
+    CY_SMIF_SLAVE_SELECT_0 = 1U,
+    CY_SMIF_SLAVE_SELECT_1 = 2U,
+    CY_SMIF_SLAVE_SELECT_2 = 4U,
+    CY_SMIF_SLAVE_SELECT_3 = 8U,
+} cy_en_smif_slave_select_t;
+
+typedef enum
+{
+    CY_SMIF_DATA_SEL0 = 0U,
+    CY_SMIF_DATA_SEL1 = 1U,
+    CY_SMIF_DATA_SEL2 = 2U,
+    CY_SMIF_DATA_SEL3 = 3U,
+} cy_en_smif_data_select_t;
+
+typedef enum
+{
+    CY_SMIF_CACHE_SLOW = 1U,
+    CY_SMIF_CACHE_FAST = 2U,
+    CY_SMIF_CACHE_BOTH = 3U,
+} cy_en_smif_cache_t;
+
+typedef enum
+{
+    CY_SMIF_BUS_ERROR = 0UL,
+    CY_SMIF_WAIT_STATES = 1UL,
+} cy_en_smif_error_event_t;
+
+typedef struct
+{
+    uint32_t command;
+    cy_en_smif_txfr_width_t cmdWidth;
+    cy_en_smif_txfr_width_t addrWidth;
+    uint32_t mode;
+    cy_en_smif_txfr_width_t modeWidth;
+    uint32_t dummyCycles;
+    cy_en_smif_txfr_width_t dataWidth;
+} cy_stc_smif_mem_cmd_t;
+
+typedef struct
+{
+    uint32_t numOfAddrBytes;
+    uint32_t memSize;
+    cy_stc_smif_mem_cmd_t *readCmd;
+    cy_stc_smif_mem_cmd_t *writeEnCmd;
+    cy_stc_smif_mem_cmd_t *writeDisCmd;
+    cy_stc_smif_mem_cmd_t *eraseCmd;
+    uint32_t eraseSize;
+    cy_stc_smif_mem_cmd_t *chipEraseCmd;
+    cy_stc_smif_mem_cmd_t *programCmd;
+    uint32_t programSize;
+    cy_stc_smif_mem_cmd_t *readStsRegWipCmd;
+    cy_stc_smif_mem_cmd_t *readStsRegQeCmd;
+    cy_stc_smif_mem_cmd_t *writeStsRegQeCmd;
+    cy_stc_smif_mem_cmd_t *readSfdpCmd;
+    uint32_t stsRegBusyMask;
+    uint32_t stsRegQuadEnableMask;
+    uint32_t eraseTime;                 /* ms */
+    uint32_t chipEraseTime;             /* ms */
+    uint32_t programTime;               /* us */
+    uint32_t hybridRegionCount;
+    void **hybridRegionInfo;
+} cy_stc_smif_mem_device_cfg_t;
+
+typedef struct
+{
+    cy_en_smif_slave_select_t slaveSelect;
+    uint32_t flags;
+    cy_en_smif_data_select_t dataSelect;
+    uint32_t baseAddress;
+    uint32_t memMappedSize;
+    bool dualQuadSlots;
+    cy_stc_smif_mem_device_cfg_t *deviceCfg;
+} cy_stc_smif_mem_config_t;
+
+typedef struct
+{
+    uint32_t memCount;
+    cy_stc_smif_mem_config_t **memConfig;
+    uint32_t majorVersion;
+    uint32_t minorVersion;
+} cy_stc_smif_block_config_t;
+
+typedef struct
+{
+    uint32_t mode;
+    uint32_t deselectDelay;
+    uint32_t rxClockSel;
+    uint32_t blockEvent;
+} cy_stc_smif_config_t;
+
+typedef struct
+{
+    uint16_t memReadyPollDelay;         /* us */
+    uint32_t timeout;
+} cy_stc_smif_context_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+extern SMIF_Type pdl_sim_smif0;
+extern GPIO_PRT_Type pdl_sim_gpio[PDL_SIM_GPIO_PORT_NUM];
+extern CoreDebug_Type pdl_sim_core_debug;
+extern uint32_t SystemCoreClock;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+DWT_Type *pdl_sim_dwt(void);
+
+cy_en_gpio_status_t Cy_GPIO_Pin_Init(GPIO_PRT_Type *base, uint32_t pinNum,
+                                     const cy_stc_gpio_pin_config_t *config);
+void Cy_GPIO_SetHSIOM(GPIO_PRT_Type *base, uint32_t pinNum, en_hsiom_sel_t value);
+void Cy_GPIO_SetDrivemode(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value);
+void Cy_GPIO_Port_Deinit(GPIO_PRT_Type *base);
+
+cy_en_sysclk_status_t Cy_SysClk_ClkHfSetSource(uint32_t clkHf, cy_en_clkhf_in_sources_t source);
+cy_en_sysclk_status_t Cy_SysClk_ClkHfSetDivider(uint32_t clkHf, cy_en_clkhf_dividers_t divider);
+cy_en_sysclk_status_t Cy_SysClk_ClkHfEnable(uint32_t clkHf);
+cy_en_sysclk_status_t Cy_SysClk_ClkHfDisable(uint32_t clkHf);
+uint32_t Cy_SysClk_ClkPathGetFrequency(uint32_t clkPath);
+
+void Cy_SysLib_Delay(uint32_t milliseconds);
+void Cy_SysLib_DelayUs(uint16_t microseconds);
+
+cy_en_flashdrv_status_t Cy_Flash_EraseRow(uint32_t rowAddr);
+cy_en_flashdrv_status_t Cy_Flash_ProgramRow(uint32_t rowAddr, const uint32_t *data);
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data);
+
+cy_en_smif_status_t Cy_SMIF_Init(SMIF_Type *base, cy_stc_smif_config_t const *config,
+                                 uint32_t timeout, cy_stc_smif_context_t *context);
+void Cy_SMIF_Enable(SMIF_Type *base, cy_stc_smif_context_t *context);
+void Cy_SMIF_Disable(SMIF_Type *base);
+void Cy_SMIF_SetMode(SMIF_Type *base, cy_en_smif_mode_t mode);
+cy_en_smif_mode_t Cy_SMIF_GetMode(SMIF_Type const *base);
+void Cy_SMIF_SetReadyPollingDelay(uint16_t pollTimeoutUs, cy_stc_smif_context_t *context);
+cy_en_smif_status_t Cy_SMIF_CacheEnable(SMIF_Type *base, cy_en_smif_cache_t cacheType);
+cy_en_smif_status_t Cy_SMIF_CacheInvalidate(SMIF_Type *base, cy_en_smif_cache_t cacheType);
+cy_en_smif_status_t Cy_SMIF_CachePrefetchingEnable(SMIF_Type *base, cy_en_smif_cache_t cacheType);
+
+cy_en_smif_status_t Cy_SMIF_TransmitCommand(SMIF_Type *base, uint8_t cmd,
+                                            cy_en_smif_txfr_width_t cmdTxfrWidth,
+                                            uint8_t const cmdParam[], uint32_t paramSize,
+                                            cy_en_smif_txfr_width_t paramTxfrWidth,
+                                            cy_en_smif_slave_select_t slaveSelect,
+                                            uint32_t completeTxfr,
+                                            cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_TransmitDataBlocking(SMIF_Type *base, uint8_t const *txBuffer,
+                                                 uint32_t size,
+                                                 cy_en_smif_txfr_width_t transferWidth,
+                                                 cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_ReceiveDataBlocking(SMIF_Type *base, uint8_t *rxBuffer,
+                                                uint32_t size,
+                                                cy_en_smif_txfr_width_t transferWidth,
+                                                cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_SendDummyCycles(SMIF_Type *base, uint32_t cycles);
+
+cy_en_smif_status_t Cy_SMIF_MemInit(SMIF_Type *base, cy_stc_smif_block_config_t const *blockConfig,
+                                    cy_stc_smif_context_t *context);
+void Cy_SMIF_MemDeInit(SMIF_Type *base);
+cy_en_smif_status_t Cy_SMIF_MemRead(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                    uint32_t address, uint8_t rxBuffer[], uint32_t length,
+                                    cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_MemWrite(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                     uint32_t address, uint8_t const txBuffer[], uint32_t length,
+                                     cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_MemEraseSector(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                           uint32_t address, uint32_t length,
+                                           cy_stc_smif_context_t const *context);
+bool Cy_SMIF_Memory_IsBusy(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                           cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_MemIsQuadEnabled(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                                             bool *isQuadEnabled, cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_MemEnableQuadMode(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                                              uint32_t timeoutUs, cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_MemCmdWriteEnable(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                                              cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_MemCmdSectorErase(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                                              uint8_t const *sectorAddr,
+                                              cy_stc_smif_context_t const *context);
+
+#endif /* CY_PDL_H */
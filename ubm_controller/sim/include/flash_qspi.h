@@ -0,0 +1,36 @@
+/******************************************************************************
+* File Name:   flash_qspi.h
+*
+* Description: Host stand-in for the flash_qspi.h of the MCUboot Cypress
+*              platform port: the interface flash_qspi.c implements for the
+*              flash PAL.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(FLASH_QSPI_H)
+#define FLASH_QSPI_H
+
+#include <stdint.h>
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_en_smif_status_t qspi_init_sfdp(uint32_t smif_id);
+cy_en_smif_status_t qspi_init(cy_stc_smif_block_config_t *blk_config);
+cy_en_smif_status_t qspi_init_hardware(void);
+uint32_t qspi_get_prog_size(void);
+uint32_t qspi_get_erase_size(void);
+uint32_t qspi_get_mem_size(void);
+SMIF_Type *qspi_get_device(void);
+cy_stc_smif_context_t *qspi_get_context(void);
+cy_stc_smif_mem_config_t *qspi_get_memory_config(uint8_t index);
+void qspi_deinit(uint32_t smif_id);
+void qspi_set_mode(cy_en_smif_mode_t mode);
+cy_en_smif_mode_t qspi_get_mode(void);
+
+#endif /* FLASH_QSPI_H */
@@ -0,0 +1,1151 @@
+/******************************************************************************
+* File Name:   nor_sim.c
+*
+* Description: Host model of the SPI NOR parts behind the SMIF, see nor_sim.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nor_sim.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Granularity of the XIP read accounting, the host page size */
+#define NOR_SIM_XIP_PAGE                    (4096UL)
+
+#define NOR_SIM_PAGE_MAX                    (512U)
+#define NOR_SIM_PARAM_MAX                   (8U)
+#define NOR_SIM_WRSR_MAX                    (2U)
+
+#define NOR_SIM_SR1_WIP                     (0x01U)
+#define NOR_SIM_SR1_WEL                     (0x02U)
+#define NOR_SIM_SR2_QE                      (0x02U)
+#define NOR_SIM_SR2_SUS                     (0x80U)
+
+/* SCK cycles of the chip select setup and the deselect time */
+#define NOR_SIM_CS_CYCLES                   (2U)
+
+/* Fast read and Read SFDP dummy cycles */
+#define NOR_SIM_FAST_READ_DUMMY             (8U)
+
+/* Violations printed, the others are only counted */
+#define NOR_SIM_VIOLATION_PRINT_MAX         (20U)
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef enum
+{
+    NOR_CMD_READ,
+    NOR_CMD_SFDP,
+    NOR_CMD_JEDEC_ID,
+    NOR_CMD_RDSR1,
+    NOR_CMD_RDSR2,
+    NOR_CMD_PROGRAM,
+    NOR_CMD_ERASE,
+    NOR_CMD_CHIP_ERASE,
+    NOR_CMD_WREN,
+    NOR_CMD_WRDI,
+    NOR_CMD_WRSR,
+    NOR_CMD_WRSR2,
+    NOR_CMD_SUSPEND,
+    NOR_CMD_RESUME,
+} nor_cmd_kind_t;
+
+/* Bus phases of a command */
+typedef struct
+{
+    nor_cmd_kind_t kind;
+    uint8_t addr_bytes;
+    uint8_t addr_lines;
+    uint8_t mode_bytes;
+    uint8_t dummy;
+    uint8_t data_lines;
+    uint32_t erase_size;
+    uint32_t erase_us;
+} nor_cmd_t;
+
+typedef enum
+{
+    NOR_BUSY_NONE,
+    NOR_BUSY_PROGRAM,
+    NOR_BUSY_ERASE,
+    NOR_BUSY_WRSR,
+} nor_busy_t;
+
+typedef struct
+{
+    bool connected;                     /* Slave select pin routed to the SMIF */
+    uint8_t sr1;                        /* WEL only, WIP is derived */
+    uint8_t sr2;                        /* QE */
+    nor_busy_t busy;
+    uint64_t busy_end;
+    uint32_t busy_addr;
+    uint32_t busy_len;
+    uint8_t page[NOR_SIM_PAGE_MAX];     /* Program: data of the page, 0xFF elsewhere */
+    uint8_t wrsr[NOR_SIM_WRSR_MAX];
+    uint32_t wrsr_len;
+    bool wrsr_sr2_only;
+    bool suspend_pending;
+    uint64_t suspend_at;
+    bool suspended;
+    uint64_t remaining;
+    bool resumed;
+    uint64_t resume_time;
+    bool xip_mapped;
+    nor_sim_xip_cmd_t xip;
+} nor_chip_t;
+
+/* Transaction between chip select and deselect */
+typedef struct
+{
+    bool active;
+    uint32_t chip;
+    bool ignore;                        /* No answer: no part, busy, bad command */
+    bool opcode_seen;
+    uint8_t opcode;
+    nor_cmd_t cmd;
+    uint8_t param[NOR_SIM_PARAM_MAX];
+    uint32_t param_len;
+    uint32_t addr;
+    uint32_t dummy;
+    uint32_t data_len;                  /* Bytes written or read after the parameters */
+    bool garbled;                       /* Wrong dummy count or width: data is shifted */
+} nor_txn_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const nor_sim_part_t *nor_part;
+static uint32_t nor_chip_count;
+static nor_chip_t nor_chips[NOR_SIM_CHIP_NUM_MAX];
+static nor_txn_t nor_txn;
+static bool nor_bus_connected;
+
+static uint64_t nor_time;
+static uint32_t nor_spi_hz;
+static uint32_t nor_sample_ns;
+
+static int nor_fd = -1;
+static uint8_t *nor_mem;
+static size_t nor_mem_size;
+static uint8_t *nor_xip_base;
+static size_t nor_xip_size;
+static bool nor_xip_memory_mode;
+static struct sigaction nor_prev_segv;
+
+static nor_sim_stats_t nor_stats;
+
+/******************************************************************************
+ * Function Name: nor_sim_violation
+ ******************************************************************************
+ * Summary:
+ *  Counts a misuse of the parts, prints the first ones with the time.
+ *
+ ******************************************************************************/
+void nor_sim_violation(const char *fmt, ...)
+{
+    va_list args;
+
+    nor_stats.violations++;
+    if (nor_stats.violations <= NOR_SIM_VIOLATION_PRINT_MAX)
+    {
+        fprintf(stderr, "nor_sim: %llu us: ", (unsigned long long)(nor_time / 1000U));
+        va_start(args, fmt);
+        vfprintf(stderr, fmt, args);
+        va_end(args);
+        fputc('\n', stderr);
+    }
+}
+
+const nor_sim_part_t *nor_sim_find_part(const char *name)
+{
+    for (uint32_t i = 0U; i < nor_sim_part_count; i++)
+    {
+        if (0 == strcmp(nor_sim_parts[i].name, name))
+        {
+            return &nor_sim_parts[i];
+        }
+    }
+
+    return NULL;
+}
+
+uint64_t nor_sim_time_ns(void)
+{
+    return nor_time;
+}
+
+void nor_sim_wait_ns(uint64_t ns)
+{
+    nor_time += ns;
+}
+
+const nor_sim_stats_t *nor_sim_stats(void)
+{
+    return &nor_stats;
+}
+
+void nor_sim_reset_stats(void)
+{
+    (void)memset(&nor_stats, 0, sizeof(nor_stats));
+}
+
+uint8_t *nor_sim_contents(void)
+{
+    return nor_mem;
+}
+
+/* Advances the time by SCK cycles */
+static void nor_sim_cycles(uint64_t cycles)
+{
+    if (0U != nor_spi_hz)
+    {
+        nor_time += (cycles * 1000000000ULL + nor_spi_hz - 1U) / nor_spi_hz;
+    }
+}
+
+/* Cycles to move len bytes over lines data lines */
+static uint64_t nor_sim_bytes_cycles(uint32_t len, uint32_t lines)
+{
+    return ((uint64_t)len * 8U) / ((0U != lines) ? lines : 1U);
+}
+
+static uint8_t *nor_sim_chip_mem(uint32_t chip)
+{
+    return &nor_mem[(size_t)chip * nor_part->flash_size];
+}
+
+/* Completes the program, erase or status write of a chip */
+static void nor_sim_complete(nor_chip_t *chip, uint32_t index)
+{
+    uint8_t *mem = nor_sim_chip_mem(index);
+
+    switch (chip->busy)
+    {
+    case NOR_BUSY_PROGRAM:
+        for (uint32_t i = 0U; i < nor_part->page_size; i++)
+        {
+            mem[chip->busy_addr + i] &= chip->page[i];
+        }
+        break;
+    case NOR_BUSY_ERASE:
+        (void)memset(&mem[chip->busy_addr], 0xFF, chip->busy_len);
+        break;
+    case NOR_BUSY_WRSR:
+        if (chip->wrsr_sr2_only)
+        {
+            chip->sr2 = chip->wrsr[0];
+        }
+        else if (chip->wrsr_len > 1U)
+        {
+            chip->sr2 = chip->wrsr[1];
+        }
+        break;
+    default:
+        break;
+    }
+
+    chip->busy = NOR_BUSY_NONE;
+    chip->sr1 &= (uint8_t)~NOR_SIM_SR1_WEL;
+}
+
+/* Brings a chip up to the current time */
+static void nor_sim_update(uint32_t index)
+{
+    nor_chip_t *chip = &nor_chips[index];
+
+    if (chip->busy == NOR_BUSY_NONE)
+    {
+        chip->suspend_pending = false;
+        return;
+    }
+
+    if (chip->suspend_pending)
+    {
+        if (chip->busy_end <= chip->suspend_at)
+        {
+            /* Done before the suspend took effect */
+            if (nor_time >= chip->busy_end)
+            {
+                chip->suspend_pending = false;
+                nor_sim_complete(chip, index);
+            }
+        }
+        else if (nor_time >= chip->suspend_at)
+        {
+            chip->suspend_pending = false;
+            chip->suspended = true;
+            chip->remaining = chip->busy_end - chip->suspend_at;
+        }
+        return;
+    }
+
+    if ((!chip->suspended) && (nor_time >= chip->busy_end))
+    {
+        nor_sim_complete(chip, index);
+    }
+}
+
+/* Busy as seen on the WIP bit */
+static bool nor_sim_busy(uint32_t index)
+{
+    nor_sim_update(index);
+
+    return (nor_chips[index].busy != NOR_BUSY_NONE) && (!nor_chips[index].suspended);
+}
+
+/* Starts a program, erase or status write */
+static void nor_sim_start_busy(nor_chip_t *chip, nor_busy_t busy, uint64_t us)
+{
+    chip->busy = busy;
+    chip->busy_end = nor_time + (us * 1000U);
+    chip->suspended = false;
+    chip->suspend_pending = false;
+    chip->resumed = false;
+    nor_stats.busy_ns += us * 1000U;
+}
+
+/* Bus phases of an opcode, false if the part does not know it */
+static bool nor_sim_decode(uint8_t opcode, nor_cmd_t *cmd)
+{
+    const nor_sim_part_t *p = nor_part;
+    uint8_t addr_bytes = 3U;
+
+    (void)memset(cmd, 0, sizeof(*cmd));
+    cmd->addr_lines = 1U;
+    cmd->data_lines = 1U;
+
+    switch (opcode)
+    {
+    case 0x13U: case 0x0CU: case 0x12U:
+        if (!p->addr_4b)
+        {
+            return false;
+        }
+        addr_bytes = 4U;
+        break;
+    default:
+        break;
+    }
+
+    switch (opcode)
+    {
+    case 0x03U: case 0x13U:
+        cmd->kind = NOR_CMD_READ;
+        cmd->addr_bytes = addr_bytes;
+        return true;
+    case 0x0BU: case 0x0CU:
+        cmd->kind = NOR_CMD_READ;
+        cmd->addr_bytes = addr_bytes;
+        cmd->dummy = NOR_SIM_FAST_READ_DUMMY;
+        return true;
+    case 0x02U: case 0x12U:
+        cmd->kind = NOR_CMD_PROGRAM;
+        cmd->addr_bytes = addr_bytes;
+        return true;
+    case 0x5AU:
+        cmd->kind = NOR_CMD_SFDP;
+        cmd->addr_bytes = 3U;
+        cmd->dummy = NOR_SIM_FAST_READ_DUMMY;
+        return true;
+    case 0x9FU:
+        cmd->kind = NOR_CMD_JEDEC_ID;
+        return true;
+    case 0x05U:
+        cmd->kind = NOR_CMD_RDSR1;
+        return true;
+    case 0x35U:
+        cmd->kind = NOR_CMD_RDSR2;
+        return true;
+    case 0x06U:
+        cmd->kind = NOR_CMD_WREN;
+        return true;
+    case 0x04U:
+        cmd->kind = NOR_CMD_WRDI;
+        return true;
+    case 0x01U:
+        cmd->kind = NOR_CMD_WRSR;
+        return true;
+    case 0x31U:
+        cmd->kind = NOR_CMD_WRSR2;
+        return true;
+    case 0x60U: case 0xC7U:
+        cmd->kind = NOR_CMD_CHIP_ERASE;
+        return true;
+    default:
+        break;
+    }
+
+    if ((0U != p->read_114_cmd) &&
+        ((opcode == p->read_114_cmd) || (p->addr_4b && (opcode == 0x6CU))))
+    {
+        cmd->kind = NOR_CMD_READ;
+        cmd->addr_bytes = (opcode == p->read_114_cmd) ? 3U : 4U;
+        cmd->dummy = p->read_114_dummy;
+        cmd->data_lines = 4U;
+        return true;
+    }
+
+    if ((0U != p->read_144_cmd) &&
+        ((opcode == p->read_144_cmd) || (p->addr_4b && (opcode == 0xECU))))
+    {
+        cmd->kind = NOR_CMD_READ;
+        cmd->addr_bytes = (opcode == p->read_144_cmd) ? 3U : 4U;
+        cmd->addr_lines = 4U;
+        cmd->mode_bytes = (uint8_t)((p->read_144_mode * 4U) / 8U);
+        cmd->dummy = p->read_144_dummy;
+        cmd->data_lines = 4U;
+        return true;
+    }
+
+    if (p->program_114 && ((opcode == 0x32U) || (p->addr_4b && (opcode == 0x34U))))
+    {
+        cmd->kind = NOR_CMD_PROGRAM;
+        cmd->addr_bytes = (opcode == 0x32U) ? 3U : 4U;
+        cmd->data_lines = 4U;
+        return true;
+    }
+
+    for (uint32_t i = 0U; i < NOR_SIM_ERASE_TYPE_NUM; i++)
+    {
+        const nor_sim_erase_t *erase = &p->erase[i];
+
+        if ((0U != erase->size) &&
+            ((opcode == erase->cmd) || (p->addr_4b && (opcode == erase->cmd_4b))))
+        {
+            cmd->kind = NOR_CMD_ERASE;
+            cmd->addr_bytes = (opcode == erase->cmd) ? 3U : 4U;
+            cmd->erase_size = erase->size;
+            cmd->erase_us = erase->typ_us;
+            return true;
+        }
+    }
+
+    if (opcode == p->suspend_cmd)
+    {
+        cmd->kind = NOR_CMD_SUSPEND;
+        return true;
+    }
+    if (opcode == p->resume_cmd)
+    {
+        cmd->kind = NOR_CMD_RESUME;
+        return true;
+    }
+
+    return false;
+}
+
+static bool nor_sim_uses_quad(const nor_cmd_t *cmd)
+{
+    return (cmd->addr_lines == 4U) || (cmd->data_lines == 4U);
+}
+
+/* Whether the part can sample and drive at the current clock and RX sampling */
+static int nor_sim_sample_offset(void)
+{
+    uint32_t period = (0U != nor_spi_hz) ? (1000000000UL / nor_spi_hz) : 0U;
+    uint32_t valid = nor_part->t_v_ns + NOR_SIM_BOARD_DELAY_NS;
+    uint32_t hold = period + nor_part->t_ho_ns + NOR_SIM_BOARD_DELAY_NS;
+
+    if ((nor_spi_hz > nor_part->max_spi_hz) || (nor_sample_ns < valid))
+    {
+        return -1;
+    }
+
+    return (nor_sample_ns > hold) ? 1 : 0;
+}
+
+/* Shifts the data by one bit, as sampled one bit early or late */
+static void nor_sim_shift(uint8_t *data, uint32_t len, int offset)
+{
+    if (offset < 0)
+    {
+        for (uint32_t i = len; i > 0U; i--)
+        {
+            uint8_t prev = (i > 1U) ? data[i - 2U] : 0xFFU;
+
+            data[i - 1U] = (uint8_t)((data[i - 1U] >> 1) | (prev << 7));
+        }
+    }
+    else if (offset > 0)
+    {
+        for (uint32_t i = 0U; i < len; i++)
+        {
+            uint8_t next = ((i + 1U) < len) ? data[i + 1U] : 0xFFU;
+
+            data[i] = (uint8_t)((data[i] << 1) | (next >> 7));
+        }
+    }
+}
+
+void nor_sim_connect(uint32_t chip, bool connected)
+{
+    if (chip < NOR_SIM_CHIP_NUM_MAX)
+    {
+        nor_chips[chip].connected = connected;
+    }
+}
+
+void nor_sim_set_bus(bool connected)
+{
+    nor_bus_connected = connected;
+}
+
+void nor_sim_set_clock(uint32_t spi_hz, uint32_t sample_ns)
+{
+    nor_spi_hz = spi_hz;
+    nor_sample_ns = sample_ns;
+}
+
+void nor_sim_select(uint32_t chip)
+{
+    if (nor_txn.active)
+    {
+        nor_sim_violation("chip select %u while chip %u is selected", chip, nor_txn.chip);
+        nor_sim_deselect();
+    }
+
+    if (0U == nor_spi_hz)
+    {
+        nor_sim_violation("transfer without the SMIF clock");
+    }
+    if (!nor_bus_connected)
+    {
+        nor_sim_violation("transfer with the SMIF pins not connected");
+    }
+
+    (void)memset(&nor_txn, 0, sizeof(nor_txn));
+    nor_txn.active = true;
+    nor_txn.chip = chip;
+    nor_txn.ignore = (chip >= nor_chip_count) || (!nor_chips[chip].connected) ||
+                     (!nor_bus_connected);
+
+    nor_sim_cycles(NOR_SIM_CS_CYCLES);
+}
+
+/* Checks the opcode against the state of the part */
+static void nor_sim_accept_opcode(uint8_t opcode, uint32_t lines)
+{
+    uint32_t index = nor_txn.chip;
+    nor_chip_t *chip = &nor_chips[index];
+
+    nor_txn.opcode_seen = true;
+    nor_txn.opcode = opcode;
+    nor_stats.commands++;
+
+    if (nor_txn.ignore)
+    {
+        return;
+    }
+
+    if (lines != 1U)
+    {
+        nor_sim_violation("opcode 0x%02X sent on %u lines, the part has no QPI mode", opcode, lines);
+        nor_txn.ignore = true;
+        return;
+    }
+
+    if (!nor_sim_decode(opcode, &nor_txn.cmd))
+    {
+        nor_sim_violation("opcode 0x%02X not supported by %s", opcode, nor_part->name);
+        nor_txn.ignore = true;
+        return;
+    }
+
+    if (nor_sim_uses_quad(&nor_txn.cmd) && (0U == (chip->sr2 & NOR_SIM_SR2_QE)))
+    {
+        nor_sim_violation("quad opcode 0x%02X on chip %u with the QE bit clear", opcode, index);
+        nor_txn.ignore = true;
+        return;
+    }
+
+    if (nor_sim_busy(index))
+    {
+        switch (nor_txn.cmd.kind)
+        {
+        case NOR_CMD_RDSR1:
+        case NOR_CMD_RDSR2:
+        case NOR_CMD_SUSPEND:
+            break;
+        default:
+            nor_sim_violation("opcode 0x%02X to chip %u while it is busy", opcode, index);
+            nor_txn.ignore = true;
+            break;
+        }
+    }
+    else if (chip->suspended)
+    {
+        switch (nor_txn.cmd.kind)
+        {
+        case NOR_CMD_PROGRAM:
+        case NOR_CMD_ERASE:
+        case NOR_CMD_CHIP_ERASE:
+        case NOR_CMD_WRSR:
+        case NOR_CMD_WRSR2:
+            nor_sim_violation("opcode 0x%02X to chip %u with a suspended erase", opcode, index);
+            nor_txn.ignore = true;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void nor_sim_write(const uint8_t *data, uint32_t len, uint32_t lines)
+{
+    nor_chip_t *chip = &nor_chips[nor_txn.chip];
+
+    nor_sim_cycles(nor_sim_bytes_cycles(len, lines));
+
+    if (!nor_txn.active)
+    {
+        nor_sim_violation("transfer without a chip select");
+        return;
+    }
+
+    for (uint32_t i = 0U; i < len; i++)
+    {
+        uint32_t params;
+
+        if (!nor_txn.opcode_seen)
+        {
+            nor_sim_accept_opcode(data[i], lines);
+            continue;
+        }
+        if (nor_txn.ignore)
+        {
+            continue;
+        }
+
+        params = (uint32_t)nor_txn.cmd.addr_bytes + nor_txn.cmd.mode_bytes;
+        if (nor_txn.param_len < params)
+        {
+            if (lines != nor_txn.cmd.addr_lines)
+            {
+                nor_sim_violation("address of opcode 0x%02X sent on %u lines, expects %u",
+                                  nor_txn.opcode, lines, nor_txn.cmd.addr_lines);
+                nor_txn.garbled = true;
+            }
+            nor_txn.param[nor_txn.param_len++] = data[i];
+            if (nor_txn.param_len == nor_txn.cmd.addr_bytes)
+            {
+                nor_txn.addr = 0U;
+                for (uint32_t b = 0U; b < nor_txn.cmd.addr_bytes; b++)
+                {
+                    nor_txn.addr = (nor_txn.addr << 8) | nor_txn.param[b];
+                }
+                nor_txn.addr %= nor_part->flash_size;
+            }
+            continue;
+        }
+
+        if (lines != nor_txn.cmd.data_lines)
+        {
+            nor_sim_violation("data of opcode 0x%02X sent on %u lines, expects %u",
+                              nor_txn.opcode, lines, nor_txn.cmd.data_lines);
+            nor_txn.garbled = true;
+        }
+
+        switch (nor_txn.cmd.kind)
+        {
+        case NOR_CMD_PROGRAM:
+            if (0U == nor_txn.data_len)
+            {
+                (void)memset(chip->page, 0xFF, sizeof(chip->page));
+            }
+            /* The address wraps within the page */
+            chip->page[(nor_txn.addr + nor_txn.data_len) % nor_part->page_size] = data[i];
+            break;
+        case NOR_CMD_WRSR:
+        case NOR_CMD_WRSR2:
+            if (nor_txn.data_len < NOR_SIM_WRSR_MAX)
+            {
+                chip->wrsr[nor_txn.data_len] = data[i];
+            }
+            break;
+        default:
+            nor_sim_violation("data written to opcode 0x%02X", nor_txn.opcode);
+            break;
+        }
+        nor_txn.data_len++;
+    }
+}
+
+void nor_sim_dummy(uint32_t cycles)
+{
+    nor_sim_cycles(cycles);
+    nor_txn.dummy += cycles;
+}
+
+/* Data of a read command, before the sampling */
+static void nor_sim_read_data(uint8_t *data, uint32_t len)
+{
+    uint32_t index = nor_txn.chip;
+    nor_chip_t *chip = &nor_chips[index];
+    const uint8_t *mem = nor_sim_chip_mem(index);
+    uint32_t pos = nor_txn.data_len;
+
+    for (uint32_t i = 0U; i < len; i++, pos++)
+    {
+        switch (nor_txn.cmd.kind)
+        {
+        case NOR_CMD_READ:
+        {
+            uint32_t addr = (nor_txn.addr + pos) % nor_part->flash_size;
+
+            if (chip->suspended && (chip->busy == NOR_BUSY_ERASE) &&
+                (addr >= chip->busy_addr) && (addr < (chip->busy_addr + chip->busy_len)))
+            {
+                if (0U == i)
+                {
+                    nor_sim_violation("read of chip %u at 0x%X in the suspended erase", index, addr);
+                }
+                data[i] = 0xFFU;
+            }
+            else
+            {
+                data[i] = mem[addr];
+            }
+            break;
+        }
+        case NOR_CMD_SFDP:
+            data[i] = ((nor_txn.addr + pos) < nor_part->sfdp_size) ?
+                      nor_part->sfdp[nor_txn.addr + pos] : 0xFFU;
+            break;
+        case NOR_CMD_JEDEC_ID:
+            data[i] = (pos < 3U) ? nor_part->jedec_id[pos] : 0x00U;
+            break;
+        case NOR_CMD_RDSR1:
+            data[i] = chip->sr1 | (nor_sim_busy(index) ? NOR_SIM_SR1_WIP : 0U);
+            nor_stats.status_reads++;
+            break;
+        case NOR_CMD_RDSR2:
+            data[i] = chip->sr2 | (chip->suspended ? NOR_SIM_SR2_SUS : 0U);
+            nor_stats.status_reads++;
+            break;
+        default:
+            if (0U == i)
+            {
+                nor_sim_violation("data read from opcode 0x%02X", nor_txn.opcode);
+            }
+            data[i] = 0xFFU;
+            break;
+        }
+    }
+}
+
+void nor_sim_read(uint8_t *data, uint32_t len, uint32_t lines)
+{
+    int offset;
+
+    nor_sim_cycles(nor_sim_bytes_cycles(len, lines));
+    (void)memset(data, 0xFF, len);
+
+    if (!nor_txn.active)
+    {
+        nor_sim_violation("transfer without a chip select");
+        return;
+    }
+    if (nor_txn.ignore || (!nor_txn.opcode_seen))
+    {
+        return;
+    }
+
+    if (0U == nor_txn.data_len)
+    {
+        if (nor_txn.param_len < ((uint32_t)nor_txn.cmd.addr_bytes + nor_txn.cmd.mode_bytes))
+        {
+            nor_sim_violation("opcode 0x%02X read with %u of %u address bytes", nor_txn.opcode,
+                              nor_txn.param_len, nor_txn.cmd.addr_bytes + nor_txn.cmd.mode_bytes);
+            nor_txn.garbled = true;
+        }
+        if (nor_txn.dummy != nor_txn.cmd.dummy)
+        {
+            nor_sim_violation("opcode 0x%02X read with %u dummy cycles, expects %u",
+                              nor_txn.opcode, nor_txn.dummy, nor_txn.cmd.dummy);
+            nor_txn.garbled = true;
+        }
+        if ((lines != nor_txn.cmd.data_lines))
+        {
+            nor_sim_violation("data of opcode 0x%02X read on %u lines, expects %u",
+                              nor_txn.opcode, lines, nor_txn.cmd.data_lines);
+            nor_txn.garbled = true;
+        }
+    }
+
+    if ((0U == nor_txn.data_len) && (nor_txn.cmd.kind == NOR_CMD_SFDP))
+    {
+        nor_stats.sfdp_reads++;
+    }
+
+    nor_sim_read_data(data, len);
+    nor_txn.data_len += len;
+    if (nor_txn.cmd.kind == NOR_CMD_READ)
+    {
+        nor_stats.read_bytes += len;
+    }
+
+    offset = nor_sim_sample_offset();
+    if (nor_txn.garbled && (0 == offset))
+    {
+        offset = 1;
+    }
+    nor_sim_shift(data, len, offset);
+}
+
+/* Program, erase and status writes need the write enable latch */
+static bool nor_sim_write_enabled(nor_chip_t *chip)
+{
+    if (0U == (chip->sr1 & NOR_SIM_SR1_WEL))
+    {
+        nor_sim_violation("opcode 0x%02X to chip %u without write enable", nor_txn.opcode, nor_txn.chip);
+        return false;
+    }
+
+    return true;
+}
+
+/* Runs the command at the end of the transaction */
+static void nor_sim_execute(void)
+{
+    uint32_t index = nor_txn.chip;
+    nor_chip_t *chip = &nor_chips[index];
+
+    switch (nor_txn.cmd.kind)
+    {
+    case NOR_CMD_WREN:
+        chip->sr1 |= NOR_SIM_SR1_WEL;
+        break;
+    case NOR_CMD_WRDI:
+        chip->sr1 &= (uint8_t)~NOR_SIM_SR1_WEL;
+        break;
+    case NOR_CMD_PROGRAM:
+        if ((0U != nor_txn.data_len) && nor_sim_write_enabled(chip))
+        {
+            chip->busy_addr = nor_txn.addr - (nor_txn.addr % nor_part->page_size);
+            chip->busy_len = nor_part->page_size;
+            nor_sim_start_busy(chip, NOR_BUSY_PROGRAM, nor_part->program_us);
+            nor_stats.program_pages++;
+            nor_stats.program_bytes += nor_txn.data_len;
+        }
+        break;
+    case NOR_CMD_ERASE:
+        if (nor_sim_write_enabled(chip))
+        {
+            chip->busy_addr = nor_txn.addr - (nor_txn.addr % nor_txn.cmd.erase_size);
+            chip->busy_len = nor_txn.cmd.erase_size;
+            nor_sim_start_busy(chip, NOR_BUSY_ERASE, nor_txn.cmd.erase_us);
+            nor_stats.erases++;
+            nor_stats.erase_bytes += nor_txn.cmd.erase_size;
+        }
+        break;
+    case NOR_CMD_CHIP_ERASE:
+        if (nor_sim_write_enabled(chip))
+        {
+            chip->busy_addr = 0U;
+            chip->busy_len = nor_part->flash_size;
+            nor_sim_start_busy(chip, NOR_BUSY_ERASE, nor_part->chip_erase_us);
+            nor_stats.erases++;
+            nor_stats.erase_bytes += nor_part->flash_size;
+        }
+        break;
+    case NOR_CMD_WRSR:
+    case NOR_CMD_WRSR2:
+        if ((0U != nor_txn.data_len) && nor_sim_write_enabled(chip))
+        {
+            chip->wrsr_len = nor_txn.data_len;
+            chip->wrsr_sr2_only = (nor_txn.cmd.kind == NOR_CMD_WRSR2);
+            nor_sim_start_busy(chip, NOR_BUSY_WRSR, nor_part->wrsr_us);
+        }
+        break;
+    case NOR_CMD_SUSPEND:
+        if ((chip->busy != NOR_BUSY_NONE) && (!chip->suspended) && (!chip->suspend_pending))
+        {
+            if (chip->resumed &&
+                ((nor_time - chip->resume_time) < (nor_part->resume_interval_us * 1000ULL)))
+            {
+                nor_sim_violation("suspend of chip %u %llu us after the resume, needs %u us", index,
+                                  (unsigned long long)((nor_time - chip->resume_time) / 1000U),
+                                  nor_part->resume_interval_us);
+            }
+            chip->suspend_pending = true;
+            chip->suspend_at = nor_time + (nor_part->suspend_us * 1000ULL);
+            nor_stats.suspends++;
+        }
+        break;
+    case NOR_CMD_RESUME:
+        nor_sim_update(index);
+        if (chip->suspend_pending)
+        {
+            /* Resumed before the suspend took effect: the operation goes on */
+            chip->suspend_pending = false;
+        }
+        else if (chip->suspended)
+        {
+            chip->suspended = false;
+            chip->busy_end = nor_time + chip->remaining;
+        }
+        chip->resumed = true;
+        chip->resume_time = nor_time;
+        nor_stats.resumes++;
+        break;
+    default:
+        break;
+    }
+}
+
+void nor_sim_deselect(void)
+{
+    if (!nor_txn.active)
+    {
+        return;
+    }
+
+    if (nor_txn.opcode_seen && (!nor_txn.ignore) && (!nor_txn.garbled))
+    {
+        if ((nor_txn.param_len < nor_txn.cmd.addr_bytes) &&
+            ((nor_txn.cmd.kind == NOR_CMD_PROGRAM) || (nor_txn.cmd.kind == NOR_CMD_ERASE)))
+        {
+            nor_sim_violation("opcode 0x%02X with %u of %u address bytes", nor_txn.opcode,
+                              nor_txn.param_len, nor_txn.cmd.addr_bytes);
+        }
+        else
+        {
+            nor_sim_execute();
+        }
+    }
+
+    nor_txn.active = false;
+    nor_sim_cycles(NOR_SIM_CS_CYCLES);
+}
+
+bool nor_sim_xip_map(uint32_t chip, uint32_t offset, const nor_sim_xip_cmd_t *cmd)
+{
+    nor_cmd_t dec;
+
+    if (NULL == cmd)
+    {
+        for (uint32_t i = 0U; i < NOR_SIM_CHIP_NUM_MAX; i++)
+        {
+            nor_chips[i].xip_mapped = false;
+        }
+        return true;
+    }
+
+    if ((chip >= NOR_SIM_CHIP_NUM_MAX) || (offset != (chip * nor_part->flash_size)) ||
+        ((offset + (size_t)nor_part->flash_size) > nor_xip_size))
+    {
+        nor_sim_violation("chip %u mapped at XIP offset 0x%X, the contents are at 0x%X",
+                          chip, offset, chip * nor_part->flash_size);
+        return false;
+    }
+
+    if ((!nor_sim_decode(cmd->cmd, &dec)) || (dec.kind != NOR_CMD_READ) ||
+        (dec.addr_bytes != cmd->addr_bytes) || (dec.addr_lines != cmd->addr_lines) ||
+        (dec.mode_bytes != cmd->mode_bytes) || (dec.dummy != cmd->dummy_cycles) ||
+        (dec.data_lines != cmd->data_lines))
+    {
+        nor_sim_violation("XIP read opcode 0x%02X of chip %u does not match the part", cmd->cmd, chip);
+        return false;
+    }
+
+    nor_chips[chip].xip = *cmd;
+    nor_chips[chip].xip_mapped = true;
+
+    return true;
+}
+
+void nor_sim_xip_invalidate(void)
+{
+    if (NULL != nor_xip_base)
+    {
+        (void)mprotect(nor_xip_base, nor_xip_size, PROT_NONE);
+    }
+}
+
+void nor_sim_xip_mode(bool memory_mode)
+{
+    nor_xip_memory_mode = memory_mode;
+    nor_sim_xip_invalidate();
+}
+
+/* First read of an XIP page since the last invalidation: the SMIF fetches it */
+static void nor_sim_xip_fault(int sig, siginfo_t *info, void *ucontext)
+{
+    uint8_t *addr = (uint8_t *)info->si_addr;
+    uint8_t *page;
+    size_t offset;
+    uint32_t index;
+
+    (void)ucontext;
+
+    if ((NULL == nor_xip_base) || (addr < nor_xip_base) || (addr >= (nor_xip_base + nor_xip_size)))
+    {
+        /* Not ours: a real fault */
+        (void)sigaction(sig, &nor_prev_segv, NULL);
+        return;
+    }
+
+    offset = (size_t)(addr - nor_xip_base);
+    page = nor_xip_base + (offset & ~(NOR_SIM_XIP_PAGE - 1U));
+    index = (uint32_t)(offset / nor_part->flash_size);
+
+    if (!nor_xip_memory_mode)
+    {
+        nor_sim_violation("XIP read at 0x%zX in normal mode", offset);
+    }
+    else if (index >= nor_chip_count)
+    {
+        nor_sim_violation("XIP read at 0x%zX beyond the memory", offset);
+    }
+    else
+    {
+        nor_chip_t *chip = &nor_chips[index];
+        const nor_sim_xip_cmd_t *cmd = &chip->xip;
+
+        if (!chip->xip_mapped)
+        {
+            nor_sim_violation("XIP read at 0x%zX of a chip not mapped", offset);
+        }
+        else
+        {
+            if (nor_sim_busy(index))
+            {
+                nor_sim_violation("XIP read at 0x%zX while chip %u is busy", offset, index);
+            }
+            if (((cmd->addr_lines == 4U) || (cmd->data_lines == 4U)) &&
+                (0U == (chip->sr2 & NOR_SIM_SR2_QE)))
+            {
+                nor_sim_violation("quad XIP read of chip %u with the QE bit clear", index);
+            }
+
+            nor_sim_cycles(NOR_SIM_CS_CYCLES * 2U + 8U +
+                           nor_sim_bytes_cycles((uint32_t)cmd->addr_bytes + cmd->mode_bytes, cmd->addr_lines) +
+                           cmd->dummy_cycles + nor_sim_bytes_cycles(NOR_SIM_XIP_PAGE, cmd->data_lines));
+            nor_stats.xip_pages++;
+            nor_stats.read_bytes += NOR_SIM_XIP_PAGE;
+        }
+    }
+
+    if (0 != mprotect(page, NOR_SIM_XIP_PAGE, PROT_READ))
+    {
+        (void)sigaction(sig, &nor_prev_segv, NULL);
+    }
+}
+
+bool nor_sim_open(const nor_sim_part_t *part, uint32_t chips, const char *path,
+                  bool erase, uintptr_t xip_base, uint32_t xip_size)
+{
+    struct sigaction sa;
+    struct stat st;
+    size_t size = (size_t)part->flash_size * chips;
+    size_t map_size = (size + NOR_SIM_XIP_PAGE - 1U) & ~(NOR_SIM_XIP_PAGE - 1U);
+    void *mem;
+
+    if ((0U == chips) || (chips > NOR_SIM_CHIP_NUM_MAX) || (part->page_size > NOR_SIM_PAGE_MAX))
+    {
+        fprintf(stderr, "nor_sim: %u x %s not supported\n", chips, part->name);
+        return false;
+    }
+
+    /* Chips beyond the window are only reachable with commands */
+    if (map_size > xip_size)
+    {
+        map_size = xip_size;
+    }
+
+    nor_fd = open(path, O_RDWR | O_CREAT, 0644);
+    if ((nor_fd < 0) || (0 != fstat(nor_fd, &st)))
+    {
+        perror(path);
+        return false;
+    }
+
+    if ((size_t)st.st_size != size)
+    {
+        erase = true;
+        if (0 != ftruncate(nor_fd, (off_t)size))
+        {
+            perror(path);
+            return false;
+        }
+    }
+
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, nor_fd, 0);
+    if (mem == MAP_FAILED)
+    {
+        perror("nor_sim: contents");
+        return false;
+    }
+    nor_mem = (uint8_t *)mem;
+    nor_mem_size = size;
+    if (erase)
+    {
+        (void)memset(nor_mem, 0xFF, size);
+    }
+
+    /* The whole window is reserved, the chips are mapped at its start */
+    mem = mmap((void *)xip_base, xip_size, PROT_NONE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+    if ((mem == MAP_FAILED) || (mem != (void *)xip_base) ||
+        (mmap((void *)xip_base, map_size, PROT_NONE, MAP_SHARED | MAP_FIXED, nor_fd, 0) != (void *)xip_base))
+    {
+        perror("nor_sim: XIP window");
+        return false;
+    }
+    nor_xip_base = (uint8_t *)xip_base;
+    nor_xip_size = xip_size;
+
+    (void)memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = nor_sim_xip_fault;
+    sa.sa_flags = SA_SIGINFO;
+    (void)sigemptyset(&sa.sa_mask);
+    (void)sigaction(SIGSEGV, &sa, &nor_prev_segv);
+
+    nor_part = part;
+    nor_chip_count = chips;
+    (void)memset(nor_chips, 0, sizeof(nor_chips));
+    (void)memset(&nor_txn, 0, sizeof(nor_txn));
+    nor_sim_reset_stats();
+
+    return true;
+}
+
+void nor_sim_close(void)
+{
+    if (NULL != nor_xip_base)
+    {
+        (void)sigaction(SIGSEGV, &nor_prev_segv, NULL);
+        (void)munmap(nor_xip_base, nor_xip_size);
+        nor_xip_base = NULL;
+    }
+    if (NULL != nor_mem)
+    {
+        (void)msync(nor_mem, nor_mem_size, MS_SYNC);
+        (void)munmap(nor_mem, nor_mem_size);
+        nor_mem = NULL;
+    }
+    if (nor_fd >= 0)
+    {
+        (void)close(nor_fd);
+        nor_fd = -1;
+    }
+}
+
+/* [] END OF FILE */
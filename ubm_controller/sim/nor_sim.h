@@ -0,0 +1,158 @@
+/******************************************************************************
+* File Name:   nor_sim.h
+*
+* Description: Host model of the SPI NOR parts behind the SMIF, for running
+*              flash_qspi.c on Linux (see pdl_sim.c and qspi_sim.c).
+*
+*              The parts are those of flashDict in flashmap.py, with the SFDP
+*              tables and timing written by sfdp_gen.py (nor_sim_parts.c).
+*              A part decodes the commands sent to it on the bus: reads (1-1-1,
+*              1-1-4, 1-4-4, 3- and 4-byte address), page program, sector and
+*              chip erase, status registers with the QE bit, JEDEC ID, SFDP,
+*              and erase suspend/resume. Program, erase and status register
+*              writes keep the part busy for their typical time.
+*
+*              Time is simulated: bus transfers advance it by their length at
+*              the SPI clock, and waits by their duration. A read sampled
+*              outside the data valid window of the part (clock to output
+*              time, hold time, board delay) returns shifted data.
+*
+*              The contents of all chips are a memory-mapped file, which is
+*              also mapped as the XIP window. Reads through the window are
+*              charged per 4 KB page touched since the last cache
+*              invalidation.
+*
+*              Misuse of a part (a command while busy, a quad transfer with
+*              the QE bit clear, a write without write enable, a suspend too
+*              soon after a resume, an XIP read in normal mode...) is counted
+*              as a violation and reported.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(NOR_SIM_H)
+#define NOR_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define NOR_SIM_CHIP_NUM_MAX                (4U)
+#define NOR_SIM_ERASE_TYPE_NUM              (4U)
+
+/* Round trip delay of the board, SCK out to data in */
+#ifndef NOR_SIM_BOARD_DELAY_NS
+#define NOR_SIM_BOARD_DELAY_NS              (4U)
+#endif
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef struct
+{
+    uint32_t size;                      /* 0 if the type is not supported */
+    uint8_t cmd;
+    uint8_t cmd_4b;
+    uint32_t typ_us;
+} nor_sim_erase_t;
+
+/* A part, see sfdp_gen.py */
+typedef struct
+{
+    const char *name;
+    uint32_t flash_size;                /* From flashDict */
+    uint32_t erase_size;                /* From flashDict */
+    uint8_t jedec_id[3];
+    uint32_t page_size;
+    uint32_t program_us;
+    uint32_t wrsr_us;
+    uint32_t chip_erase_us;
+    nor_sim_erase_t erase[NOR_SIM_ERASE_TYPE_NUM];
+    uint8_t read_114_cmd;               /* 0 if not supported */
+    uint8_t read_114_dummy;
+    uint8_t read_144_cmd;               /* 0 if not supported */
+    uint8_t read_144_mode;              /* Mode clocks */
+    uint8_t read_144_dummy;
+    bool program_114;
+    bool addr_4b;                       /* 4-byte address opcodes */
+    uint8_t suspend_cmd;
+    uint8_t resume_cmd;
+    uint32_t suspend_us;
+    uint32_t resume_interval_us;
+    uint32_t max_spi_hz;
+    uint32_t t_v_ns;                    /* Clock low to output valid */
+    uint32_t t_ho_ns;                   /* Output hold */
+    const uint8_t *sfdp;
+    uint32_t sfdp_size;
+} nor_sim_part_t;
+
+/* Read command used for the XIP window, as programmed into the SMIF */
+typedef struct
+{
+    uint8_t cmd;
+    uint8_t addr_bytes;
+    uint8_t addr_lines;
+    uint8_t mode_bytes;                 /* Sent on the address lines */
+    uint8_t dummy_cycles;
+    uint8_t data_lines;
+} nor_sim_xip_cmd_t;
+
+typedef struct
+{
+    uint64_t commands;
+    uint64_t read_bytes;
+    uint64_t program_pages;
+    uint64_t program_bytes;
+    uint64_t erases;
+    uint64_t erase_bytes;
+    uint64_t status_reads;
+    uint64_t sfdp_reads;
+    uint64_t suspends;
+    uint64_t resumes;
+    uint64_t xip_pages;
+    uint64_t busy_ns;                   /* Program, erase and WRSR time */
+    uint64_t violations;
+} nor_sim_stats_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+extern const nor_sim_part_t nor_sim_parts[];
+extern const uint32_t nor_sim_part_count;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+const nor_sim_part_t *nor_sim_find_part(const char *name);
+bool nor_sim_open(const nor_sim_part_t *part, uint32_t chips, const char *path,
+                  bool erase, uintptr_t xip_base, uint32_t xip_size);
+void nor_sim_close(void);
+uint8_t *nor_sim_contents(void);
+
+uint64_t nor_sim_time_ns(void);
+void nor_sim_wait_ns(uint64_t ns);
+
+void nor_sim_connect(uint32_t chip, bool connected);
+void nor_sim_set_bus(bool connected);
+void nor_sim_set_clock(uint32_t spi_hz, uint32_t sample_ns);
+void nor_sim_select(uint32_t chip);
+void nor_sim_write(const uint8_t *data, uint32_t len, uint32_t lines);
+void nor_sim_dummy(uint32_t cycles);
+void nor_sim_read(uint8_t *data, uint32_t len, uint32_t lines);
+void nor_sim_deselect(void);
+
+/* A NULL cmd unmaps all chips */
+bool nor_sim_xip_map(uint32_t chip, uint32_t offset, const nor_sim_xip_cmd_t *cmd);
+void nor_sim_xip_mode(bool memory_mode);
+void nor_sim_xip_invalidate(void);
+
+void nor_sim_violation(const char *fmt, ...);
+const nor_sim_stats_t *nor_sim_stats(void);
+void nor_sim_reset_stats(void);
+
+#endif /* NOR_SIM_H */
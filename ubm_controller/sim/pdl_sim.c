@@ -0,0 +1,1232 @@
+/******************************************************************************
+* File Name:   pdl_sim.c
+*
+* Description: Host implementation of the PDL calls of flash_qspi.c and of
+*              the SMIF memory slot functions of the MCUboot flash PAL, on
+*              top of the NOR model of nor_sim.c.
+*
+*              SMIF: the transfer functions drive the bus of nor_sim.c with
+*              the slave select, widths and dummy cycles they are given. The
+*              memory slot layer (Cy_SMIF_Mem*) builds its commands from the
+*              device configuration as the PDL does, and the SFDP detection
+*              of Cy_SMIF_MemInit() reads and decodes the tables of the part
+*              over the bus. Memory mode maps the chips at the XIP addresses
+*              of their memory configuration.
+*
+*              Clocks: the SPI clock is half of clk_hf[2], which is clk_path0
+*              (pdl_sim_set_path_hz()) divided. The RX sampling point of each
+*              SMIF_CTL.CLOCK_IF_RX_SEL setting is derived from it: the
+*              internal clock samples half a period after the launching edge,
+*              the inverted clocks a full period, the output and feedback
+*              clocks later by the pad (and board) delay.
+*
+*              GPIO: a chip answers when its slave select pin is routed to the
+*              SMIF (HSIOM), the bus works when the clock and data pins are.
+*
+*              Time: every PDL call costs PDL_SIM_CALL_CYCLES CPU cycles and
+*              every DWT access PDL_SIM_DWT_CYCLES, delays wait, and bus
+*              transfers take their time in nor_sim.c. DWT->CYCCNT counts the
+*              simulated time at SystemCoreClock while it is enabled.
+*
+*              Flash: the row functions write the host memory of the row, as
+*              the internal flash driver does, and take the row write time.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "cy_pdl.h"
+#include "nor_sim.h"
+#include "pdl_sim.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define PDL_SIM_CORE_HZ                     (144000000UL)
+#define PDL_SIM_CALL_CYCLES                 (100U)
+#define PDL_SIM_DWT_CYCLES                  (8U)
+
+/* Output pad delay of SCK, seen by the output and feedback RX clocks */
+#define PDL_SIM_PAD_DELAY_NS                (3U)
+
+/* Row write (erase and program) time of the internal flash */
+#define PDL_SIM_FLASH_ROW_WRITE_US          (16000U)
+#define PDL_SIM_FLASH_ROW_HALF_US           (8000U)
+
+/* HSIOM value of the SMIF pins, see en_hsiom_sel_t */
+#define PDL_SIM_HSIOM_SMIF                  (26U)
+
+#define PDL_SIM_MAX_RX_COUNT                (65536UL)
+#define PDL_SIM_SFDP_HEADER_NUM_MAX         (4U)
+#define PDL_SIM_BFPT_DWORDS                 (16U)
+#define PDL_SIM_BFPT_DWORDS_MIN             (11U)
+#define PDL_SIM_SFDP_ID_BFPT                (0xFF00U)
+#define PDL_SIM_SFDP_ID_4BAIT               (0xFF84U)
+#define PDL_SIM_3B_SIZE_MAX                 (0x1000000UL)
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+SMIF_Type pdl_sim_smif0;
+GPIO_PRT_Type pdl_sim_gpio[PDL_SIM_GPIO_PORT_NUM];
+CoreDebug_Type pdl_sim_core_debug;
+uint32_t SystemCoreClock = PDL_SIM_CORE_HZ;
+
+static DWT_Type pdl_sim_dwt_regs;
+
+static uint32_t pdl_sim_path_hz = PDL_SIM_PATH_HZ_DEFAULT;
+static bool pdl_sim_hf2_enabled;
+static cy_en_clkhf_dividers_t pdl_sim_hf2_div;
+static bool pdl_sim_smif_enabled;
+static cy_en_smif_mode_t pdl_sim_smif_mode;
+static bool pdl_sim_selected;
+
+/* Slave select pins, SS0 to SS3 */
+static const struct
+{
+    uint32_t port;
+    uint32_t pin;
+} pdl_sim_ss_pins[SMIF_CHIP_TOP_SPI_SEL_NR] =
+{
+    { 11U, 2U }, { 11U, 1U }, { 11U, 0U }, { 12U, 4U }
+};
+
+/* 4-byte address opcodes of the 3-byte ones */
+static const uint8_t pdl_sim_opcode_4b[][2] =
+{
+    { 0x03U, 0x13U }, { 0x0BU, 0x0CU }, { 0x6BU, 0x6CU }, { 0xEBU, 0xECU },
+    { 0x02U, 0x12U }, { 0x32U, 0x34U }
+};
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void pdl_sim_apply_clock(void);
+
+void pdl_sim_set_path_hz(uint32_t hz)
+{
+    pdl_sim_path_hz = hz;
+    pdl_sim_apply_clock();
+}
+
+uint32_t pdl_sim_get_spi_hz(void)
+{
+    if ((!pdl_sim_hf2_enabled) || (!pdl_sim_smif_enabled))
+    {
+        return 0U;
+    }
+
+    return (pdl_sim_path_hz >> (uint32_t)pdl_sim_hf2_div) / 2U;
+}
+
+uint32_t pdl_sim_get_rx_clock_sel(void)
+{
+    return _FLD2VAL(SMIF_CTL_CLOCK_IF_RX_SEL, pdl_sim_smif0.CTL);
+}
+
+static void pdl_sim_cpu(uint32_t cycles)
+{
+    nor_sim_wait_ns(((uint64_t)cycles * 1000000000ULL) / SystemCoreClock);
+}
+
+/* Passes the SPI clock and the RX sampling point to the parts */
+static void pdl_sim_apply_clock(void)
+{
+    uint32_t spi_hz = pdl_sim_get_spi_hz();
+    uint32_t period = (0U != spi_hz) ? (1000000000UL / spi_hz) : 0U;
+    uint32_t sample;
+
+    switch (pdl_sim_get_rx_clock_sel())
+    {
+    case CY_SMIF_SEL_INTERNAL_CLK:
+        sample = period / 2U;
+        break;
+    case CY_SMIF_SEL_OUTPUT_CLK:
+        sample = (period / 2U) + PDL_SIM_PAD_DELAY_NS;
+        break;
+    case CY_SMIF_SEL_FEEDBACK_CLK:
+        sample = (period / 2U) + PDL_SIM_PAD_DELAY_NS + NOR_SIM_BOARD_DELAY_NS;
+        break;
+    case CY_SMIF_SEL_INV_INTERNAL_CLK:
+        sample = period;
+        break;
+    case CY_SMIF_SEL_INV_OUTPUT_CLK:
+        sample = period + PDL_SIM_PAD_DELAY_NS;
+        break;
+    default:
+        sample = period + PDL_SIM_PAD_DELAY_NS + NOR_SIM_BOARD_DELAY_NS;
+        break;
+    }
+
+    nor_sim_set_clock(spi_hz, sample);
+}
+
+DWT_Type *pdl_sim_dwt(void)
+{
+    pdl_sim_cpu(PDL_SIM_DWT_CYCLES);
+
+    if ((0U != (pdl_sim_dwt_regs.CTRL & DWT_CTRL_CYCCNTENA_Msk)) &&
+        (0U != (pdl_sim_core_debug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk)))
+    {
+        uint64_t ns = nor_sim_time_ns();
+        uint32_t per_us = SystemCoreClock / 1000000UL;
+
+        pdl_sim_dwt_regs.CYCCNT = (uint32_t)(((ns / 1000U) * per_us) + (((ns % 1000U) * per_us) / 1000U));
+    }
+
+    return &pdl_sim_dwt_regs;
+}
+
+/*******************************************************************************
+* GPIO
+********************************************************************************/
+/* Connects the bus and the chips whose pins are routed to the SMIF */
+static void pdl_sim_update_pins(void)
+{
+    const GPIO_PRT_Type *prt11 = &pdl_sim_gpio[11];
+    bool bus = true;
+
+    /* D3, D2, D1, D0 and SCK are P11_3 to P11_7 */
+    for (uint32_t pin = 3U; pin <= 7U; pin++)
+    {
+        bus = bus && (PDL_SIM_HSIOM_SMIF == prt11->hsiom[pin]);
+    }
+    nor_sim_set_bus(bus);
+
+    for (uint32_t ss = 0U; ss < SMIF_CHIP_TOP_SPI_SEL_NR; ss++)
+    {
+        nor_sim_connect(ss, PDL_SIM_HSIOM_SMIF ==
+                        pdl_sim_gpio[pdl_sim_ss_pins[ss].port].hsiom[pdl_sim_ss_pins[ss].pin]);
+    }
+}
+
+cy_en_gpio_status_t Cy_GPIO_Pin_Init(GPIO_PRT_Type *base, uint32_t pinNum,
+                                     const cy_stc_gpio_pin_config_t *config)
+{
+    if ((NULL == config) || (pinNum >= PDL_SIM_GPIO_PIN_NUM))
+    {
+        return CY_GPIO_BAD_PARAM;
+    }
+
+    base->hsiom[pinNum] = (uint32_t)config->hsiom;
+    base->drive_mode[pinNum] = config->driveMode;
+    pdl_sim_update_pins();
+
+    return CY_GPIO_SUCCESS;
+}
+
+void Cy_GPIO_SetHSIOM(GPIO_PRT_Type *base, uint32_t pinNum, en_hsiom_sel_t value)
+{
+    base->hsiom[pinNum] = (uint32_t)value;
+    pdl_sim_update_pins();
+}
+
+void Cy_GPIO_SetDrivemode(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value)
+{
+    base->drive_mode[pinNum] = value;
+}
+
+void Cy_GPIO_Port_Deinit(GPIO_PRT_Type *base)
+{
+    (void)memset(base->hsiom, 0, sizeof(base->hsiom));
+    (void)memset(base->drive_mode, 0, sizeof(base->drive_mode));
+    pdl_sim_update_pins();
+}
+
+/*******************************************************************************
+* SysClk, SysLib
+********************************************************************************/
+cy_en_sysclk_status_t Cy_SysClk_ClkHfSetSource(uint32_t clkHf, cy_en_clkhf_in_sources_t source)
+{
+    /* Only clk_hf[2] from clk_path0 is modelled */
+    return ((2U == clkHf) && (CY_SYSCLK_CLKHF_IN_CLKPATH0 == source)) ?
+           CY_SYSCLK_SUCCESS : CY_SYSCLK_BAD_PARAM;
+}
+
+cy_en_sysclk_status_t Cy_SysClk_ClkHfSetDivider(uint32_t clkHf, cy_en_clkhf_dividers_t divider)
+{
+    if ((2U != clkHf) || (divider > CY_SYSCLK_CLKHF_DIVIDE_BY_8))
+    {
+        return CY_SYSCLK_BAD_PARAM;
+    }
+
+    pdl_sim_hf2_div = divider;
+    pdl_sim_apply_clock();
+
+    return CY_SYSCLK_SUCCESS;
+}
+
+cy_en_sysclk_status_t Cy_SysClk_ClkHfEnable(uint32_t clkHf)
+{
+    if (2U != clkHf)
+    {
+        return CY_SYSCLK_BAD_PARAM;
+    }
+
+    pdl_sim_hf2_enabled = true;
+    pdl_sim_apply_clock();
+
+    return CY_SYSCLK_SUCCESS;
+}
+
+cy_en_sysclk_status_t Cy_SysClk_ClkHfDisable(uint32_t clkHf)
+{
+    if (2U != clkHf)
+    {
+        return CY_SYSCLK_BAD_PARAM;
+    }
+
+    pdl_sim_hf2_enabled = false;
+    pdl_sim_apply_clock();
+
+    return CY_SYSCLK_SUCCESS;
+}
+
+uint32_t Cy_SysClk_ClkPathGetFrequency(uint32_t clkPath)
+{
+    return (0U == clkPath) ? pdl_sim_path_hz : 0U;
+}
+
+void Cy_SysLib_Delay(uint32_t milliseconds)
+{
+    nor_sim_wait_ns((uint64_t)milliseconds * 1000000ULL);
+}
+
+void Cy_SysLib_DelayUs(uint16_t microseconds)
+{
+    nor_sim_wait_ns((uint64_t)microseconds * 1000ULL);
+}
+
+/*******************************************************************************
+* Flash
+********************************************************************************/
+/* Protection of the host mapping holding addr, from /proc/self/maps */
+static int pdl_sim_prot(uintptr_t addr)
+{
+    FILE *maps = fopen("/proc/self/maps", "r");
+    char line[256];
+    int prot = -1;
+
+    while ((NULL != maps) && (prot < 0) && (NULL != fgets(line, sizeof(line), maps)))
+    {
+        unsigned long start;
+        unsigned long end;
+        char perms[5];
+
+        if ((3 == sscanf(line, "%lx-%lx %4s", &start, &end, perms)) &&
+            (addr >= start) && (addr < end))
+        {
+            prot = ((perms[0] == 'r') ? PROT_READ : 0) | ((perms[1] == 'w') ? PROT_WRITE : 0) |
+                   ((perms[2] == 'x') ? PROT_EXEC : 0);
+        }
+    }
+
+    if (NULL != maps)
+    {
+        (void)fclose(maps);
+    }
+
+    return prot;
+}
+
+/* Writes a row of the internal flash, which is host memory here */
+static cy_en_flashdrv_status_t pdl_sim_flash_row(uint32_t rowAddr, const uint32_t *data, uint32_t us)
+{
+    uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t page = (uintptr_t)rowAddr & ~(page_size - 1U);
+    size_t len = (((uintptr_t)rowAddr + CY_FLASH_SIZEOF_ROW) - page + page_size - 1U) & ~(page_size - 1U);
+    int prot;
+
+    if ((rowAddr >= CY_XIP_BASE) && ((rowAddr - CY_XIP_BASE) < CY_XIP_SIZE))
+    {
+        nor_sim_violation("internal flash driver called on the XIP window at 0x%08X", rowAddr);
+        return CY_FLASH_DRV_INVALID_INPUT_PARAMETERS;
+    }
+    if (0U != (rowAddr % CY_FLASH_SIZEOF_ROW))
+    {
+        return CY_FLASH_DRV_INVALID_INPUT_PARAMETERS;
+    }
+
+    prot = pdl_sim_prot((uintptr_t)rowAddr);
+    if ((prot < 0) || (0 != mprotect((void *)page, len, prot | PROT_WRITE)))
+    {
+        return CY_FLASH_DRV_INVALID_INPUT_PARAMETERS;
+    }
+
+    if (NULL != data)
+    {
+        (void)memcpy((void *)(uintptr_t)rowAddr, data, CY_FLASH_SIZEOF_ROW);
+    }
+    else
+    {
+        (void)memset((void *)(uintptr_t)rowAddr, 0, CY_FLASH_SIZEOF_ROW);
+    }
+    (void)mprotect((void *)page, len, prot);
+
+    nor_sim_wait_ns((uint64_t)us * 1000ULL);
+
+    return CY_FLASH_DRV_SUCCESS;
+}
+
+cy_en_flashdrv_status_t Cy_Flash_EraseRow(uint32_t rowAddr)
+{
+    return pdl_sim_flash_row(rowAddr, NULL, PDL_SIM_FLASH_ROW_HALF_US);
+}
+
+cy_en_flashdrv_status_t Cy_Flash_ProgramRow(uint32_t rowAddr, const uint32_t *data)
+{
+    return (NULL != data) ? pdl_sim_flash_row(rowAddr, data, PDL_SIM_FLASH_ROW_HALF_US) :
+                            CY_FLASH_DRV_INVALID_INPUT_PARAMETERS;
+}
+
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data)
+{
+    return (NULL != data) ? pdl_sim_flash_row(rowAddr, data, PDL_SIM_FLASH_ROW_WRITE_US) :
+                            CY_FLASH_DRV_INVALID_INPUT_PARAMETERS;
+}
+
+/*******************************************************************************
+* SMIF block
+********************************************************************************/
+/* Memory mode reads through the XIP window while the block runs */
+static void pdl_sim_update_xip(void)
+{
+    nor_sim_xip_mode(pdl_sim_smif_enabled && (pdl_sim_smif_mode == CY_SMIF_MEMORY));
+}
+
+cy_en_smif_status_t Cy_SMIF_Init(SMIF_Type *base, cy_stc_smif_config_t const *config,
+                                 uint32_t timeout, cy_stc_smif_context_t *context)
+{
+    pdl_sim_cpu(PDL_SIM_CALL_CYCLES);
+
+    if ((NULL == config) || (NULL == context) || pdl_sim_smif_enabled)
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    (void)memset(context, 0, sizeof(*context));
+    context->timeout = timeout;
+    base->CTL = _CLR_SET_FLD32U(base->CTL, SMIF_CTL_CLOCK_IF_RX_SEL, config->rxClockSel);
+    pdl_sim_smif_mode = (cy_en_smif_mode_t)config->mode;
+    pdl_sim_selected = false;
+
+    return CY_SMIF_SUCCESS;
+}
+
+void Cy_SMIF_Enable(SMIF_Type *base, cy_stc_smif_context_t *context)
+{
+    (void)base;
+    (void)context;
+
+    pdl_sim_cpu(PDL_SIM_CALL_CYCLES);
+    pdl_sim_smif_enabled = true;
+    pdl_sim_apply_clock();
+    pdl_sim_update_xip();
+}
+
+void Cy_SMIF_Disable(SMIF_Type *base)
+{
+    (void)base;
+
+    pdl_sim_cpu(PDL_SIM_CALL_CYCLES);
+    pdl_sim_smif_enabled = false;
+    pdl_sim_apply_clock();
+    pdl_sim_update_xip();
+}
+
+void Cy_SMIF_SetMode(SMIF_Type *base, cy_en_smif_mode_t mode)
+{
+    (void)base;
+
+    pdl_sim_cpu(PDL_SIM_CALL_CYCLES);
+    if (pdl_sim_selected && (mode == CY_SMIF_MEMORY))
+    {
+        nor_sim_violation("memory mode with a command transfer open");
+    }
+    pdl_sim_smif_mode = mode;
+    pdl_sim_apply_clock();
+    pdl_sim_update_xip();
+}
+
+cy_en_smif_mode_t Cy_SMIF_GetMode(SMIF_Type const *base)
+{
+    (void)base;
+
+    return pdl_sim_smif_mode;
+}
+
+void Cy_SMIF_SetReadyPollingDelay(uint16_t pollTimeoutUs, cy_stc_smif_context_t *context)
+{
+    context->memReadyPollDelay = pollTimeoutUs;
+}
+
+cy_en_smif_status_t Cy_SMIF_CacheEnable(SMIF_Type *base, cy_en_smif_cache_t cacheType)
+{
+    (void)base;
+    (void)cacheType;
+
+    return CY_SMIF_SUCCESS;
+}
+
+cy_en_smif_status_t Cy_SMIF_CacheInvalidate(SMIF_Type *base, cy_en_smif_cache_t cacheType)
+{
+    (void)base;
+    (void)cacheType;
+
+    pdl_sim_cpu(PDL_SIM_CALL_CYCLES);
+    nor_sim_xip_invalidate();
+
+    return CY_SMIF_SUCCESS;
+}
+
+cy_en_smif_status_t Cy_SMIF_CachePrefetchingEnable(SMIF_Type *base, cy_en_smif_cache_t cacheType)
+{
+    (void)base;
+    (void)cacheType;
+
+    return CY_SMIF_SUCCESS;
+}
+
+/*******************************************************************************
+* SMIF transfers
+********************************************************************************/
+static uint32_t pdl_sim_lines(cy_en_smif_txfr_width_t width)
+{
+    return 1UL << (uint32_t)width;
+}
+
+/* Common checks of a transfer call */
+static cy_en_smif_status_t pdl_sim_transfer_begin(void)
+{
+    pdl_sim_cpu(PDL_SIM_CALL_CYCLES);
+    pdl_sim_apply_clock();
+
+    if ((!pdl_sim_smif_enabled) || (pdl_sim_smif_mode != CY_SMIF_NORMAL))
+    {
+        nor_sim_violation("SMIF transfer with the block %s",
+                          pdl_sim_smif_enabled ? "in memory mode" : "disabled");
+        return CY_SMIF_EXCEED_TIMEOUT;
+    }
+
+    return CY_SMIF_SUCCESS;
+}
+
+static void pdl_sim_transfer_end(void)
+{
+    nor_sim_deselect();
+    pdl_sim_selected = false;
+}
+
+cy_en_smif_status_t Cy_SMIF_TransmitCommand(SMIF_Type *base, uint8_t cmd,
+                                            cy_en_smif_txfr_width_t cmdTxfrWidth,
+                                            uint8_t const cmdParam[], uint32_t paramSize,
+                                            cy_en_smif_txfr_width_t paramTxfrWidth,
+                                            cy_en_smif_slave_select_t slaveSelect,
+                                            uint32_t completeTxfr,
+                                            cy_stc_smif_context_t const *context)
+{
+    uint32_t ss = (uint32_t)slaveSelect;
+    cy_en_smif_status_t st;
+
+    (void)base;
+    (void)context;
+
+    if ((0U == ss) || (0U != (ss & (ss - 1U))) || (ss >= (1UL << SMIF_CHIP_TOP_SPI_SEL_NR)) ||
+        ((0U != paramSize) && (NULL == cmdParam)))
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    st = pdl_sim_transfer_begin();
+    if (st != CY_SMIF_SUCCESS)
+    {
+        return st;
+    }
+
+    if (!pdl_sim_selected)
+    {
+        nor_sim_select((uint32_t)__builtin_ctz(ss));
+        pdl_sim_selected = true;
+    }
+
+    nor_sim_write(&cmd, 1U, pdl_sim_lines(cmdTxfrWidth));
+    if (0U != paramSize)
+    {
+        nor_sim_write(cmdParam, paramSize, pdl_sim_lines(paramTxfrWidth));
+    }
+
+    if (CY_SMIF_TX_LAST_BYTE == completeTxfr)
+    {
+        pdl_sim_transfer_end();
+    }
+
+    return CY_SMIF_SUCCESS;
+}
+
+cy_en_smif_status_t Cy_SMIF_TransmitDataBlocking(SMIF_Type *base, uint8_t const *txBuffer,
+                                                 uint32_t size,
+                                                 cy_en_smif_txfr_width_t transferWidth,
+                                                 cy_stc_smif_context_t const *context)
+{
+    cy_en_smif_status_t st;
+
+    (void)base;
+    (void)context;
+
+    if ((NULL == txBuffer) || (0U == size))
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    st = pdl_sim_transfer_begin();
+    if (st == CY_SMIF_SUCCESS)
+    {
+        nor_sim_write(txBuffer, size, pdl_sim_lines(transferWidth));
+        pdl_sim_transfer_end();
+    }
+
+    return st;
+}
+
+cy_en_smif_status_t Cy_SMIF_ReceiveDataBlocking(SMIF_Type *base, uint8_t *rxBuffer,
+                                                uint32_t size,
+                                                cy_en_smif_txfr_width_t transferWidth,
+                                                cy_stc_smif_context_t const *context)
+{
+    cy_en_smif_status_t st;
+
+    (void)base;
+    (void)context;
+
+    if ((NULL == rxBuffer) || (0U == size))
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    st = pdl_sim_transfer_begin();
+    if (st == CY_SMIF_SUCCESS)
+    {
+        nor_sim_read(rxBuffer, size, pdl_sim_lines(transferWidth));
+        pdl_sim_transfer_end();
+    }
+
+    return st;
+}
+
+cy_en_smif_status_t Cy_SMIF_SendDummyCycles(SMIF_Type *base, uint32_t cycles)
+{
+    cy_en_smif_status_t st;
+
+    (void)base;
+
+    st = pdl_sim_transfer_begin();
+    if (st == CY_SMIF_SUCCESS)
+    {
+        nor_sim_dummy(cycles);
+    }
+
+    return st;
+}
+
+/*******************************************************************************
+* SMIF memory slot
+********************************************************************************/
+static void pdl_sim_addr(uint32_t address, uint32_t size, uint8_t *addr)
+{
+    for (uint32_t i = 0U; i < size; i++)
+    {
+        addr[i] = (uint8_t)(address >> (8U * (size - 1U - i)));
+    }
+}
+
+/* Opcode, address and mode byte of a memory command, the transfer stays open */
+static cy_en_smif_status_t pdl_sim_mem_cmd(cy_stc_smif_mem_config_t const *mem,
+                                           cy_stc_smif_mem_cmd_t const *cmd, uint32_t address,
+                                           cy_stc_smif_context_t const *context)
+{
+    uint8_t addr[4];
+    uint32_t addr_size = mem->deviceCfg->numOfAddrBytes;
+    cy_en_smif_status_t st;
+
+    pdl_sim_addr(address, addr_size, addr);
+    st = Cy_SMIF_TransmitCommand(SMIF0, (uint8_t)cmd->command, cmd->cmdWidth, addr, addr_size,
+                                 cmd->addrWidth, mem->slaveSelect, CY_SMIF_TX_NOT_LAST_BYTE,
+                                 context);
+    if ((st == CY_SMIF_SUCCESS) && (CY_SMIF_NO_COMMAND_OR_MODE != cmd->mode))
+    {
+        uint8_t mode = (uint8_t)cmd->mode;
+
+        nor_sim_write(&mode, 1U, pdl_sim_lines(cmd->modeWidth));
+    }
+    if ((st == CY_SMIF_SUCCESS) && (0U != cmd->dummyCycles))
+    {
+        st = Cy_SMIF_SendDummyCycles(SMIF0, cmd->dummyCycles);
+    }
+
+    return st;
+}
+
+/* Status register read with one of the read status commands */
+static cy_en_smif_status_t pdl_sim_read_status(cy_stc_smif_mem_config_t const *mem,
+                                               cy_stc_smif_mem_cmd_t const *cmd, uint8_t *status,
+                                               cy_stc_smif_context_t const *context)
+{
+    cy_en_smif_status_t st;
+
+    st = Cy_SMIF_TransmitCommand(SMIF0, (uint8_t)cmd->command, cmd->cmdWidth, NULL, 0U,
+                                 CY_SMIF_WIDTH_SINGLE, mem->slaveSelect, CY_SMIF_TX_NOT_LAST_BYTE,
+                                 context);
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_ReceiveDataBlocking(SMIF0, status, 1U, cmd->dataWidth, context);
+    }
+
+    return st;
+}
+
+bool Cy_SMIF_Memory_IsBusy(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                           cy_stc_smif_context_t const *context)
+{
+    uint8_t status = 0U;
+
+    (void)base;
+
+    if (pdl_sim_read_status(memDevice, memDevice->deviceCfg->readStsRegWipCmd, &status,
+                            context) != CY_SMIF_SUCCESS)
+    {
+        return true;
+    }
+
+    return (0U != (status & memDevice->deviceCfg->stsRegBusyMask));
+}
+
+/* Polls the busy bit every ready polling delay, up to timeout_us */
+static cy_en_smif_status_t pdl_sim_mem_ready(cy_stc_smif_mem_config_t const *mem, uint32_t timeout_us,
+                                             cy_stc_smif_context_t const *context)
+{
+    uint32_t delay = (0U != context->memReadyPollDelay) ? context->memReadyPollDelay : 1U;
+
+    while (Cy_SMIF_Memory_IsBusy(SMIF0, mem, context))
+    {
+        if (0U == timeout_us)
+        {
+            return CY_SMIF_EXCEED_TIMEOUT;
+        }
+        Cy_SysLib_DelayUs((uint16_t)delay);
+        timeout_us = (timeout_us > delay) ? (timeout_us - delay) : 0U;
+    }
+
+    return CY_SMIF_SUCCESS;
+}
+
+cy_en_smif_status_t Cy_SMIF_MemCmdWriteEnable(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                                              cy_stc_smif_context_t const *context)
+{
+    cy_stc_smif_mem_cmd_t const *cmd = memDevice->deviceCfg->writeEnCmd;
+
+    return Cy_SMIF_TransmitCommand(base, (uint8_t)cmd->command, cmd->cmdWidth, NULL, 0U,
+                                   CY_SMIF_WIDTH_SINGLE, memDevice->slaveSelect,
+                                   CY_SMIF_TX_LAST_BYTE, context);
+}
+
+cy_en_smif_status_t Cy_SMIF_MemCmdSectorErase(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                                              uint8_t const *sectorAddr,
+                                              cy_stc_smif_context_t const *context)
+{
+    cy_stc_smif_mem_cmd_t const *cmd = memDevice->deviceCfg->eraseCmd;
+
+    if (NULL == sectorAddr)
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    return Cy_SMIF_TransmitCommand(base, (uint8_t)cmd->command, cmd->cmdWidth, sectorAddr,
+                                   memDevice->deviceCfg->numOfAddrBytes, cmd->addrWidth,
+                                   memDevice->slaveSelect, CY_SMIF_TX_LAST_BYTE, context);
+}
+
+cy_en_smif_status_t Cy_SMIF_MemRead(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                    uint32_t address, uint8_t rxBuffer[], uint32_t length,
+                                    cy_stc_smif_context_t const *context)
+{
+    cy_stc_smif_mem_device_cfg_t const *dev = memConfig->deviceCfg;
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+
+    (void)base;
+
+    if ((NULL == rxBuffer) || ((address + length) > dev->memSize) || (address + length < address))
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    while ((length > 0U) && (st == CY_SMIF_SUCCESS))
+    {
+        uint32_t chunk = (length < PDL_SIM_MAX_RX_COUNT) ? length : PDL_SIM_MAX_RX_COUNT;
+
+        st = pdl_sim_mem_cmd(memConfig, dev->readCmd, address, context);
+        if (st == CY_SMIF_SUCCESS)
+        {
+            st = Cy_SMIF_ReceiveDataBlocking(SMIF0, rxBuffer, chunk, dev->readCmd->dataWidth, context);
+        }
+        address += chunk;
+        rxBuffer += chunk;
+        length -= chunk;
+    }
+
+    return st;
+}
+
+cy_en_smif_status_t Cy_SMIF_MemWrite(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                     uint32_t address, uint8_t const txBuffer[], uint32_t length,
+                                     cy_stc_smif_context_t const *context)
+{
+    cy_stc_smif_mem_device_cfg_t const *dev = memConfig->deviceCfg;
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+
+    if ((NULL == txBuffer) || ((address + length) > dev->memSize) || (address + length < address) ||
+        (0U == dev->programSize))
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    while ((length > 0U) && (st == CY_SMIF_SUCCESS))
+    {
+        uint32_t chunk = dev->programSize - (address % dev->programSize);
+
+        chunk = (length < chunk) ? length : chunk;
+
+        st = Cy_SMIF_MemCmdWriteEnable(base, memConfig, context);
+        if (st == CY_SMIF_SUCCESS)
+        {
+            st = pdl_sim_mem_cmd(memConfig, dev->programCmd, address, context);
+        }
+        if (st == CY_SMIF_SUCCESS)
+        {
+            st = Cy_SMIF_TransmitDataBlocking(base, txBuffer, chunk, dev->programCmd->dataWidth, context);
+        }
+        if (st == CY_SMIF_SUCCESS)
+        {
+            st = pdl_sim_mem_ready(memConfig, dev->programTime, context);
+        }
+        address += chunk;
+        txBuffer += chunk;
+        length -= chunk;
+    }
+
+    return st;
+}
+
+cy_en_smif_status_t Cy_SMIF_MemEraseSector(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                           uint32_t address, uint32_t length,
+                                           cy_stc_smif_context_t const *context)
+{
+    cy_stc_smif_mem_device_cfg_t const *dev = memConfig->deviceCfg;
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+    uint32_t end = address + length;
+
+    if ((0U == dev->eraseSize) || (0U != (address % dev->eraseSize)) ||
+        (0U != (length % dev->eraseSize)) || (end > dev->memSize) || (end < address))
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    for (; (address < end) && (st == CY_SMIF_SUCCESS); address += dev->eraseSize)
+    {
+        uint8_t addr[4];
+
+        pdl_sim_addr(address, dev->numOfAddrBytes, addr);
+        st = Cy_SMIF_MemCmdWriteEnable(base, memConfig, context);
+        if (st == CY_SMIF_SUCCESS)
+        {
+            st = Cy_SMIF_MemCmdSectorErase(base, memConfig, addr, context);
+        }
+        if (st == CY_SMIF_SUCCESS)
+        {
+            st = pdl_sim_mem_ready(memConfig, dev->eraseTime * 1000UL, context);
+        }
+    }
+
+    return st;
+}
+
+cy_en_smif_status_t Cy_SMIF_MemIsQuadEnabled(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                                             bool *isQuadEnabled, cy_stc_smif_context_t const *context)
+{
+    uint8_t status = 0U;
+    cy_en_smif_status_t st;
+
+    (void)base;
+
+    st = pdl_sim_read_status(memDevice, memDevice->deviceCfg->readStsRegQeCmd, &status, context);
+    *isQuadEnabled = (st == CY_SMIF_SUCCESS) &&
+                     (0U != (status & memDevice->deviceCfg->stsRegQuadEnableMask));
+
+    return st;
+}
+
+/* Sets the QE bit. A QE bit in status register 2 is written together with
+ * status register 1, which is read back first (JESD216 QER 100b and 101b).
+ */
+cy_en_smif_status_t Cy_SMIF_MemEnableQuadMode(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+                                              uint32_t timeoutUs, cy_stc_smif_context_t const *context)
+{
+    cy_stc_smif_mem_device_cfg_t const *dev = memDevice->deviceCfg;
+    uint8_t regs[2] = { 0U, 0U };
+    uint32_t size = 1U;
+    cy_en_smif_status_t st;
+
+    st = pdl_sim_read_status(memDevice, dev->readStsRegQeCmd, &regs[1], context);
+    if ((st == CY_SMIF_SUCCESS) && (0x35U == dev->readStsRegQeCmd->command))
+    {
+        st = pdl_sim_read_status(memDevice, dev->readStsRegWipCmd, &regs[0], context);
+        size = 2U;
+    }
+    if (st == CY_SMIF_SUCCESS)
+    {
+        regs[1] |= (uint8_t)dev->stsRegQuadEnableMask;
+        st = Cy_SMIF_MemCmdWriteEnable(base, memDevice, context);
+    }
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_TransmitCommand(base, (uint8_t)dev->writeStsRegQeCmd->command,
+                                     dev->writeStsRegQeCmd->cmdWidth, &regs[2U - size], size,
+                                     CY_SMIF_WIDTH_SINGLE, memDevice->slaveSelect,
+                                     CY_SMIF_TX_LAST_BYTE, context);
+    }
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = pdl_sim_mem_ready(memDevice, timeoutUs, context);
+    }
+
+    return st;
+}
+
+/*******************************************************************************
+* SFDP detection
+********************************************************************************/
+static cy_en_smif_status_t pdl_sim_sfdp_read(cy_stc_smif_mem_config_t const *mem, uint32_t address,
+                                             uint8_t *data, uint32_t len,
+                                             cy_stc_smif_context_t const *context)
+{
+    cy_stc_smif_mem_cmd_t const *cmd = mem->deviceCfg->readSfdpCmd;
+    uint8_t addr[3];
+    cy_en_smif_status_t st;
+
+    pdl_sim_addr(address, sizeof(addr), addr);
+    st = Cy_SMIF_TransmitCommand(SMIF0, (uint8_t)cmd->command, cmd->cmdWidth, addr, sizeof(addr),
+                                 cmd->addrWidth, mem->slaveSelect, CY_SMIF_TX_NOT_LAST_BYTE, context);
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_SendDummyCycles(SMIF0, cmd->dummyCycles);
+    }
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_ReceiveDataBlocking(SMIF0, data, len, cmd->dataWidth, context);
+    }
+
+    return st;
+}
+
+static void pdl_sim_set_cmd(cy_stc_smif_mem_cmd_t *cmd, uint32_t command)
+{
+    if (NULL != cmd)
+    {
+        cmd->command = command;
+        cmd->cmdWidth = CY_SMIF_WIDTH_SINGLE;
+        cmd->addrWidth = CY_SMIF_WIDTH_SINGLE;
+        cmd->mode = CY_SMIF_NO_COMMAND_OR_MODE;
+        cmd->modeWidth = CY_SMIF_WIDTH_SINGLE;
+        cmd->dummyCycles = 0U;
+        cmd->dataWidth = CY_SMIF_WIDTH_SINGLE;
+    }
+}
+
+static uint32_t pdl_sim_opcode_4b_of(uint32_t opcode)
+{
+    for (uint32_t i = 0U; i < (sizeof(pdl_sim_opcode_4b) / sizeof(pdl_sim_opcode_4b[0])); i++)
+    {
+        if (opcode == pdl_sim_opcode_4b[i][0])
+        {
+            return pdl_sim_opcode_4b[i][1];
+        }
+    }
+
+    return opcode;
+}
+
+/* JESD216 time field: count in bits 4:0, unit index above */
+static uint32_t pdl_sim_sfdp_time(uint32_t field, const uint32_t *units)
+{
+    return ((field & 0x1FU) + 1U) * units[(field >> 5) & 0x3U];
+}
+
+/* Fills the device configuration from the SFDP tables of the part: the
+ * fastest read (1-4-4, 1-1-4, then 1-1-1 fast read), quad program where
+ * available, the 4 KB erase or else erase type 1, the maximum times and the
+ * QE bit.
+ */
+static cy_en_smif_status_t pdl_sim_sfdp_detect(cy_stc_smif_mem_config_t const *mem,
+                                               cy_stc_smif_context_t const *context)
+{
+    static const uint32_t erase_units_ms[4] = { 1U, 16U, 128U, 1000U };
+    static const uint32_t program_units_us[2] = { 8U, 64U };
+    static const uint32_t chip_units_ms[4] = { 16U, 256U, 4000U, 64000U };
+    cy_stc_smif_mem_device_cfg_t *dev = mem->deviceCfg;
+    uint8_t header[8U + (8U * PDL_SIM_SFDP_HEADER_NUM_MAX)];
+    uint8_t table[PDL_SIM_BFPT_DWORDS * 4U];
+    uint32_t dw[PDL_SIM_BFPT_DWORDS];
+    uint32_t fourb[2] = { 0U, 0U };
+    uint32_t bfpt_ptr = 0U;
+    uint32_t bfpt_len = 0U;
+    uint32_t headers;
+    uint32_t erase_type = 0U;
+    uint32_t mult;
+    bool has_4bait = false;
+    bool addr_4b;
+    cy_stc_smif_mem_cmd_t *rd = dev->readCmd;
+    cy_stc_smif_mem_cmd_t *pgm = dev->programCmd;
+    cy_en_smif_status_t st;
+
+    st = pdl_sim_sfdp_read(mem, 0U, header, sizeof(header), context);
+    if ((st != CY_SMIF_SUCCESS) || (0 != memcmp(header, "SFDP", 4U)))
+    {
+        return CY_SMIF_NO_SFDP_SUPPORT;
+    }
+
+    headers = (uint32_t)header[6] + 1U;
+    headers = (headers < PDL_SIM_SFDP_HEADER_NUM_MAX) ? headers : PDL_SIM_SFDP_HEADER_NUM_MAX;
+    for (uint32_t i = 0U; i < headers; i++)
+    {
+        const uint8_t *ph = &header[8U + (8U * i)];
+        uint32_t id = (uint32_t)ph[0] | ((uint32_t)ph[7] << 8);
+        uint32_t ptr = (uint32_t)ph[4] | ((uint32_t)ph[5] << 8) | ((uint32_t)ph[6] << 16);
+
+        if (PDL_SIM_SFDP_ID_BFPT == id)
+        {
+            bfpt_ptr = ptr;
+            bfpt_len = (ph[3] < PDL_SIM_BFPT_DWORDS) ? ph[3] : PDL_SIM_BFPT_DWORDS;
+        }
+        else if ((PDL_SIM_SFDP_ID_4BAIT == id) && (ph[3] >= 2U))
+        {
+            uint8_t raw[8];
+
+            if (pdl_sim_sfdp_read(mem, ptr, raw, sizeof(raw), context) == CY_SMIF_SUCCESS)
+            {
+                for (uint32_t d = 0U; d < 2U; d++)
+                {
+                    fourb[d] = (uint32_t)raw[4U * d] | ((uint32_t)raw[(4U * d) + 1U] << 8) |
+                               ((uint32_t)raw[(4U * d) + 2U] << 16) | ((uint32_t)raw[(4U * d) + 3U] << 24);
+                }
+                has_4bait = true;
+            }
+        }
+        else
+        {
+            /* Other tables are not used */
+        }
+    }
+
+    if ((bfpt_len < PDL_SIM_BFPT_DWORDS_MIN) ||
+        (pdl_sim_sfdp_read(mem, bfpt_ptr, table, bfpt_len * 4U, context) != CY_SMIF_SUCCESS))
+    {
+        return CY_SMIF_NO_SFDP_SUPPORT;
+    }
+    (void)memset(dw, 0, sizeof(dw));
+    for (uint32_t d = 0U; d < bfpt_len; d++)
+    {
+        dw[d] = (uint32_t)table[4U * d] | ((uint32_t)table[(4U * d) + 1U] << 8) |
+                ((uint32_t)table[(4U * d) + 2U] << 16) | ((uint32_t)table[(4U * d) + 3U] << 24);
+    }
+
+    /* Density in bits */
+    dev->memSize = (0U != (dw[1] & 0x80000000UL)) ? (1UL << ((dw[1] & 0x7FFFFFFFUL) - 3U)) :
+                   ((dw[1] + 1U) / 8U);
+    switch ((dw[0] >> 17) & 0x3U)
+    {
+    case 0U:
+        addr_4b = false;
+        break;
+    case 1U:
+        addr_4b = (dev->memSize > PDL_SIM_3B_SIZE_MAX);
+        break;
+    default:
+        addr_4b = true;
+        break;
+    }
+    dev->numOfAddrBytes = addr_4b ? 4U : 3U;
+
+    pdl_sim_set_cmd(rd, 0x0BU);
+    rd->dummyCycles = 8U;
+    if (0U != (dw[0] & (1UL << 21)))
+    {
+        rd->command = (dw[2] >> 8) & 0xFFU;
+        rd->addrWidth = CY_SMIF_WIDTH_QUAD;
+        rd->dataWidth = CY_SMIF_WIDTH_QUAD;
+        rd->dummyCycles = dw[2] & 0x1FU;
+        if (0U != ((dw[2] >> 5) & 0x7U))
+        {
+            rd->mode = 0x00U;
+            rd->modeWidth = CY_SMIF_WIDTH_QUAD;
+        }
+    }
+    else if (0U != (dw[0] & (1UL << 22)))
+    {
+        rd->command = dw[2] >> 24;
+        rd->dataWidth = CY_SMIF_WIDTH_QUAD;
+        rd->dummyCycles = (dw[2] >> 16) & 0x1FU;
+    }
+    else
+    {
+        /* 1-1-1 fast read */
+    }
+
+    pdl_sim_set_cmd(pgm, 0x02U);
+    if ((addr_4b && has_4bait && (0U != (fourb[0] & (1UL << 7)))) ||
+        ((!addr_4b) && (0U != (dw[0] & (1UL << 22)))))
+    {
+        pgm->command = 0x32U;
+        pgm->dataWidth = CY_SMIF_WIDTH_QUAD;
+    }
+
+    if (addr_4b && has_4bait)
+    {
+        rd->command = pdl_sim_opcode_4b_of(rd->command);
+        pgm->command = pdl_sim_opcode_4b_of(pgm->command);
+    }
+
+    /* The 4 KB erase if there is one, else erase type 1 */
+    if (0x1U == (dw[0] & 0x3U))
+    {
+        for (uint32_t i = 0U; i < 4U; i++)
+        {
+            if (12U == ((dw[7U + (i / 2U)] >> (16U * (i % 2U))) & 0xFFU))
+            {
+                erase_type = i;
+                break;
+            }
+        }
+    }
+    dev->eraseSize = 1UL << ((dw[7] >> (16U * erase_type)) & 0xFFU);
+    pdl_sim_set_cmd(dev->eraseCmd, (dw[7U + (erase_type / 2U)] >> ((16U * (erase_type % 2U)) + 8U)) & 0xFFU);
+    if (addr_4b && has_4bait && (NULL != dev->eraseCmd))
+    {
+        dev->eraseCmd->command = (fourb[1] >> (8U * erase_type)) & 0xFFU;
+    }
+    mult = 2U * ((dw[9] & 0xFU) + 1U);
+    dev->eraseTime = mult * pdl_sim_sfdp_time((dw[9] >> (4U + (7U * erase_type))) & 0x7FU, erase_units_ms);
+
+    mult = 2U * ((dw[10] & 0xFU) + 1U);
+    dev->programSize = 1UL << ((dw[10] >> 4) & 0xFU);
+    dev->programTime = mult * pdl_sim_sfdp_time((dw[10] >> 8) & 0x3FU, program_units_us);
+    dev->chipEraseTime = mult * pdl_sim_sfdp_time((dw[10] >> 24) & 0x7FU, chip_units_ms);
+
+    pdl_sim_set_cmd(dev->chipEraseCmd, 0x60U);
+    pdl_sim_set_cmd(dev->writeEnCmd, 0x06U);
+    pdl_sim_set_cmd(dev->writeDisCmd, 0x04U);
+    pdl_sim_set_cmd(dev->readStsRegWipCmd, 0x05U);
+    dev->stsRegBusyMask = 0x01U;
+
+    switch ((dw[14] >> 20) & 0x7U)
+    {
+    case 0U:
+        /* No QE bit */
+        pdl_sim_set_cmd(dev->readStsRegQeCmd, 0x05U);
+        pdl_sim_set_cmd(dev->writeStsRegQeCmd, 0x01U);
+        dev->stsRegQuadEnableMask = 0U;
+        break;
+    case 2U:
+        pdl_sim_set_cmd(dev->readStsRegQeCmd, 0x05U);
+        pdl_sim_set_cmd(dev->writeStsRegQeCmd, 0x01U);
+        dev->stsRegQuadEnableMask = 0x40U;
+        break;
+    default:
+        /* Bit 1 of status register 2, written with 01h and two bytes */
+        pdl_sim_set_cmd(dev->readStsRegQeCmd, 0x35U);
+        pdl_sim_set_cmd(dev->writeStsRegQeCmd, 0x01U);
+        dev->stsRegQuadEnableMask = 0x02U;
+        break;
+    }
+
+    dev->hybridRegionCount = 0U;
+    dev->hybridRegionInfo = NULL;
+
+    return CY_SMIF_SUCCESS;
+}
+
+cy_en_smif_status_t Cy_SMIF_MemInit(SMIF_Type *base, cy_stc_smif_block_config_t const *blockConfig,
+                                    cy_stc_smif_context_t *context)
+{
+    (void)base;
+
+    pdl_sim_cpu(PDL_SIM_CALL_CYCLES);
+
+    if ((NULL == blockConfig) || (0U == blockConfig->memCount) ||
+        (blockConfig->memCount > SMIF_CHIP_TOP_SPI_SEL_NR) || (!pdl_sim_smif_enabled))
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    (void)nor_sim_xip_map(0U, 0U, NULL);
+
+    for (uint32_t i = 0U; i < blockConfig->memCount; i++)
+    {
+        cy_stc_smif_mem_config_t const *mem = blockConfig->memConfig[i];
+        uint32_t chip;
+
+        if ((NULL == mem) || (NULL == mem->deviceCfg) || (0U == (uint32_t)mem->slaveSelect))
+        {
+            return CY_SMIF_BAD_PARAM;
+        }
+        chip = (uint32_t)__builtin_ctz((uint32_t)mem->slaveSelect);
+
+        if ((0U != (mem->flags & CY_SMIF_FLAG_DETECT_SFDP)) &&
+            (pdl_sim_sfdp_detect(mem, context) != CY_SMIF_SUCCESS))
+        {
+            return CY_SMIF_SFDP_SS0_FAILED;
+        }
+
+        if (0U != (mem->flags & CY_SMIF_FLAG_MEMORY_MAPPED))
+        {
+            cy_stc_smif_mem_cmd_t const *rd = mem->deviceCfg->readCmd;
+            nor_sim_xip_cmd_t xip =
+            {
+                .cmd = (uint8_t)rd->command,
+                .addr_bytes = (uint8_t)mem->deviceCfg->numOfAddrBytes,
+                .addr_lines = (uint8_t)pdl_sim_lines(rd->addrWidth),
+                .mode_bytes = (CY_SMIF_NO_COMMAND_OR_MODE != rd->mode) ? 1U : 0U,
+                .dummy_cycles = (uint8_t)rd->dummyCycles,
+                .data_lines = (uint8_t)pdl_sim_lines(rd->dataWidth),
+            };
+
+            /* Device regions are a power of 2, aligned to their size */
+            if ((mem->baseAddress < CY_XIP_BASE) || (0U == mem->memMappedSize) ||
+                (0U != (mem->memMappedSize & (mem->memMappedSize - 1U))) ||
+                (0U != ((mem->baseAddress - CY_XIP_BASE) % mem->memMappedSize)) ||
+                (!nor_sim_xip_map(chip, mem->baseAddress - CY_XIP_BASE, &xip)))
+            {
+                return CY_SMIF_BAD_PARAM;
+            }
+        }
+    }
+
+    return CY_SMIF_SUCCESS;
+}
+
+void Cy_SMIF_MemDeInit(SMIF_Type *base)
+{
+    (void)base;
+
+    pdl_sim_cpu(PDL_SIM_CALL_CYCLES);
+    (void)nor_sim_xip_map(0U, 0U, NULL);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,32 @@
+/******************************************************************************
+* File Name:   pdl_sim.h
+*
+* Description: Host implementation of the PDL calls of flash_qspi.c, see
+*              include/cy_pdl.h. Settings of the simulated device that the
+*              firmware reads but does not set.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(PDL_SIM_H)
+#define PDL_SIM_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* clk_path0 and CM4 clock of Design.modus */
+#define PDL_SIM_PATH_HZ_DEFAULT             (144000000UL)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void pdl_sim_set_path_hz(uint32_t hz);
+uint32_t pdl_sim_get_spi_hz(void);
+uint32_t pdl_sim_get_rx_clock_sel(void);
+
+#endif /* PDL_SIM_H */
@@ -0,0 +1,612 @@
+/******************************************************************************
+* File Name:   qspi_sim.c
+*
+* Description: Host runner of flash_qspi.c on the SMIF simulator (pdl_sim.c,
+*              nor_sim.c). It brings up one of the flashDict parts the way
+*              the bootloader and the application do and measures, in
+*              simulated time:
+*
+*              - the deferred init (SFDP detection, QE bit) on the blank
+*                part, the init after a deinit once it holds data (tuning),
+*                and the next one (SFDP cache row, tuned timing checked)
+*              - erase, program and read through the Cy_SMIF_Mem* calls of
+*                the MCUboot flash PAL, on the memory configuration,
+*                device and context flash_qspi.c gives it
+*              - the asynchronous erase with reads made during it, and the
+*                latency of those reads (erase suspend)
+*              - the asynchronous program and the reads through the XIP
+*                window
+*              - with CY_FLASH_WRAP_EXT_SLOT, the internal flash row calls
+*                of the UBM middleware on the XIP window (flash_trace.c)
+*
+*              Every phase checks the data it reads back. The run fails on a
+*              mismatch, a failed call or a violation reported by the model.
+*              The results are printed and, with -j, written as JSON for
+*              sim_check.py.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cy_pdl.h"
+#include "flash_qspi.h"
+#include "flash_qspi_ext.h"
+#include "nor_sim.h"
+#include "pdl_sim.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#ifndef CY_BOOT_EXT_FLASH_CHIPS
+#define CY_BOOT_EXT_FLASH_CHIPS             (1U)
+#endif
+
+/* Slave select line of the bootloader and the application (main.c) */
+#define QSPI_SIM_SS_LINE                    (1UL)
+
+#define QSPI_SIM_FILE_DEFAULT               "qspi_sim.bin"
+#define QSPI_SIM_SIZE_DEFAULT               (0x100000UL)
+
+/* Reads made during the asynchronous erase */
+#define QSPI_SIM_READ_SIZE                  (0x1000UL)
+#define QSPI_SIM_READ_INTERVAL_US           (2000U)
+#define QSPI_SIM_IDLE_US                    (50U)
+/* Time allowed for the asynchronous erase beyond the maximum erase time of
+ * its sectors: an erase starved by the reads fails instead of hanging.
+ */
+#define QSPI_SIM_ERASE_SLACK_NS             (1000000000ULL)
+
+/* Rows written through the internal flash driver calls */
+#define QSPI_SIM_ROW_SPAN                   (0x4000UL)
+/* Largest sector the row emulation can rewrite (QSPI_ROW_SECTOR_MAX) */
+#define QSPI_SIM_ROW_SECTOR_MAX             (0x1000UL)
+
+#define QSPI_SIM_PHASE_MAX                  (10U)
+#define QSPI_SIM_INIT_NUM                   (3U)
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef struct
+{
+    const char *name;
+    uint64_t bytes;
+    uint64_t ns;
+} qspi_sim_phase_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const char *qspi_sim_part_name;
+static const char *qspi_sim_file = QSPI_SIM_FILE_DEFAULT;
+static const char *qspi_sim_json;
+static bool qspi_sim_erase;
+static uint32_t qspi_sim_path_mhz = PDL_SIM_PATH_HZ_DEFAULT / 1000000UL;
+static uint32_t qspi_sim_size = QSPI_SIM_SIZE_DEFAULT;
+
+static qspi_sim_phase_t qspi_sim_phases[QSPI_SIM_PHASE_MAX];
+static uint32_t qspi_sim_phase_count;
+static uint32_t qspi_sim_errors;
+
+/* First init on the blank part, init with the data to tune on, init from
+ * the SFDP cache
+ */
+static const char * const qspi_sim_init_names[QSPI_SIM_INIT_NUM] =
+{
+    "init_blank", "init_tune", "init_cached"
+};
+static uint64_t qspi_sim_init_ns[QSPI_SIM_INIT_NUM];
+static uint64_t qspi_sim_init_sfdp_reads[QSPI_SIM_INIT_NUM];
+
+static uint32_t qspi_sim_read_count;
+static uint64_t qspi_sim_read_max_ns;
+static uint64_t qspi_sim_read_total_ns;
+
+static volatile cy_en_smif_status_t qspi_sim_op_status;
+static volatile bool qspi_sim_op_done;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void qspi_sim_usage(const char *prog);
+
+static void qspi_sim_fail(const char *what, uint32_t value)
+{
+    fprintf(stderr, "qspi_sim: %s (%u)\n", what, value);
+    qspi_sim_errors++;
+}
+
+static void qspi_sim_check(bool ok, const char *what, uint32_t value)
+{
+    if (!ok)
+    {
+        qspi_sim_fail(what, value);
+    }
+}
+
+static void qspi_sim_phase(const char *name, uint64_t bytes, uint64_t ns)
+{
+    if (qspi_sim_phase_count < QSPI_SIM_PHASE_MAX)
+    {
+        qspi_sim_phases[qspi_sim_phase_count].name = name;
+        qspi_sim_phases[qspi_sim_phase_count].bytes = bytes;
+        qspi_sim_phases[qspi_sim_phase_count].ns = ns;
+        qspi_sim_phase_count++;
+    }
+}
+
+static uint32_t qspi_sim_kbps(uint64_t bytes, uint64_t ns)
+{
+    return (0U != ns) ? (uint32_t)((bytes * 1000000000ULL) / (ns * 1024U)) : 0U;
+}
+
+/* Reproducible data, a different stream for each seed */
+static void qspi_sim_fill(uint8_t *data, uint32_t len, uint32_t seed)
+{
+    uint32_t x = seed * 2654435761UL + 1U;
+
+    for (uint32_t i = 0U; i < len; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        data[i] = (uint8_t)x;
+    }
+}
+
+static void qspi_sim_op_done_cb(cy_en_smif_status_t status, void *arg)
+{
+    (void)arg;
+
+    qspi_sim_op_status = status;
+    qspi_sim_op_done = true;
+}
+
+/******************************************************************************
+ * Function Name: qspi_sim_init
+ ******************************************************************************
+ * Summary:
+ *  Brings up the external flash on first use as the firmware does, returns
+ *  the simulated time it took and the SFDP reads made.
+ *
+ ******************************************************************************/
+static cy_en_smif_status_t qspi_sim_init(uint64_t *ns, uint64_t *sfdp_reads)
+{
+    uint64_t start = nor_sim_time_ns();
+    uint64_t reads = nor_sim_stats()->sfdp_reads;
+    cy_en_smif_status_t st;
+
+    qspi_defer_init(QSPI_SIM_SS_LINE, NULL);
+    st = qspi_ensure_init();
+
+    *ns = nor_sim_time_ns() - start;
+    *sfdp_reads = nor_sim_stats()->sfdp_reads - reads;
+
+    return st;
+}
+
+/******************************************************************************
+ * Function Name: qspi_sim_pal
+ ******************************************************************************
+ * Summary:
+ *  Erases, programs and reads back span bytes at 0 with the Cy_SMIF_Mem*
+ *  calls of the MCUboot flash PAL.
+ *
+ ******************************************************************************/
+static void qspi_sim_pal(uint8_t *data, uint8_t *buf, uint32_t span)
+{
+    SMIF_Type *dev = qspi_get_device();
+    cy_stc_smif_mem_config_t *mem = qspi_get_memory_config(0U);
+    cy_stc_smif_context_t *ctx = qspi_get_context();
+    uint64_t start;
+    cy_en_smif_status_t st;
+
+    start = nor_sim_time_ns();
+    st = Cy_SMIF_MemEraseSector(dev, mem, 0U, span, ctx);
+    qspi_sim_phase("pal_erase", span, nor_sim_time_ns() - start);
+    qspi_sim_check(st == CY_SMIF_SUCCESS, "PAL erase", (uint32_t)st);
+
+    qspi_sim_fill(data, span, 1U);
+    start = nor_sim_time_ns();
+    st = Cy_SMIF_MemWrite(dev, mem, 0U, data, span, ctx);
+    qspi_sim_phase("pal_program", span, nor_sim_time_ns() - start);
+    qspi_sim_check(st == CY_SMIF_SUCCESS, "PAL program", (uint32_t)st);
+
+    start = nor_sim_time_ns();
+    st = Cy_SMIF_MemRead(dev, mem, 0U, buf, span, ctx);
+    qspi_sim_phase("pal_read", span, nor_sim_time_ns() - start);
+    qspi_sim_check(st == CY_SMIF_SUCCESS, "PAL read", (uint32_t)st);
+    qspi_sim_check(0 == memcmp(buf, data, span), "PAL read back mismatch", span);
+}
+
+/******************************************************************************
+ * Function Name: qspi_sim_async
+ ******************************************************************************
+ * Summary:
+ *  Erases size bytes at 0 in the background while reading the block at size
+ *  every QSPI_SIM_READ_INTERVAL_US, programs them back and reads them
+ *  through the XIP window.
+ *
+ ******************************************************************************/
+static void qspi_sim_async(const uint8_t *data, uint8_t *buf, uint32_t size)
+{
+    static uint8_t block[QSPI_SIM_READ_SIZE];
+    const cy_stc_smif_mem_device_cfg_t *cfg = qspi_get_memory_config(0U)->deviceCfg;
+    uint64_t start;
+    uint64_t deadline;
+    uint64_t next_read;
+    cy_en_smif_status_t st;
+
+    qspi_sim_op_done = false;
+    start = nor_sim_time_ns();
+    deadline = start + ((uint64_t)(size / cfg->eraseSize) * cfg->eraseTime * 1000000ULL) +
+               QSPI_SIM_ERASE_SLACK_NS;
+    next_read = start + (QSPI_SIM_READ_INTERVAL_US * 1000ULL);
+    st = qspi_erase_start(0U, size, qspi_sim_op_done_cb, NULL);
+    qspi_sim_check(st == CY_SMIF_SUCCESS, "async erase start", (uint32_t)st);
+
+    while ((st == CY_SMIF_SUCCESS) && qspi_async_process())
+    {
+        if (nor_sim_time_ns() > deadline)
+        {
+            qspi_sim_fail("async erase does not progress", size);
+            return;
+        }
+        if (nor_sim_time_ns() >= next_read)
+        {
+            uint64_t read_start = nor_sim_time_ns();
+            uint64_t read_ns;
+
+            st = qspi_read_start(size, block, QSPI_SIM_READ_SIZE);
+            qspi_sim_check(st == CY_SMIF_SUCCESS, "read during erase", (uint32_t)st);
+            (void)qspi_read_wait();
+
+            read_ns = nor_sim_time_ns() - read_start;
+            qspi_sim_read_count++;
+            qspi_sim_read_total_ns += read_ns;
+            qspi_sim_read_max_ns = (read_ns > qspi_sim_read_max_ns) ? read_ns : qspi_sim_read_max_ns;
+            qspi_sim_check(0 == memcmp(block, &data[size], QSPI_SIM_READ_SIZE),
+                           "read during erase mismatch", qspi_sim_read_count);
+
+            next_read = nor_sim_time_ns() + (QSPI_SIM_READ_INTERVAL_US * 1000ULL);
+        }
+        else
+        {
+            Cy_SysLib_DelayUs(QSPI_SIM_IDLE_US);
+        }
+    }
+    qspi_sim_phase("async_erase", size, nor_sim_time_ns() - start);
+    qspi_sim_check(qspi_sim_op_done && (qspi_sim_op_status == CY_SMIF_SUCCESS),
+                   "async erase", (uint32_t)qspi_sim_op_status);
+
+    qspi_sim_op_done = false;
+    start = nor_sim_time_ns();
+    st = qspi_program_start(0U, data, size, qspi_sim_op_done_cb, NULL);
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = qspi_async_wait();
+    }
+    qspi_sim_phase("async_program", size, nor_sim_time_ns() - start);
+    qspi_sim_check((st == CY_SMIF_SUCCESS) && qspi_sim_op_done, "async program", (uint32_t)st);
+
+    start = nor_sim_time_ns();
+    st = qspi_read(0U, buf, size);
+    qspi_sim_phase("xip_read", size, nor_sim_time_ns() - start);
+    qspi_sim_check(st == CY_SMIF_SUCCESS, "XIP read", (uint32_t)st);
+    qspi_sim_check(0 == memcmp(buf, data, size), "XIP read back mismatch", size);
+}
+
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+/******************************************************************************
+ * Function Name: qspi_sim_rows
+ ******************************************************************************
+ * Summary:
+ *  Writes the first rows of the XIP window with the internal flash driver
+ *  calls, as the UBM middleware writes an upgrade image, then rewrites one.
+ *
+ ******************************************************************************/
+static void qspi_sim_rows(uint8_t *data, uint8_t *buf, uint32_t size)
+{
+    uint32_t span = (size < QSPI_SIM_ROW_SPAN) ? size : QSPI_SIM_ROW_SPAN;
+    uint64_t start;
+    cy_en_smif_status_t st;
+    cy_en_flashdrv_status_t fst = CY_FLASH_DRV_SUCCESS;
+
+    st = qspi_erase_start(0U, size, NULL, NULL);
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = qspi_async_wait();
+    }
+    qspi_sim_check(st == CY_SMIF_SUCCESS, "row area erase", (uint32_t)st);
+
+    qspi_sim_fill(data, span, 3U);
+    start = nor_sim_time_ns();
+    for (uint32_t row = 0U; (row < span) && (fst == CY_FLASH_DRV_SUCCESS); row += CY_FLASH_SIZEOF_ROW)
+    {
+        fst = Cy_Flash_WriteRow(CY_XIP_BASE + row, (const uint32_t *)&data[row]);
+    }
+    qspi_sim_phase("row_write", span, nor_sim_time_ns() - start);
+    qspi_sim_check(fst == CY_FLASH_DRV_SUCCESS, "row write", (uint32_t)fst);
+
+    /* Rewriting a row erases its sector and programs the others back */
+    if (qspi_get_erase_size() <= QSPI_SIM_ROW_SECTOR_MAX)
+    {
+        qspi_sim_fill(data, CY_FLASH_SIZEOF_ROW, 4U);
+        start = nor_sim_time_ns();
+        fst = Cy_Flash_WriteRow(CY_XIP_BASE, (const uint32_t *)data);
+        qspi_sim_phase("row_rewrite", CY_FLASH_SIZEOF_ROW, nor_sim_time_ns() - start);
+        qspi_sim_check(fst == CY_FLASH_DRV_SUCCESS, "row rewrite", (uint32_t)fst);
+    }
+
+    st = qspi_read(0U, buf, span);
+    qspi_sim_check((st == CY_SMIF_SUCCESS) && (0 == memcmp(buf, data, span)),
+                   "row read back mismatch", span);
+}
+#endif /* CY_FLASH_WRAP_EXT_SLOT */
+
+static void qspi_sim_print(const nor_sim_part_t *part, uint32_t size)
+{
+    const nor_sim_stats_t *stats = nor_sim_stats();
+
+    printf("%s x%u: %u bytes, SPI %u Hz, RX clock %u, read width %u, program width %u\n",
+           part->name, qspi_get_chip_count(), size, pdl_sim_get_spi_hz(),
+           pdl_sim_get_rx_clock_sel(), (uint32_t)qspi_get_read_width(),
+           (uint32_t)qspi_get_program_width());
+    for (uint32_t i = 0U; i < QSPI_SIM_INIT_NUM; i++)
+    {
+        printf("  %-13s %10llu us (%llu SFDP reads)\n", qspi_sim_init_names[i],
+               (unsigned long long)(qspi_sim_init_ns[i] / 1000U),
+               (unsigned long long)qspi_sim_init_sfdp_reads[i]);
+    }
+    for (uint32_t i = 0U; i < qspi_sim_phase_count; i++)
+    {
+        printf("  %-13s %10llu us %8u kB/s\n", qspi_sim_phases[i].name,
+               (unsigned long long)(qspi_sim_phases[i].ns / 1000U),
+               qspi_sim_kbps(qspi_sim_phases[i].bytes, qspi_sim_phases[i].ns));
+    }
+    printf("  reads during erase: %u, max %llu us, mean %llu us\n", qspi_sim_read_count,
+           (unsigned long long)(qspi_sim_read_max_ns / 1000U),
+           (unsigned long long)((0U != qspi_sim_read_count) ?
+                                (qspi_sim_read_total_ns / qspi_sim_read_count / 1000U) : 0U));
+    printf("  %llu suspends, %llu status reads, %llu XIP pages, %llu violations, %u errors\n",
+           (unsigned long long)stats->suspends, (unsigned long long)stats->status_reads,
+           (unsigned long long)stats->xip_pages, (unsigned long long)stats->violations,
+           qspi_sim_errors);
+}
+
+static bool qspi_sim_write_json(const nor_sim_part_t *part, uint32_t size)
+{
+    const nor_sim_stats_t *stats = nor_sim_stats();
+    const qspi_tune_result_t *tune;
+    uint32_t tune_count = 0U;
+    FILE *out = fopen(qspi_sim_json, "w");
+
+    if (NULL == out)
+    {
+        perror(qspi_sim_json);
+        return false;
+    }
+
+    fprintf(out, "{\n  \"part\": \"%s\",\n  \"chips\": %u,\n  \"size\": %u,\n", part->name,
+            qspi_get_chip_count(), size);
+    fprintf(out, "  \"path_hz\": %u,\n  \"spi_hz\": %u,\n  \"rx_clock_sel\": %u,\n",
+            qspi_sim_path_mhz * 1000000U, pdl_sim_get_spi_hz(), pdl_sim_get_rx_clock_sel());
+    fprintf(out, "  \"read_width\": %u,\n  \"program_width\": %u,\n",
+            (uint32_t)qspi_get_read_width(), (uint32_t)qspi_get_program_width());
+    fprintf(out, "  \"inits\": {\n");
+    for (uint32_t i = 0U; i < QSPI_SIM_INIT_NUM; i++)
+    {
+        fprintf(out, "    \"%s\": {\"us\": %llu, \"sfdp_reads\": %llu}%s\n", qspi_sim_init_names[i],
+                (unsigned long long)(qspi_sim_init_ns[i] / 1000U),
+                (unsigned long long)qspi_sim_init_sfdp_reads[i],
+                ((i + 1U) < QSPI_SIM_INIT_NUM) ? "," : "");
+    }
+    fprintf(out, "  },\n");
+
+    fprintf(out, "  \"phases\": {\n");
+    for (uint32_t i = 0U; i < qspi_sim_phase_count; i++)
+    {
+        fprintf(out, "    \"%s\": {\"bytes\": %llu, \"us\": %llu, \"kBps\": %u}%s\n",
+                qspi_sim_phases[i].name, (unsigned long long)qspi_sim_phases[i].bytes,
+                (unsigned long long)(qspi_sim_phases[i].ns / 1000U),
+                qspi_sim_kbps(qspi_sim_phases[i].bytes, qspi_sim_phases[i].ns),
+                ((i + 1U) < qspi_sim_phase_count) ? "," : "");
+    }
+    fprintf(out, "  },\n");
+
+    fprintf(out, "  \"erase_reads\": {\"count\": %u, \"max_us\": %llu, \"mean_us\": %llu},\n",
+            qspi_sim_read_count, (unsigned long long)(qspi_sim_read_max_ns / 1000U),
+            (unsigned long long)((0U != qspi_sim_read_count) ?
+                                 (qspi_sim_read_total_ns / qspi_sim_read_count / 1000U) : 0U));
+
+    tune = qspi_get_tune_results(&tune_count);
+    fprintf(out, "  \"tune\": [");
+    for (uint32_t i = 0U; i < tune_count; i++)
+    {
+        fprintf(out, "%s\n    {\"clk_hz\": %u, \"rx_clock_sel\": %u, \"pass\": %s, \"read_kBps\": %u}",
+                (0U != i) ? "," : "", tune[i].clk_hz, (uint32_t)tune[i].rx_clock_sel,
+                tune[i].pass ? "true" : "false", tune[i].read_kBps);
+    }
+    fprintf(out, "%s],\n", (0U != tune_count) ? "\n  " : "");
+
+    fprintf(out, "  \"stats\": {\"commands\": %llu, \"program_pages\": %llu, \"erases\": %llu, "
+            "\"status_reads\": %llu, \"suspends\": %llu, \"resumes\": %llu, \"xip_pages\": %llu, "
+            "\"violations\": %llu},\n",
+            (unsigned long long)stats->commands, (unsigned long long)stats->program_pages,
+            (unsigned long long)stats->erases, (unsigned long long)stats->status_reads,
+            (unsigned long long)stats->suspends, (unsigned long long)stats->resumes,
+            (unsigned long long)stats->xip_pages, (unsigned long long)stats->violations);
+    fprintf(out, "  \"errors\": %u\n}\n", qspi_sim_errors);
+
+    return (0 == fclose(out));
+}
+
+static void qspi_sim_usage(const char *prog)
+{
+    printf("USAGE:\n%s -p <part> [options]\n\n", prog);
+    printf("OPTIONS:\n");
+    printf("-h  --help       Display the usage information\n");
+    printf("-p  --part=      Part name of flashDict (see sfdp_gen.py -l)\n");
+    printf("-f  --file=      Flash contents file (default %s)\n", QSPI_SIM_FILE_DEFAULT);
+    printf("-e  --erase      Start from an erased part\n");
+    printf("-c  --clock=     clk_path0 in MHz (default %lu)\n", PDL_SIM_PATH_HZ_DEFAULT / 1000000UL);
+    printf("-s  --size=      Bytes erased, programmed and read (default %lu)\n", QSPI_SIM_SIZE_DEFAULT);
+    printf("-j  --json=      Results file\n");
+}
+
+/******************************************************************************
+ * Function Name: main
+ ******************************************************************************
+ * Summary:
+ *  Runs the phases on the part given with -p.
+ *
+ * Return:
+ *  0 if every phase passed and the model saw no violation.
+ *
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    static const struct option long_opts[] =
+    {
+        { "help", no_argument, NULL, 'h' },
+        { "part", required_argument, NULL, 'p' },
+        { "file", required_argument, NULL, 'f' },
+        { "erase", no_argument, NULL, 'e' },
+        { "clock", required_argument, NULL, 'c' },
+        { "size", required_argument, NULL, 's' },
+        { "json", required_argument, NULL, 'j' },
+        { NULL, 0, NULL, 0 }
+    };
+    const nor_sim_part_t *part;
+    uint8_t *data;
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t span;
+    uint32_t erase_size;
+    uint32_t chips;
+    cy_en_smif_status_t st;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "hp:f:ec:s:j:", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            qspi_sim_part_name = optarg;
+            break;
+        case 'f':
+            qspi_sim_file = optarg;
+            break;
+        case 'e':
+            qspi_sim_erase = true;
+            break;
+        case 'c':
+            qspi_sim_path_mhz = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            qspi_sim_size = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'j':
+            qspi_sim_json = optarg;
+            break;
+        default:
+            qspi_sim_usage(argv[0]);
+            return (opt == 'h') ? 0 : 2;
+        }
+    }
+
+    part = (NULL != qspi_sim_part_name) ? nor_sim_find_part(qspi_sim_part_name) : NULL;
+    if ((NULL == part) || (0U == qspi_sim_path_mhz))
+    {
+        qspi_sim_usage(argv[0]);
+        return 2;
+    }
+
+    pdl_sim_set_path_hz(qspi_sim_path_mhz * 1000000UL);
+    if (!nor_sim_open(part, CY_BOOT_EXT_FLASH_CHIPS, qspi_sim_file, qspi_sim_erase,
+                      CY_XIP_BASE, CY_XIP_SIZE))
+    {
+        return 2;
+    }
+
+    st = qspi_sim_init(&qspi_sim_init_ns[0], &qspi_sim_init_sfdp_reads[0]);
+    if (st != CY_SMIF_SUCCESS)
+    {
+        fprintf(stderr, "qspi_sim: init failed (%u)\n", (uint32_t)st);
+        nor_sim_close();
+        return 1;
+    }
+
+    /* The chips that fit in the XIP window are concatenated */
+    chips = CY_XIP_SIZE / part->flash_size;
+    chips = (chips < CY_BOOT_EXT_FLASH_CHIPS) ? chips : CY_BOOT_EXT_FLASH_CHIPS;
+    erase_size = qspi_get_erase_size();
+    qspi_sim_check(qspi_get_chip_count() == chips, "chip count", qspi_get_chip_count());
+    qspi_sim_check(qspi_get_mem_size() == (part->flash_size * chips),
+                   "memory size differs from flashDict", qspi_get_mem_size());
+    qspi_sim_check(erase_size == part->erase_size, "erase size differs from flashDict", erase_size);
+
+    /* The erased and programmed area, then a block read during the erase */
+    size = (qspi_sim_size < (qspi_get_mem_size() - erase_size)) ? qspi_sim_size :
+           (qspi_get_mem_size() - erase_size);
+    size -= size % erase_size;
+    span = size + erase_size;
+    data = malloc(span);
+    buf = malloc(span);
+    if ((0U == size) || (NULL == data) || (NULL == buf))
+    {
+        fprintf(stderr, "qspi_sim: size %u\n", size);
+        nor_sim_close();
+        return 2;
+    }
+
+    qspi_sim_pal(data, buf, span);
+    qspi_sim_async(data, buf, size);
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+    qspi_sim_rows(data, buf, size);
+#endif
+
+    /* Back up from the SFDP cache: the timing is tuned on the data, then
+     * the tuned timing is only checked
+     */
+    for (uint32_t i = 1U; (i < QSPI_SIM_INIT_NUM) && (st == CY_SMIF_SUCCESS); i++)
+    {
+        qspi_deinit(QSPI_SIM_SS_LINE);
+        st = qspi_sim_init(&qspi_sim_init_ns[i], &qspi_sim_init_sfdp_reads[i]);
+        qspi_sim_check(st == CY_SMIF_SUCCESS, qspi_sim_init_names[i], (uint32_t)st);
+    }
+    if (st == CY_SMIF_SUCCESS)
+    {
+        uint64_t start = nor_sim_time_ns();
+
+        st = qspi_read(0U, buf, span);
+        qspi_sim_phase("tuned_read", span, nor_sim_time_ns() - start);
+        qspi_sim_check((st == CY_SMIF_SUCCESS) && (0 == memcmp(nor_sim_contents(), buf, span)),
+                       "read back after the tuning mismatch", span);
+    }
+
+    qspi_sim_check(0U == nor_sim_stats()->violations, "model violations",
+                   (uint32_t)nor_sim_stats()->violations);
+
+    qspi_sim_print(part, size);
+    if ((NULL != qspi_sim_json) && (!qspi_sim_write_json(part, size)))
+    {
+        qspi_sim_errors++;
+    }
+
+    qspi_deinit(QSPI_SIM_SS_LINE);
+    nor_sim_close();
+    free(data);
+    free(buf);
+
+    return (0U == qspi_sim_errors) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,363 @@
+"""SPI NOR Flash Simulator Parts (flashDict to SFDP tables)
+Copyright (c) 2023 Infineon Technologies AG
+
+Writes the part table of the host SMIF simulator (see nor_sim.h): every part
+of flashDict in flashmap.py, with its flash size and erase size, completed
+with the datasheet parameters of its family below. Each part gets the SFDP
+tables it returns to the Read SFDP command: the JESD216B basic flash
+parameter table and, for parts above 16 MB, the 4-byte address instruction
+table.
+
+The family parameters are typical datasheet values, rounded. They set the
+busy times of the simulated part; the SFDP tables carry them as JESD216
+encodes them (rounded up, with a multiplier for the maximum).
+"""
+
+import os
+import sys
+import getopt
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                '..', '..', 'ubm_bootloader', 'scripts'))
+from flashmap import flashDict  # noqa: E402
+
+# Parameters of the part families, by flashDict name prefix. Times are
+# typical (busy time of the simulated part) and maximum, in us.
+FAMILIES = {
+    'FM25Q': {
+        'manufacturer': 0xA1, 'memory_type': 0x40,
+        'page': 256, 'program': (600, 2400), 'wrsr': 5000,
+        'erase': ((0x1000, 0x20, 45000, 300000),
+                  (0x8000, 0x52, 150000, 1000000),
+                  (0x10000, 0xD8, 250000, 1600000)),
+        'chip_erase_per_mb': 3000000,
+        'read_114': (0x6B, 8), 'read_144': (0xEB, 2, 4), 'program_114': True,
+        'suspend': (0x75, 0x7A, 30, 100),
+        'max_spi_mhz': 104, 't_v_ns': 7, 't_ho_ns': 1,
+    },
+    'FM25W': {
+        'manufacturer': 0xA1, 'memory_type': 0x28,
+        'page': 256, 'program': (700, 3000), 'wrsr': 8000,
+        'erase': ((0x1000, 0x20, 50000, 400000),
+                  (0x8000, 0x52, 160000, 1200000),
+                  (0x10000, 0xD8, 300000, 2000000)),
+        'chip_erase_per_mb': 3500000,
+        'read_114': (0x6B, 8), 'read_144': (0xEB, 2, 4), 'program_114': True,
+        'suspend': (0x75, 0x7A, 30, 100),
+        'max_spi_mhz': 80, 't_v_ns': 8, 't_ho_ns': 1,
+    },
+    'P25Q': {
+        'manufacturer': 0x85, 'memory_type': 0x60,
+        'page': 256, 'program': (500, 2000), 'wrsr': 8000,
+        'erase': ((0x1000, 0x20, 10000, 30000),
+                  (0x8000, 0x52, 10000, 30000),
+                  (0x10000, 0xD8, 10000, 30000)),
+        'chip_erase_per_mb': 80000,
+        'read_114': (0x6B, 8), 'read_144': (0xEB, 2, 4), 'program_114': True,
+        'suspend': (0x75, 0x7A, 20, 100),
+        'max_spi_mhz': 104, 't_v_ns': 7, 't_ho_ns': 1,
+    },
+    'S25HS': {
+        'manufacturer': 0x34, 'memory_type': 0x2B,
+        'page': 256, 'program': (400, 1600), 'wrsr': 20000,
+        'erase': ((0x40000, 0xD8, 930000, 3720000),),
+        'chip_erase_per_mb': 3750000,
+        'read_114': None, 'read_144': (0xEB, 2, 6), 'program_114': False,
+        'suspend': (0x75, 0x7A, 45, 100),
+        'max_spi_mhz': 166, 't_v_ns': 6, 't_ho_ns': 1,
+    },
+}
+
+# 4-byte address variants of the 3-byte opcodes
+OPCODE_4B = {0x03: 0x13, 0x0B: 0x0C, 0x6B: 0x6C, 0xEB: 0xEC,
+             0x02: 0x12, 0x32: 0x34,
+             0x20: 0x21, 0x52: 0x5C, 0xD8: 0xDC}
+
+SFDP_BFPT_PTR = 0x30
+SFDP_4BAIT_PTR = 0x70
+
+
+class CmdLineParams:
+    """Command line parameters"""
+
+    def __init__(self):
+        self.out_file = ''
+        self.list_parts = False
+
+        usage = 'USAGE:\n' + sys.argv[0] + \
+                ''' -o <nor_sim_parts.c> | -l
+
+OPTIONS:
+-h  --help       Display the usage information
+-o  --out=       Part table to write
+-l  --list       List the part names
+'''
+
+        try:
+            opts, unused = getopt.getopt(sys.argv[1:], 'ho:l',
+                                         ['help', 'out=', 'list'])
+            if len(unused) > 0:
+                print(usage, file=sys.stderr)
+                sys.exit(1)
+        except getopt.GetoptError:
+            print(usage, file=sys.stderr)
+            sys.exit(1)
+
+        for opt, arg in opts:
+            if opt in ('-h', '--help'):
+                print(usage, file=sys.stderr)
+                sys.exit()
+            elif opt in ('-o', '--out'):
+                self.out_file = arg
+            elif opt in ('-l', '--list'):
+                self.list_parts = True
+
+        if len(self.out_file) == 0 and not self.list_parts:
+            print(usage, file=sys.stderr)
+            sys.exit(1)
+
+
+def family(name):
+    """Return the family parameters of a flashDict part"""
+    for prefix, params in FAMILIES.items():
+        if name.startswith(prefix):
+            return params
+    print('No simulator parameters for', name, file=sys.stderr)
+    sys.exit(2)
+
+
+def log2(val):
+    """Exponent of a power of 2"""
+    assert val > 0 and (val & (val - 1)) == 0
+    return val.bit_length() - 1
+
+
+def encode_time(typ_us, units_us, bits):
+    """Count and unit index of a JESD216 time field, rounded up"""
+    for index, unit in enumerate(units_us):
+        count = (typ_us + unit - 1) // unit
+        if count <= (1 << bits):
+            return max(count, 1) - 1, index
+    return (1 << bits) - 1, len(units_us) - 1
+
+
+def encode_multiplier(typ_us, max_us):
+    """Multiplier field: maximum = 2 * (field + 1) * typical"""
+    field = (max_us + 2 * typ_us - 1) // (2 * typ_us) - 1
+    return min(max(field, 0), 15)
+
+
+def bfpt(params, flash_size):
+    """Basic flash parameter table (JESD216B), 16 DWORDs"""
+    erase = params['erase']
+    addr_4b = flash_size > 0x1000000
+    has_4k = erase[0][0] == 0x1000
+    dw = [0] * 16
+
+    dw[0] = (0x1FF << 23) | (1 << 2)
+    dw[0] |= (0x1 if has_4k else 0x3)
+    dw[0] |= (erase[0][1] if has_4k else 0xFF) << 8
+    dw[0] |= (1 << 17) if addr_4b else 0
+    if params['read_144'] is not None:
+        dw[0] |= 1 << 21
+    if params['read_114'] is not None:
+        dw[0] |= 1 << 22
+
+    dw[1] = flash_size * 8 - 1
+
+    if params['read_144'] is not None:
+        cmd, mode, dummy = params['read_144']
+        dw[2] |= dummy | (mode << 5) | (cmd << 8)
+    if params['read_114'] is not None:
+        cmd, dummy = params['read_114']
+        dw[2] |= (dummy << 16) | (cmd << 24)
+
+    dw[3] = 0
+    dw[4] = 0xFFFFFFEE
+    dw[5] = 0x0000FFFF
+    dw[6] = 0x0000FFFF
+
+    for i in range(4):
+        if i < len(erase):
+            size, cmd = erase[i][0], erase[i][1]
+            field = log2(size) | (cmd << 8)
+        else:
+            field = 0
+        dw[7 + i // 2] |= field << (16 * (i % 2))
+
+    dw[9] = encode_multiplier(erase[0][2], erase[0][3])
+    for i, (size, cmd, typ, unused) in enumerate(erase):
+        count, unit = encode_time(typ, (1000, 16000, 128000, 1000000), 5)
+        dw[9] |= (count | (unit << 5)) << (4 + 7 * i)
+
+    typ, max_us = params['program']
+    count, unit = encode_time(typ, (8, 64), 5)
+    dw[10] = encode_multiplier(typ, max_us)
+    dw[10] |= log2(params['page']) << 4
+    dw[10] |= (count | (unit << 5)) << 8
+    dw[10] |= (7 | (1 << 4)) << 14            # Byte program: 64 us first
+    dw[10] |= (1 | (0 << 4)) << 19            # 2 us additional
+    count, unit = encode_time(chip_erase_us(params, flash_size),
+                              (16000, 256000, 4000000, 64000000), 5)
+    dw[10] |= (count | (unit << 5)) << 24
+
+    suspend_cmd, resume_cmd, latency, interval = params['suspend']
+    count, unit = encode_time(latency * 1000, (128, 1000, 8000, 64000), 5)
+    interval_field = min((interval + 63) // 64 - 1, 15)
+    dw[11] = 0xEC | (1 << 8) | (interval_field << 9)
+    dw[11] |= (count | (unit << 5)) << 13
+    dw[11] |= interval_field << 20
+    dw[11] |= (count | (unit << 5)) << 24
+
+    dw[12] = (suspend_cmd << 24) | (resume_cmd << 16) | \
+             (suspend_cmd << 8) | resume_cmd
+
+    dw[13] = 0x3 | (0x1 << 2) | (0xAB << 15) | (0xB9 << 23) | (0x1 << 8)
+
+    dw[14] = 0x5 << 20                        # QE: bit 1 of SR2, 01h with 2 bytes
+
+    dw[15] = 0x10 << 8
+    if addr_4b:
+        dw[15] |= (0x01 << 24) | (0x001 << 14)
+
+    return dw
+
+
+def four_byte_table(params):
+    """4-byte address instruction table, 2 DWORDs"""
+    erase = params['erase']
+    dw = [0xFFFF0000, 0xFFFFFFFF]
+
+    dw[0] |= (1 << 0) | (1 << 1) | (1 << 6)
+    if params['read_114'] is not None:
+        dw[0] |= 1 << 4
+    if params['read_144'] is not None:
+        dw[0] |= 1 << 5
+    if params['program_114']:
+        dw[0] |= 1 << 7
+    for i, (size, cmd, unused, unused2) in enumerate(erase):
+        dw[0] |= 1 << (9 + i)
+        dw[1] &= ~(0xFF << (8 * i))
+        dw[1] |= OPCODE_4B[cmd] << (8 * i)
+
+    return dw
+
+
+def chip_erase_us(params, flash_size):
+    """Typical chip erase time"""
+    return max(params['chip_erase_per_mb'] * flash_size // 0x100000,
+               params['erase'][-1][2])
+
+
+def sfdp(params, flash_size):
+    """SFDP header, parameter headers and tables"""
+    tables = [(0x00, 0xFF, 6, 1, SFDP_BFPT_PTR, bfpt(params, flash_size))]
+    if flash_size > 0x1000000:
+        tables.append((0x84, 0xFF, 0, 1, SFDP_4BAIT_PTR,
+                       four_byte_table(params)))
+
+    data = bytearray(b'SFDP') + bytes([6, 1, len(tables) - 1, 0xFF])
+    for id_lsb, id_msb, minor, major, ptr, table in tables:
+        data += bytes([id_lsb, minor, major, len(table),
+                       ptr & 0xFF, (ptr >> 8) & 0xFF, ptr >> 16, id_msb])
+    for id_lsb, id_msb, minor, major, ptr, table in tables:
+        data += b'\xFF' * (ptr - len(data))
+        for dword in table:
+            data += (dword & 0xFFFFFFFF).to_bytes(4, 'little')
+    return data
+
+
+def c_bytes(data, indent):
+    """Byte array initializer, 12 bytes per line"""
+    lines = []
+    for i in range(0, len(data), 12):
+        lines.append(indent + ', '.join(f'0x{b:02X}U' for b in data[i:i + 12]))
+    return ',\n'.join(lines)
+
+
+def part_entry(name, params, flash):
+    """Initializer of one nor_sim_part_t"""
+    flash_size = flash['flashSize']
+    addr_4b = flash_size > 0x1000000
+    erase = params['erase']
+    suspend_cmd, resume_cmd, latency, interval = params['suspend']
+    read_114 = params['read_114'] or (0, 0)
+    read_144 = params['read_144'] or (0, 0, 0)
+    jedec = (params['manufacturer'], params['memory_type'], log2(flash_size))
+
+    erase_init = []
+    for i in range(4):
+        if i < len(erase):
+            size, cmd, typ, unused = erase[i]
+            erase_init.append(f'{{ 0x{size:X}UL, 0x{cmd:02X}U, '
+                              f'0x{OPCODE_4B[cmd]:02X}U, {typ}UL }}')
+        else:
+            erase_init.append('{ 0UL, 0U, 0U, 0UL }')
+
+    return f'''    {{
+        .name = "{name}",
+        .flash_size = 0x{flash_size:X}UL,
+        .erase_size = 0x{flash['eraseSize']:X}UL,
+        .jedec_id = {{ 0x{jedec[0]:02X}U, 0x{jedec[1]:02X}U, 0x{jedec[2]:02X}U }},
+        .page_size = {params['page']}UL,
+        .program_us = {params['program'][0]}UL,
+        .wrsr_us = {params['wrsr']}UL,
+        .chip_erase_us = {chip_erase_us(params, flash_size)}UL,
+        .erase = {{
+            {(',' + chr(10) + '            ').join(erase_init)}
+        }},
+        .read_114_cmd = 0x{read_114[0]:02X}U,
+        .read_114_dummy = {read_114[1]}U,
+        .read_144_cmd = 0x{read_144[0]:02X}U,
+        .read_144_mode = {read_144[1]}U,
+        .read_144_dummy = {read_144[2]}U,
+        .program_114 = {'true' if params['program_114'] else 'false'},
+        .addr_4b = {'true' if addr_4b else 'false'},
+        .suspend_cmd = 0x{suspend_cmd:02X}U,
+        .resume_cmd = 0x{resume_cmd:02X}U,
+        .suspend_us = {latency}UL,
+        .resume_interval_us = {interval}UL,
+        .max_spi_hz = {params['max_spi_mhz']}000000UL,
+        .t_v_ns = {params['t_v_ns']}UL,
+        .t_ho_ns = {params['t_ho_ns']}UL,
+        .sfdp = sfdp_{name},
+        .sfdp_size = sizeof(sfdp_{name}),
+    }}'''
+
+
+def main():
+    """Write the part table"""
+    params = CmdLineParams()
+
+    if params.list_parts:
+        print(' '.join(flashDict.keys()))
+        return
+
+    out = ['/* Generated by sfdp_gen.py from flashDict in flashmap.py, '
+           'do not edit */', '',
+           '#include "nor_sim.h"', '']
+    entries = []
+    for name, flash in flashDict.items():
+        fam = family(name)
+        table = sfdp(fam, flash['flashSize'])
+        out.append(f'static const uint8_t sfdp_{name}[] =')
+        out.append('{')
+        out.append(c_bytes(table, '    '))
+        out.append('};')
+        out.append('')
+        entries.append(part_entry(name, fam, flash))
+
+    out.append('const nor_sim_part_t nor_sim_parts[] =')
+    out.append('{')
+    out.append(',\n'.join(entries))
+    out.append('};')
+    out.append('')
+    out.append('const uint32_t nor_sim_part_count = '
+               'sizeof(nor_sim_parts) / sizeof(nor_sim_parts[0]);')
+
+    with open(params.out_file, 'w', encoding='UTF-8') as out_file:
+        out_file.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,185 @@
+"""SMIF Simulator Results Check
+Copyright (c) 2023 Infineon Technologies AG
+
+Collects the JSON results of qspi_sim runs into one file (-o), or compares
+such a file with the baseline (-r, -b) and fails on a regression:
+
+- a run missing from the results, a run with errors or model violations
+- a different SPI clock or read/program width than the baseline
+- a phase throughput lower, an init time or a read latency during erase
+  higher than the baseline by more than the tolerance
+
+The simulated time does not depend on the host, the tolerance only absorbs
+deliberate small changes. Improvements are listed; make baseline records
+them.
+"""
+
+import os
+import sys
+import json
+import getopt
+
+# Tolerance in percent
+TOLERANCE_DEFAULT = 2.0
+
+# Settings that must not change
+SETTINGS = ('size', 'spi_hz', 'read_width', 'program_width')
+
+
+class CmdLineParams:
+    """Command line parameters"""
+
+    def __init__(self):
+        self.out_file = ''
+        self.results_file = ''
+        self.baseline_file = ''
+        self.tolerance = TOLERANCE_DEFAULT
+        self.inputs = []
+
+        usage = 'USAGE:\n' + sys.argv[0] + \
+                ''' -o <results.json> <result.json>...
+''' + sys.argv[0] + ''' -r <results.json> -b <baseline.json> [-t <percent>]
+
+OPTIONS:
+-h  --help       Display the usage information
+-o  --out=       Results file to write from qspi_sim -j files
+-r  --results=   Results file to check
+-b  --baseline=  Baseline results file
+-t  --tolerance= Tolerance in percent (default 2)
+'''
+
+        try:
+            opts, self.inputs = getopt.getopt(sys.argv[1:], 'ho:r:b:t:',
+                                              ['help', 'out=', 'results=',
+                                               'baseline=', 'tolerance='])
+        except getopt.GetoptError:
+            print(usage, file=sys.stderr)
+            sys.exit(1)
+
+        for opt, arg in opts:
+            if opt in ('-h', '--help'):
+                print(usage, file=sys.stderr)
+                sys.exit()
+            elif opt in ('-o', '--out'):
+                self.out_file = arg
+            elif opt in ('-r', '--results'):
+                self.results_file = arg
+            elif opt in ('-b', '--baseline'):
+                self.baseline_file = arg
+            elif opt in ('-t', '--tolerance'):
+                self.tolerance = float(arg)
+
+        collect = len(self.out_file) > 0 and len(self.inputs) > 0
+        check = len(self.results_file) > 0 and len(self.baseline_file) > 0
+        if collect == check:
+            print(usage, file=sys.stderr)
+            sys.exit(1)
+
+
+def run_name(path):
+    """Run name of a qspi_sim -j file: its name without result_ and .json"""
+    name = os.path.splitext(os.path.basename(path))[0]
+    return name[len('result_'):] if name.startswith('result_') else name
+
+
+def collect(out_file, inputs):
+    """Write the runs of the qspi_sim -j files into one file"""
+    runs = {}
+    for path in sorted(inputs):
+        with open(path, 'r', encoding='UTF-8') as in_file:
+            runs[run_name(path)] = json.load(in_file)
+
+    with open(out_file, 'w', encoding='UTF-8') as out:
+        json.dump(runs, out, indent=2, sort_keys=True)
+        out.write('\n')
+
+
+def metrics(run):
+    """Measured values of a run: name -> (value, True if higher is better)"""
+    values = {}
+    for name, phase in run['phases'].items():
+        values[name + ' kB/s'] = (phase['kBps'], True)
+    for name, init in run['inits'].items():
+        values[name + ' us'] = (init['us'], False)
+    if run['erase_reads']['count'] > 0:
+        values['erase read max us'] = (run['erase_reads']['max_us'], False)
+    return values
+
+
+def check_run(name, run, base, tolerance):
+    """Regressions of a run against its baseline, and the improvements"""
+    failures = []
+    improvements = []
+
+    if run['errors'] != 0 or run['stats']['violations'] != 0:
+        failures.append(f'{run["errors"]} errors, '
+                        f'{run["stats"]["violations"]} violations')
+
+    for setting in SETTINGS:
+        if run[setting] != base[setting]:
+            failures.append(f'{setting} {run[setting]}, '
+                            f'baseline {base[setting]}')
+
+    values = metrics(run)
+    for metric, (base_value, higher_better) in metrics(base).items():
+        if metric not in values:
+            failures.append(f'{metric} missing')
+            continue
+        value = values[metric][0]
+        change = 100.0 * (value - base_value) / base_value \
+            if base_value != 0 else 0.0
+        if not higher_better:
+            change = -change
+        text = f'{metric} {value}, baseline {base_value} ({change:+.1f}%)'
+        if change < -tolerance:
+            failures.append(text)
+        elif change > tolerance:
+            improvements.append(text)
+
+    return [f'{name}: {text}' for text in failures], \
+        [f'{name}: {text}' for text in improvements]
+
+
+def check(results_file, baseline_file, tolerance):
+    """Compare the results with the baseline, exit 1 on a regression"""
+    with open(results_file, 'r', encoding='UTF-8') as in_file:
+        results = json.load(in_file)
+    with open(baseline_file, 'r', encoding='UTF-8') as in_file:
+        baseline = json.load(in_file)
+
+    failures = []
+    improvements = []
+    for name, base in sorted(baseline.items()):
+        if name not in results:
+            failures.append(f'{name}: missing from the results')
+            continue
+        run_failures, run_improvements = check_run(name, results[name],
+                                                   base, tolerance)
+        failures += run_failures
+        improvements += run_improvements
+
+    for name in sorted(set(results) - set(baseline)):
+        print(f'{name}: not in the baseline')
+
+    for text in improvements:
+        print('improved:', text)
+    for text in failures:
+        print('REGRESSION:', text, file=sys.stderr)
+
+    print(f'{len(baseline)} runs checked, {len(failures)} regressions')
+    if len(failures) > 0:
+        sys.exit(1)
+
+
+def main():
+    """Collect or check the results"""
+    params = CmdLineParams()
+
+    if len(params.out_file) > 0:
+        collect(params.out_file, params.inputs)
+    else:
+        check(params.results_file, params.baseline_file, params.tolerance)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,220 @@
+/******************************************************************************
+* File Name:   change_detect.c
+*
+* Description: Coalescing of the CHANGE_DETECT# signals, see change_detect.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#include <string.h>
+#include "cy_pdl.h"
+#include "cyhal.h"
+#include "change_detect.h"
+#include "ubm_log.h"
+#include "clock_governor.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of HFCs in the control signals given to mtb_ubm_init() */
+#define CHANGE_DETECT_HFC_NUM \
+    (sizeof(((mtb_stc_ubm_backplane_control_signals_t *)NULL)->hfc_io) / \
+     sizeof(((mtb_stc_ubm_backplane_control_signals_t *)NULL)->hfc_io[0]))
+
+#define CHANGE_DETECT_CYCLES_PER_US         (SystemCoreClock / 1000000UL)
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef struct
+{
+    GPIO_PRT_Type *port;
+    uint32_t pin;
+    uint32_t drive_mode;        /* As set by the middleware */
+    bool requested;             /* Output written low by the middleware */
+    bool driven;                /* Pin driven by drive_mode */
+    bool holdoff;               /* In the window after a host clear */
+    uint32_t request_stamp;
+    uint32_t assert_stamp;
+    uint32_t clear_stamp;
+    change_detect_stats_t stats;
+} change_detect_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static change_detect_t change_detect[CHANGE_DETECT_MAX_HFC];
+static uint32_t change_detect_count;
+static uint32_t window_cycles;
+
+/*******************************************************************************
+* Function Name: change_detect_init
+********************************************************************************
+* Summary:
+*  Takes over the drive of the CHANGE_DETECT# pins, called after
+*  mtb_ubm_init() has configured them. The pins are released until the
+*  middleware requests an assertion.
+*
+* Parameters:
+*  signals - Control signals given to mtb_ubm_init()
+*
+*******************************************************************************/
+void change_detect_init(const mtb_stc_ubm_backplane_control_signals_t *signals)
+{
+    _Static_assert(CHANGE_DETECT_HFC_NUM <= CHANGE_DETECT_MAX_HFC,
+                   "CHANGE_DETECT_MAX_HFC is less than the HFCs of the middleware");
+
+    if (0UL == CHANGE_DETECT_WINDOW_US)
+    {
+        return;
+    }
+
+    window_cycles = CHANGE_DETECT_WINDOW_US * CHANGE_DETECT_CYCLES_PER_US;
+
+    for (uint32_t i = 0UL; i < CHANGE_DETECT_HFC_NUM; i++)
+    {
+        change_detect_t *cd = &change_detect[i];
+        cyhal_gpio_t pin = signals->hfc_io[i].change_detect;
+
+        if (NC == pin)
+        {
+            continue;
+        }
+
+        (void)memset(cd, 0, sizeof(*cd));
+        cd->port = CYHAL_GET_PORTADDR(pin);
+        cd->pin = CYHAL_GET_PIN(pin);
+        cd->drive_mode = Cy_GPIO_GetDrivemode(cd->port, cd->pin);
+        Cy_GPIO_SetDrivemode(cd->port, cd->pin, CY_GPIO_DM_HIGHZ);
+        change_detect_count = i + 1UL;
+    }
+}
+
+/*******************************************************************************
+* Function Name: change_detect_poll
+********************************************************************************
+* Summary:
+*  Follows the output written by the middleware and drives the pins. Called
+*  from the main loop, which bounds the assert latency.
+*
+*******************************************************************************/
+void change_detect_poll(void)
+{
+    for (uint32_t i = 0UL; i < change_detect_count; i++)
+    {
+        change_detect_t *cd = &change_detect[i];
+        uint32_t now;
+        bool request;
+
+        if (NULL == cd->port)
+        {
+            continue;
+        }
+
+        now = clock_governor_cycles();
+        request = (0UL == Cy_GPIO_ReadOut(cd->port, cd->pin));
+
+        if (request && !cd->requested)
+        {
+            cd->requested = true;
+            cd->request_stamp = now;
+            if (cd->holdoff)
+            {
+                cd->stats.coalesced++;
+            }
+        }
+        else if (!request && cd->requested)
+        {
+            /* Host clear: release the pin and start the window */
+            cd->requested = false;
+            if (cd->driven)
+            {
+                uint32_t clear_us = (now - cd->assert_stamp) / CHANGE_DETECT_CYCLES_PER_US;
+
+                Cy_GPIO_SetDrivemode(cd->port, cd->pin, CY_GPIO_DM_HIGHZ);
+                cd->driven = false;
+                cd->holdoff = true;
+                cd->clear_stamp = now;
+                if (clear_us > cd->stats.clear_max_us)
+                {
+                    cd->stats.clear_max_us = clear_us;
+                }
+                UBM_LOG("change_detect: HFC %u cleared after %u us", i, clear_us);
+            }
+        }
+        else
+        {
+            /* No change of the request */
+        }
+
+        if (cd->holdoff && ((now - cd->clear_stamp) >= window_cycles))
+        {
+            cd->holdoff = false;
+        }
+
+        if (cd->requested && !cd->driven && !cd->holdoff)
+        {
+            uint32_t assert_us = (now - cd->request_stamp) / CHANGE_DETECT_CYCLES_PER_US;
+
+            Cy_GPIO_SetDrivemode(cd->port, cd->pin, cd->drive_mode);
+            cd->driven = true;
+            cd->assert_stamp = now;
+            cd->stats.asserts++;
+            if (assert_us > cd->stats.assert_max_us)
+            {
+                cd->stats.assert_max_us = assert_us;
+            }
+            UBM_LOG("change_detect: HFC %u asserted after %u us", i, assert_us);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: change_detect_pending
+********************************************************************************
+* Summary:
+*  Tells whether a request is held in its window, in which case the main loop
+*  has to keep polling.
+*
+* Return:
+*  bool - True if an assertion is waiting for the end of a window
+*
+*******************************************************************************/
+bool change_detect_pending(void)
+{
+    for (uint32_t i = 0UL; i < change_detect_count; i++)
+    {
+        if (change_detect[i].requested && !change_detect[i].driven)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+* Function Name: change_detect_get_stats
+********************************************************************************
+* Summary:
+*  Returns the counters and the latencies of one HFC.
+*
+* Parameters:
+*  hfc   - HFC index, as in hfc_io of the control signals
+*  stats - Filled in with the statistics, zero if the HFC is not handled
+*
+*******************************************************************************/
+void change_detect_get_stats(uint32_t hfc, change_detect_stats_t *stats)
+{
+    if (hfc < change_detect_count)
+    {
+        *stats = change_detect[hfc].stats;
+    }
+    else
+    {
+        (void)memset(stats, 0, sizeof(*stats));
+    }
+}
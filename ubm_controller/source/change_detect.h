@@ -0,0 +1,66 @@
+/******************************************************************************
+* File Name:   change_detect.h
+*
+* Description: Coalescing of the CHANGE_DETECT# signals of the HFCs.
+*
+*              The UBM middleware writes the output of a CHANGE_DETECT# pin
+*              each time the state of a DFC changes, and releases it when the
+*              host has read the change. During a mass insertion this gives
+*              the hosts an interrupt per DFC event. Here the middleware keeps
+*              writing the output register, and the pin is only driven while
+*              this engine allows it: the first request is passed on at the
+*              next poll of the main loop, and after a host clear the pin is
+*              held released for CHANGE_DETECT_WINDOW_US, so that the changes
+*              in that window give one assertion. The change counts are kept
+*              by the middleware and not affected.
+*
+*              The assert latency (request to pin driven) and the host clear
+*              latency (pin driven to host clear) are logged and their maximum
+*              kept per HFC.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(CHANGE_DETECT_H)
+#define CHANGE_DETECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mtb_ubm.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Time the pin stays released after a host clear, 0 to leave the pins to
+ * the middleware. Set with CHANGE_DETECT_WINDOW_US in the Makefile.
+ */
+#ifndef CHANGE_DETECT_WINDOW_US
+#define CHANGE_DETECT_WINDOW_US             (0UL)
+#endif
+
+/* Number of HFCs handled */
+#define CHANGE_DETECT_MAX_HFC               (4U)
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef struct
+{
+    uint32_t asserts;           /* Assertions of the pin */
+    uint32_t coalesced;         /* Requests held in the window */
+    uint32_t assert_max_us;     /* Longest request to assertion time */
+    uint32_t clear_max_us;      /* Longest assertion to host clear time */
+} change_detect_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void change_detect_init(const mtb_stc_ubm_backplane_control_signals_t *signals);
+void change_detect_poll(void);
+bool change_detect_pending(void);
+void change_detect_get_stats(uint32_t hfc, change_detect_stats_t *stats);
+
+#endif /* CHANGE_DETECT_H */
@@ -0,0 +1,206 @@
+/******************************************************************************
+* File Name:   clock_governor.c
+*
+* Description: CM4 clock scaling of the UBM controller application, see
+*              clock_governor.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "clock_governor.h"
+#include "ubm_log.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define CLOCK_GOVERNOR_CYCLES_PER_US        (SystemCoreClock / 1000000UL)
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static bool governor_enabled;
+static uint8_t full_divider;        /* clk_fast divider set by the BSP */
+static uint8_t idle_divider;
+static uint32_t hold_cycles;
+static uint32_t last_active;
+static uint32_t last_stamp;
+static uint32_t last_report;
+static uint32_t report_cycles;
+static uint32_t cycles_offset;      /* Cycles missed while slowed down */
+static clock_governor_stats_t governor_stats;
+
+/*******************************************************************************
+* Function Name: clock_governor_init
+********************************************************************************
+* Summary:
+*  Records the full speed clk_fast divider. Called once the clocks are set up,
+*  after the DWT cycle counter is enabled by ubm_log_init().
+*
+*******************************************************************************/
+void clock_governor_init(void)
+{
+    full_divider = Cy_SysClk_ClkFastGetDivider();
+
+    if (((full_divider + 1UL) * CLOCK_GOVERNOR_SLOWDOWN) > 256UL)
+    {
+        return;
+    }
+
+    idle_divider = (uint8_t)(((full_divider + 1UL) * CLOCK_GOVERNOR_SLOWDOWN) - 1UL);
+    hold_cycles = CLOCK_GOVERNOR_HOLD_US * CLOCK_GOVERNOR_CYCLES_PER_US;
+    report_cycles = CLOCK_GOVERNOR_REPORT_MS * 1000UL * CLOCK_GOVERNOR_CYCLES_PER_US;
+    last_active = DWT->CYCCNT;
+    last_stamp = last_active;
+    last_report = last_active;
+    governor_enabled = true;
+}
+
+/*******************************************************************************
+* Function Name: clock_governor_report
+********************************************************************************
+* Summary:
+*  Logs the share of time slowed down, in 1/1000, and the longest wake to
+*  full speed time since clock_governor_init().
+*
+*******************************************************************************/
+static void clock_governor_report(void)
+{
+    clock_governor_stats_t stats;
+    uint32_t idle_permille = 0UL;
+
+    clock_governor_get_stats(&stats);
+
+    if (0UL != stats.total_cycles)
+    {
+        idle_permille = (uint32_t)((stats.idle_cycles * 1000UL) / stats.total_cycles);
+    }
+
+    UBM_LOG("governor: idle %u/1000, wake max %u ns", idle_permille, stats.wake_max_ns);
+}
+
+/*******************************************************************************
+* Function Name: clock_governor_idle
+********************************************************************************
+* Summary:
+*  Called at the end of each pass of the main loop. Runs the CPU slowed down
+*  until an interrupt is pending, if nothing was busy for
+*  CLOCK_GOVERNOR_HOLD_US.
+*
+* Parameters:
+*  busy - The main loop has work in progress and needs the full speed
+*
+*******************************************************************************/
+void clock_governor_idle(bool busy)
+{
+    uint32_t now = clock_governor_cycles();
+    uint32_t saved;
+    uint32_t enter;
+    uint32_t seen;
+    uint32_t done;
+    uint32_t wake_ns;
+
+    if (!governor_enabled)
+    {
+        return;
+    }
+
+    governor_stats.total_cycles += now - last_stamp;
+    last_stamp = now;
+
+    if ((now - last_report) >= report_cycles)
+    {
+        clock_governor_report();
+        last_report = now;
+    }
+
+    if (busy)
+    {
+        last_active = now;
+        return;
+    }
+
+    if ((now - last_active) < hold_cycles)
+    {
+        return;
+    }
+
+    saved = Cy_SysLib_EnterCriticalSection();
+
+    Cy_SysClk_ClkFastSetDivider(idle_divider);
+    enter = DWT->CYCCNT;
+
+    /* VECTPENDING is not masked by PRIMASK */
+    while (0UL == (SCB->ICSR & SCB_ICSR_VECTPENDING_Msk))
+    {
+    }
+
+    seen = DWT->CYCCNT;
+    Cy_SysClk_ClkFastSetDivider(full_divider);
+    done = DWT->CYCCNT;
+
+    /* Count the slow period in full speed cycles */
+    cycles_offset += (done - enter) * (CLOCK_GOVERNOR_SLOWDOWN - 1UL);
+
+    Cy_SysLib_ExitCriticalSection(saved);
+
+    now = clock_governor_cycles();
+    governor_stats.idle_count++;
+    governor_stats.idle_cycles += (uint64_t)(done - enter) * CLOCK_GOVERNOR_SLOWDOWN;
+    governor_stats.total_cycles += now - last_stamp;
+    last_stamp = now;
+    last_active = now;
+
+    wake_ns = ((done - seen) * CLOCK_GOVERNOR_SLOWDOWN * 1000UL) / CLOCK_GOVERNOR_CYCLES_PER_US;
+    if (wake_ns > governor_stats.wake_max_ns)
+    {
+        governor_stats.wake_max_ns = wake_ns;
+        UBM_LOG("governor: wake to full speed %u ns", wake_ns);
+
+        if (wake_ns > (CLOCK_GOVERNOR_BUDGET_US * 1000UL))
+        {
+            governor_enabled = false;
+            UBM_LOG("governor: stopped, over the %u us budget", CLOCK_GOVERNOR_BUDGET_US);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: clock_governor_get_stats
+********************************************************************************
+* Summary:
+*  Returns the time spent slowed down, to be weighed with the current
+*  consumption of the device at both clocks, and the longest wake time.
+*
+* Parameters:
+*  stats - Filled in with the statistics
+*
+*******************************************************************************/
+void clock_governor_get_stats(clock_governor_stats_t *stats)
+{
+    uint32_t saved = Cy_SysLib_EnterCriticalSection();
+
+    *stats = governor_stats;
+
+    Cy_SysLib_ExitCriticalSection(saved);
+}
+
+/*******************************************************************************
+* Function Name: clock_governor_cycles
+********************************************************************************
+* Summary:
+*  Returns the DWT cycle count corrected for the slow periods, in full speed
+*  cycles. The offset only changes with the interrupts masked, so the result
+*  is consistent in interrupts as well.
+*
+* Return:
+*  uint32_t - Cycle count, wraps like DWT->CYCCNT
+*
+*******************************************************************************/
+uint32_t clock_governor_cycles(void)
+{
+    return DWT->CYCCNT + cycles_offset;
+}
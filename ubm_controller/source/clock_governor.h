@@ -0,0 +1,91 @@
+/******************************************************************************
+* File Name:   clock_governor.h
+*
+* Description: CM4 clock scaling of the UBM controller application.
+*
+*              The controller is idle most of the time: the 2-wire commands
+*              and the DFC signals are handled in interrupts. When the main
+*              loop has nothing to do for CLOCK_GOVERNOR_HOLD_US, the clk_fast
+*              divider is multiplied by CLOCK_GOVERNOR_SLOWDOWN with the
+*              interrupts masked (PRIMASK), and the CPU polls for a pending
+*              interrupt. Any interrupt, 2-wire address match or GPIO edge,
+*              restores the full speed divider before its handler runs. Only
+*              clk_fast is changed: clk_peri, and with it the SCB and the
+*              other peripherals, keep their clocks.
+*
+*              The CPU does not sleep (WFI), so the DWT cycle counter keeps
+*              running, at the slow rate. The cycles missed while slowed
+*              down are kept in an offset: clock_governor_cycles() gives the
+*              corrected count used by the log and change_detect.c. DWT
+*              itself is never written, for the debugger and the other users.
+*
+*              The time from the pending interrupt being seen to the full
+*              speed, which adds to the SMBus clock stretching of the
+*              2-wire slave, is measured. If it ever exceeds
+*              CLOCK_GOVERNOR_BUDGET_US, the governor stops. The share of
+*              time slowed down and the longest wake time are logged every
+*              CLOCK_GOVERNOR_REPORT_MS.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(CLOCK_GOVERNOR_H)
+#define CLOCK_GOVERNOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* CM4 clock reduction when idle. The resulting clk_fast divider is at most
+ * 256, the governor is off otherwise.
+ */
+#ifndef CLOCK_GOVERNOR_SLOWDOWN
+#define CLOCK_GOVERNOR_SLOWDOWN             (16UL)
+#endif
+
+/* Time at full speed after an interrupt or a busy main loop */
+#ifndef CLOCK_GOVERNOR_HOLD_US
+#define CLOCK_GOVERNOR_HOLD_US              (1000UL)
+#endif
+
+/* Longest wake to full speed time allowed, a small part of the 25 ms SMBus
+ * clock low extension of the slave
+ */
+#ifndef CLOCK_GOVERNOR_BUDGET_US
+#define CLOCK_GOVERNOR_BUDGET_US            (100UL)
+#endif
+
+/* Period of the statistics log records */
+#ifndef CLOCK_GOVERNOR_REPORT_MS
+#define CLOCK_GOVERNOR_REPORT_MS            (60000UL)
+#endif
+
+#if (CLOCK_GOVERNOR_SLOWDOWN < 2UL) || (CLOCK_GOVERNOR_SLOWDOWN > 256UL)
+#error "CLOCK_GOVERNOR_SLOWDOWN must be 2 to 256"
+#endif
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef struct
+{
+    uint32_t idle_count;            /* Slow periods */
+    uint64_t idle_cycles;           /* Time slowed down, in full speed cycles */
+    uint64_t total_cycles;          /* Time since clock_governor_init() */
+    uint32_t wake_max_ns;           /* Longest wake to full speed time */
+} clock_governor_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void clock_governor_init(void);
+void clock_governor_idle(bool busy);
+void clock_governor_get_stats(clock_governor_stats_t *stats);
+uint32_t clock_governor_cycles(void);
+
+#endif /* CLOCK_GOVERNOR_H */
@@ -11,13 +11,109 @@
 *******************************************************************************/
 
 #include "cy_pdl.h"
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 #include "flash_qspi.h"
+#include "flash_qspi_ext.h"
 
 #define CY_SMIF_SYSCLK_HFCLK_DIVIDER     CY_SYSCLK_CLKHF_DIVIDE_BY_2
 
+/* Highest SMIF interface clock (clk_hf[2]) tried by the auto-tuning, the
+ * SPI clock is half of it. The basic SFDP table has no clock limit, so the
+ * read-back calibration decides below this ceiling.
+ */
+#ifndef CY_SMIF_CLK_HF_MAX_HZ
+#define CY_SMIF_CLK_HF_MAX_HZ            (100000000UL)
+#endif
+
 #define CY_SMIF_INIT_TRY_COUNT           (10U)
+/* Delay between init attempts, doubled after each failed attempt */
+#define CY_SMIF_INIT_RETRY_DELAY_MIN_MS  (10U)
+#define CY_SMIF_INIT_RETRY_DELAY_MAX_MS  (500U)
 #define CY_CHECK_MEMORY_AVAILABILITY_DELAY_US (1000U)
+/* Bounds of the ready polling delay derived from the SFDP program time */
+#define CY_CHECK_MEMORY_AVAILABILITY_DELAY_MIN_US (10U)
+
+/* Fractions of the SFDP maximum operation time after which an asynchronous
+ * operation is first polled and then polled again. The maximum is usually
+ * several times the typical time.
+ */
+#define QSPI_ASYNC_FIRST_POLL_DIV        (8UL)
+#define QSPI_ASYNC_POLL_DIV              (32UL)
+
+/* DataWire channel used for bulk reads of the memory-mapped window. Override
+ * QSPI_DMA_HW, QSPI_DMA_CHANNEL and QSPI_DMA_TRIGGER (its software trigger
+ * line) if the channel is used elsewhere. Without them reads use the CPU.
+ */
+#if !defined(QSPI_DMA_CHANNEL) && defined(TRIG_OUT_MUX_0_PDMA0_TR_IN15)
+#define QSPI_DMA_HW                      DW0
+#define QSPI_DMA_CHANNEL                 (15UL)
+#define QSPI_DMA_TRIGGER                 (TRIG_OUT_MUX_0_PDMA0_TR_IN15)
+#endif
+
+/* One DMA descriptor moves up to QSPI_DMA_X_COUNT x QSPI_DMA_Y_COUNT_MAX bytes */
+#define QSPI_DMA_X_COUNT                 (256UL)
+#define QSPI_DMA_Y_COUNT_MAX             (256UL)
+
+/* Timeout of the status register write that sets the QE bit. The write is
+ * nonvolatile and takes tens of milliseconds on some parts; a part still
+ * busy after the timeout would ignore the commands that follow.
+ */
+#define QSPI_QE_WRITE_TIMEOUT_US         (100000UL)
+
+/* Single-width fallback commands, 3- and 4-byte address variants */
+#define QSPI_READ_CMD                    (0x03U)
+#define QSPI_READ_4B_CMD                 (0x13U)
+#define QSPI_PROGRAM_CMD                 (0x02U)
+#define QSPI_PROGRAM_4B_CMD              (0x12U)
+
+/* Read JEDEC ID command and the number of ID bytes that identify a part */
+#define QSPI_READ_JEDEC_ID_CMD           (0x9FU)
+#define QSPI_JEDEC_ID_SIZE               (3U)
+
+/* Read SFDP command and the location of the erase suspend fields: DWORDs 12
+ * and 13 of the basic flash parameter table (JESD216B and later).
+ */
+#define QSPI_READ_SFDP_CMD               (0x5AU)
+#define QSPI_READ_SFDP_DUMMY_CYCLES      (8U)
+#define QSPI_SFDP_HEADER_SIZE            (16U)
+#define QSPI_SFDP_BFPT_SUSPEND_DWORD     (12U)
+#define QSPI_SFDP_BFPT_SUSPEND_SIZE      (8U)
+
+/* Number of identical chips on consecutive slave select lines that form the
+ * external flash. They are concatenated into one memory: chip N starts at
+ * N x (size of one chip), both for the memory-mapped window and for the
+ * flash PAL accesses (see the Cy_SMIF_Mem* wrappers below).
+ */
+#ifndef CY_BOOT_EXT_FLASH_CHIPS
+#define CY_BOOT_EXT_FLASH_CHIPS          (1U)
+#endif
+#define QSPI_CHIP_NUM_MAX                (SMIF_CHIP_TOP_SPI_SEL_NR)
+
+#ifdef CY_SMIF_AUTO_TUNE
+/* Read-back calibration: SFDP bytes and array bytes compared with a read at
+ * the default timing, and the size read to measure the bandwidth. The array
+ * bytes are taken from the first of QSPI_TUNE_SCAN_NUM sectors whose data
+ * toggles every data line; erased or blank data reads back the same at any
+ * sampling point.
+ */
+#define QSPI_TUNE_SFDP_SIZE              (64U)
+#define QSPI_TUNE_SFDP_SIGNATURE         (0x50444653UL)
+#define QSPI_TUNE_DATA_SIZE              (256U)
+#define QSPI_TUNE_SCAN_NUM               (16U)
+#define QSPI_TUNE_BW_REPEAT              (8U)
+#define QSPI_TUNE_DIV_NUM                (4U)
+#define QSPI_TUNE_RX_NUM                 (4U)
+#endif
+
+#ifdef CY_SMIF_USE_SFDP_CACHE
+#define QSPI_SFDP_CACHE_MAGIC            (0x53464450UL)
+#define QSPI_SFDP_CACHE_CMD_NUM          (9U)
+#endif
+
+/* Marks the SMIF timing handed over from the bootloader as valid */
+#define QSPI_TIMING_MAGIC                (0x514D4954UL)
 
 /* This is the board specific stuff that should align with your board.
  *
@@ -146,11 +242,16 @@ cy_stc_smif_mem_config_t mem_sfdp_0 =
 };
 
 
-cy_stc_smif_mem_config_t *mems_sfdp[1] =
+/* Memory configurations of the chips after the first one */
+static cy_stc_smif_mem_config_t mem_sfdp_chip[QSPI_CHIP_NUM_MAX - 1U];
+
+cy_stc_smif_mem_config_t *mems_sfdp[QSPI_CHIP_NUM_MAX] =
 {
     &mem_sfdp_0
 };
 
+static uint32_t qspi_chip_count = 1U;
+
 cy_stc_smif_block_config_t smifBlockConfig_sfdp =
 {
     .memCount = 1,
@@ -159,6 +260,141 @@ cy_stc_smif_block_config_t smifBlockConfig_sfdp =
 
 static cy_stc_smif_block_config_t *smif_blk_config;
 
+/* Erase suspend parameters of the part, read from SFDP */
+typedef struct
+{
+    uint8_t suspend_cmd;                /* 0 if the part cannot suspend an erase */
+    uint8_t resume_cmd;
+    uint16_t reserved;
+    uint32_t latency_us;                /* Suspend command to ready */
+    uint32_t resume_interval_us;        /* Minimum time from resume to the next suspend */
+} qspi_suspend_info_t;
+
+static qspi_suspend_info_t qspi_suspend_info;
+
+#ifdef CY_SMIF_USE_SFDP_CACHE
+/* SFDP parameters of the last detected part, kept in an internal flash row.
+ * Only the values Cy_SMIF_MemSfdpDetect() fills in are stored; the pointers
+ * of dev_sfdp_0 always refer to the command structures of this file.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t size;                      /* sizeof() of the record, guards layout changes */
+    uint8_t jedec_id[QSPI_JEDEC_ID_SIZE];
+    uint8_t reserved;
+    uint32_t numOfAddrBytes;
+    uint32_t memSize;
+    uint32_t eraseSize;
+    uint32_t programSize;
+    uint32_t stsRegBusyMask;
+    uint32_t stsRegQuadEnableMask;
+    uint32_t eraseTime;
+    uint32_t chipEraseTime;
+    uint32_t programTime;
+    cy_stc_smif_mem_cmd_t cmd[QSPI_SFDP_CACHE_CMD_NUM];
+    qspi_suspend_info_t suspend;
+    uint8_t clk_div;                    /* Tuned clk_hf[2] divider */
+    uint8_t rx_clock_sel;               /* Tuned RX sampling clock */
+    uint8_t tuned;                      /* Timing found by a calibration, not the default */
+    uint8_t reserved2;
+    uint32_t tune_addr;                 /* Calibration pattern, re-read to check the timing */
+    uint32_t checksum;                  /* Checksum of the fields above */
+} qspi_sfdp_cache_t;
+
+CY_SECTION(".cy_boot_data") CY_ALIGN(CY_FLASH_SIZEOF_ROW)
+static const uint8_t qspi_sfdp_cache_row[CY_FLASH_SIZEOF_ROW] = { 0U };
+
+/* The row is written with Cy_Flash_WriteRow(), so it is read through a
+ * volatile pointer: reads of the array itself are folded to its initializer.
+ */
+static const uint8_t * volatile const qspi_sfdp_cache_data = qspi_sfdp_cache_row;
+#endif
+
+/* SMIF timing set by qspi_init_hardware(). Tuned by qspi_tune() in the
+ * bootloader, which hands it over to the application in the boot_shared RAM.
+ */
+static cy_en_clkhf_dividers_t qspi_tuned_div = CY_SMIF_SYSCLK_HFCLK_DIVIDER;
+static uint32_t qspi_tuned_rx_sel = (uint32_t)CY_SMIF_SEL_INV_INTERNAL_CLK;
+#if defined(CY_SMIF_AUTO_TUNE) || defined(CY_SMIF_USE_SFDP_CACHE)
+static bool qspi_tuned;
+static uint32_t qspi_tune_addr;
+#endif
+
+/* Placed after the boot timing record by both linker scripts */
+typedef struct
+{
+    uint32_t magic;                     /* QSPI_TIMING_MAGIC when valid */
+    uint32_t path_hz;                   /* Clock path of clk_hf[2] the timing is for */
+    uint8_t clk_div;
+    uint8_t rx_clock_sel;
+    uint16_t reserved;
+} qspi_shared_timing_t;
+
+CY_SECTION(".boot_shared.qspi") static qspi_shared_timing_t qspi_shared_timing;
+
+#ifdef CY_SMIF_AUTO_TUNE
+/* Outcome of every setting tried by the last calibration, for inspection */
+static qspi_tune_result_t qspi_tune_results[QSPI_TUNE_DIV_NUM * QSPI_TUNE_RX_NUM];
+static uint32_t qspi_tune_result_count;
+#endif
+
+/* JEDEC ID of the first chip */
+static uint8_t qspi_jedec_id[QSPI_JEDEC_ID_SIZE];
+
+/* Bulk read in progress, see qspi_read_start() */
+static struct
+{
+    bool busy;
+    uint8_t *data;
+    uint32_t address;
+    uint32_t len;
+    uint32_t done;                      /* Bytes already copied */
+    uint32_t chunk;                     /* Bytes moved by the running DMA descriptor */
+    bool suspending;                    /* Waiting for the erase suspend to take effect */
+    cy_en_smif_mode_t prev_mode;
+} qspi_read_job;
+
+#ifdef QSPI_DMA_CHANNEL
+static cy_stc_dma_descriptor_t qspi_dma_descr;
+#endif
+
+/* Erase or program in progress, see qspi_erase_start() */
+typedef enum
+{
+    QSPI_ASYNC_NONE,
+    QSPI_ASYNC_ERASE,
+    QSPI_ASYNC_PROGRAM,
+} qspi_async_op_t;
+
+static struct
+{
+    qspi_async_op_t op;
+    uint32_t address;                   /* Program: next page to start */
+    uint32_t end;
+    const uint8_t *data;
+    uint32_t chip;                      /* Program: chip of the running page */
+    uint32_t chip_next[QSPI_CHIP_NUM_MAX];  /* Erase: next sector of each chip */
+    uint32_t chip_end[QSPI_CHIP_NUM_MAX];
+    uint32_t chip_busy;                 /* Erase: mask of chips erasing a sector */
+    uint32_t chip_suspended;            /* Erase: mask of chips with a suspended sector */
+    uint32_t suspend_depth;             /* Nesting of qspi_erase_suspend() calls */
+    bool suspend_pending;               /* Erase: suspend requested, not in effect yet */
+    bool suspend_failed;                /* Erase: suspend command failed, sectors run out */
+    uint32_t resume_time;               /* DWT cycle count of the last resume */
+    uint32_t next_poll;                 /* DWT cycle count of the next status poll */
+    uint32_t poll_cycles;
+    cy_en_smif_status_t status;
+    qspi_op_callback_t callback;
+    void *callback_arg;
+} qspi_async;
+
+/* Deferred initialization state, see qspi_defer_init() */
+static uint32_t qspi_deferred_smif_id;
+static qspi_init_callback_t qspi_init_callback;
+static bool qspi_init_attempted;
+static cy_en_smif_status_t qspi_init_status = CY_SMIF_BAD_PARAM;
+
 static cy_stc_smif_context_t QSPI_context;
 
 static cy_stc_smif_config_t const QSPI_config =
@@ -291,6 +527,15 @@ cy_en_smif_status_t qspi_init_hardware(void)
 {
     cy_en_smif_status_t st;
 
+#ifndef CY_SMIF_AUTO_TUNE
+    /* Use the timing the bootloader calibrated for the part during this boot */
+    if ((QSPI_TIMING_MAGIC == qspi_shared_timing.magic) &&
+        (Cy_SysClk_ClkPathGetFrequency(CY_SYSCLK_CLKHF_IN_CLKPATH0) == qspi_shared_timing.path_hz))
+    {
+        qspi_tuned_div = (cy_en_clkhf_dividers_t)qspi_shared_timing.clk_div;
+        qspi_tuned_rx_sel = qspi_shared_timing.rx_clock_sel;
+    }
+#endif
 
     (void)Cy_GPIO_Pin_Init(D3Port, D3Pin, &QSPI_DATA3_config);
     Cy_GPIO_SetHSIOM(D3Port, D3Pin, D3MuxPort);
@@ -308,7 +553,7 @@ cy_en_smif_status_t qspi_init_hardware(void)
     Cy_GPIO_SetHSIOM(SCKPort, SCKPin, SCKMuxPort);
 
     (void)Cy_SysClk_ClkHfSetSource(CY_SYSCLK_CLKHF_IN_CLKPATH2, CY_SYSCLK_CLKHF_IN_CLKPATH0);
-    (void)Cy_SysClk_ClkHfSetDivider(CY_SYSCLK_CLKHF_IN_CLKPATH2, CY_SMIF_SYSCLK_HFCLK_DIVIDER);
+    (void)Cy_SysClk_ClkHfSetDivider(CY_SYSCLK_CLKHF_IN_CLKPATH2, qspi_tuned_div);
     (void)Cy_SysClk_ClkHfEnable(CY_SYSCLK_CLKHF_IN_CLKPATH2);
 
     /*
@@ -325,6 +570,9 @@ cy_en_smif_status_t qspi_init_hardware(void)
         return st;
     }
 
+    /* The block is still disabled, the RX clock can be switched */
+    SMIF_CTL(QSPIPort) = _CLR_SET_FLD32U(SMIF_CTL(QSPIPort), SMIF_CTL_CLOCK_IF_RX_SEL, qspi_tuned_rx_sel);
+
     /* Set the polling delay in micro seconds to check memory device availability */
     Cy_SMIF_SetReadyPollingDelay(CY_CHECK_MEMORY_AVAILABILITY_DELAY_US, &QSPI_context);
 
@@ -339,6 +587,14 @@ cy_en_smif_status_t qspi_init_hardware(void)
 
 cy_stc_smif_mem_config_t *qspi_get_memory_config(uint8_t index)
 {
+    (void)qspi_ensure_init();
+
+    /* Keep a valid pointer if the init failed, the transfer then fails */
+    if (NULL == smif_blk_config)
+    {
+        return smifBlockConfig_sfdp.memConfig[index];
+    }
+
     return smif_blk_config->memConfig[index];
 }
 
@@ -352,124 +608,1962 @@ cy_stc_smif_context_t *qspi_get_context(void)
     return &QSPI_context;
 }
 
-cy_en_smif_status_t qspi_init(cy_stc_smif_block_config_t *blk_config)
+static cy_en_smif_status_t qspi_read_jedec_id(cy_en_smif_slave_select_t slave, uint8_t *id)
 {
     cy_en_smif_status_t st;
 
-    st = qspi_init_hardware();
+    st = Cy_SMIF_TransmitCommand(QSPIPort, QSPI_READ_JEDEC_ID_CMD, CY_SMIF_WIDTH_SINGLE,
+                                 NULL, 0U, CY_SMIF_WIDTH_SINGLE,
+                                 slave, CY_SMIF_TX_NOT_LAST_BYTE,
+                                 &QSPI_context);
     if (st == CY_SMIF_SUCCESS)
     {
-        smif_blk_config = blk_config;
-        st = Cy_SMIF_MemInit(QSPIPort, smif_blk_config, &QSPI_context);
+        st = Cy_SMIF_ReceiveDataBlocking(QSPIPort, id, QSPI_JEDEC_ID_SIZE,
+                                         CY_SMIF_WIDTH_SINGLE, &QSPI_context);
     }
+
+    /* No part answers with all zeros or all ones */
+    if ((st == CY_SMIF_SUCCESS) &&
+        (((id[0] == 0x00U) && (id[1] == 0x00U)) ||
+         ((id[0] == 0xFFU) && (id[1] == 0xFFU))))
+    {
+        st = CY_SMIF_NO_SFDP_SUPPORT;
+    }
+
     return st;
 }
 
-cy_en_smif_status_t qspi_init_sfdp(uint32_t smif_id)
+static cy_en_smif_status_t qspi_read_sfdp(uint32_t address, uint8_t *data, uint32_t len)
 {
-    cy_en_smif_status_t stat = CY_SMIF_SUCCESS;
+    uint8_t addr[3] = { (uint8_t)(address >> 16), (uint8_t)(address >> 8), (uint8_t)address };
+    cy_en_smif_status_t st;
 
-    cy_stc_smif_mem_config_t **memCfg = smifBlockConfig_sfdp.memConfig;
+    st = Cy_SMIF_TransmitCommand(QSPIPort, QSPI_READ_SFDP_CMD, CY_SMIF_WIDTH_SINGLE,
+                                 addr, sizeof(addr), CY_SMIF_WIDTH_SINGLE,
+                                 mem_sfdp_0.slaveSelect, CY_SMIF_TX_NOT_LAST_BYTE,
+                                 &QSPI_context);
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_SendDummyCycles(QSPIPort, QSPI_READ_SFDP_DUMMY_CYCLES);
+    }
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_ReceiveDataBlocking(QSPIPort, data, len,
+                                         CY_SMIF_WIDTH_SINGLE, &QSPI_context);
+    }
 
-    GPIO_PRT_Type *SS_Port;
-    uint32_t SS_Pin;
-    en_hsiom_sel_t SS_MuxPort;
+    return st;
+}
 
-    switch(smif_id)
+/* Reads the erase suspend opcodes and timing from the basic flash parameter
+ * table. Cy_SMIF_MemSfdpDetect() does not keep them. Parts with an older
+ * table or without suspend support leave the suspend command at 0.
+ */
+static void qspi_read_suspend_info(void)
+{
+    static const uint32_t latency_unit_ns[4] = { 128U, 1000U, 8000U, 64000U };
+    uint8_t header[QSPI_SFDP_HEADER_SIZE];
+    uint8_t dwords[QSPI_SFDP_BFPT_SUSPEND_SIZE];
+    uint32_t table;
+    uint32_t dword12;
+    uint32_t dword13;
+    uint32_t count;
+
+    (void)memset(&qspi_suspend_info, 0, sizeof(qspi_suspend_info));
+
+    /* SFDP header, followed by the header of the basic parameter table */
+    if ((qspi_read_sfdp(0U, header, sizeof(header)) != CY_SMIF_SUCCESS) ||
+        (0 != memcmp(header, "SFDP", 4U)) ||
+        (header[11] < (QSPI_SFDP_BFPT_SUSPEND_DWORD + 1U)))
     {
-    case 1:
-        (*memCfg)->slaveSelect = CY_SMIF_SLAVE_SELECT_0;
-        break;
-    case 2:
-        (*memCfg)->slaveSelect = CY_SMIF_SLAVE_SELECT_1;
-        break;
-    case 3:
-        (*memCfg)->slaveSelect = CY_SMIF_SLAVE_SELECT_2;
-        break;
-#if(SMIF_CHIP_TOP_SPI_SEL_NR > 3)
-    case 4:
-        (*memCfg)->slaveSelect = CY_SMIF_SLAVE_SELECT_3;
-        break;
-#endif
-    default:
-        stat = CY_SMIF_BAD_PARAM;
-        break;
+        return;
     }
 
-    if(CY_SMIF_SUCCESS == stat)
+    table = (uint32_t)header[12] | ((uint32_t)header[13] << 8) | ((uint32_t)header[14] << 16);
+    if (qspi_read_sfdp(table + ((QSPI_SFDP_BFPT_SUSPEND_DWORD - 1U) * 4U),
+                       dwords, sizeof(dwords)) != CY_SMIF_SUCCESS)
+    {
+        return;
+    }
+
+    dword12 = (uint32_t)dwords[0] | ((uint32_t)dwords[1] << 8) |
+              ((uint32_t)dwords[2] << 16) | ((uint32_t)dwords[3] << 24);
+    dword13 = (uint32_t)dwords[4] | ((uint32_t)dwords[5] << 8) |
+              ((uint32_t)dwords[6] << 16) | ((uint32_t)dwords[7] << 24);
+
+    /* Bit 31 set: suspend and resume are not supported */
+    if (0U != (dword12 & (1UL << 31)))
     {
-        SS_Port = qspi_SS_Configuration[smif_id-1U].SS_Port;
-        SS_Pin = qspi_SS_Configuration[smif_id-1U].SS_Pin;
-        SS_MuxPort = qspi_SS_Configuration[smif_id-1U].SS_Mux;
+        return;
+    }
 
-        QSPI_SS_config.hsiom = SS_MuxPort;
+    count = ((dword12 >> 24) & 0x1FU) + 1U;
+    qspi_suspend_info.latency_us = ((count * latency_unit_ns[(dword12 >> 29) & 0x3U]) + 999U) / 1000U;
+    qspi_suspend_info.resume_interval_us = (((dword12 >> 20) & 0xFU) + 1U) * 64U;
+    qspi_suspend_info.suspend_cmd = (uint8_t)(dword13 >> 24);
+    qspi_suspend_info.resume_cmd = (uint8_t)(dword13 >> 16);
+}
 
-        (void)Cy_GPIO_Pin_Init(SS_Port, SS_Pin, &QSPI_SS_config);
-        Cy_GPIO_SetHSIOM(SS_Port, SS_Pin, SS_MuxPort);
+#ifdef CY_SMIF_USE_SFDP_CACHE
+static cy_stc_smif_mem_cmd_t * const qspi_sfdp_cache_cmds[QSPI_SFDP_CACHE_CMD_NUM] =
+{
+    &rdcmd0, &wrencmd0, &wrdiscmd0, &erasecmd0, &chiperasecmd0,
+    &pgmcmd0, &readsts0, &readstsqecmd0, &writestseqcmd0
+};
 
-        uint32_t try_count = CY_SMIF_INIT_TRY_COUNT;
-        do {
-            stat = qspi_init(&smifBlockConfig_sfdp);
+static uint32_t qspi_sfdp_cache_checksum(const qspi_sfdp_cache_t *cache)
+{
+    const uint8_t *data = (const uint8_t *)cache;
+    uint32_t sum = 0U;
 
-            try_count--;
-            if (stat != CY_SMIF_SUCCESS)
+    for (uint32_t i = 0U; i < offsetof(qspi_sfdp_cache_t, checksum); i++)
+    {
+        sum = ((sum << 5) | (sum >> 27)) + data[i];
+    }
+
+    return ~sum;
+}
+
+/* Fills dev_sfdp_0 from the cache if it was written for the attached part */
+static bool qspi_sfdp_cache_load(void)
+{
+    const qspi_sfdp_cache_t *cache = (const qspi_sfdp_cache_t *)qspi_sfdp_cache_data;
+
+    if ((cache->magic != QSPI_SFDP_CACHE_MAGIC) ||
+        (cache->size != sizeof(qspi_sfdp_cache_t)) ||
+        (cache->checksum != qspi_sfdp_cache_checksum(cache)) ||
+        (0 != memcmp(cache->jedec_id, qspi_jedec_id, QSPI_JEDEC_ID_SIZE)))
+    {
+        return false;
+    }
+
+    dev_sfdp_0.numOfAddrBytes = cache->numOfAddrBytes;
+    dev_sfdp_0.memSize = cache->memSize;
+    dev_sfdp_0.eraseSize = cache->eraseSize;
+    dev_sfdp_0.programSize = cache->programSize;
+    dev_sfdp_0.stsRegBusyMask = cache->stsRegBusyMask;
+    dev_sfdp_0.stsRegQuadEnableMask = cache->stsRegQuadEnableMask;
+    dev_sfdp_0.eraseTime = cache->eraseTime;
+    dev_sfdp_0.chipEraseTime = cache->chipEraseTime;
+    dev_sfdp_0.programTime = cache->programTime;
+    dev_sfdp_0.hybridRegionCount = 0U;
+    dev_sfdp_0.hybridRegionInfo = NULL;
+    qspi_suspend_info = cache->suspend;
+    qspi_tuned_div = (cy_en_clkhf_dividers_t)cache->clk_div;
+    qspi_tuned_rx_sel = cache->rx_clock_sel;
+    qspi_tuned = (0U != cache->tuned);
+    qspi_tune_addr = cache->tune_addr;
+
+    for (uint32_t i = 0U; i < QSPI_SFDP_CACHE_CMD_NUM; i++)
+    {
+        *qspi_sfdp_cache_cmds[i] = cache->cmd[i];
+    }
+
+    return true;
+}
+
+/* Stores the parameters Cy_SMIF_MemSfdpDetect() filled in for the part */
+static void qspi_sfdp_cache_store(void)
+{
+    static qspi_sfdp_cache_t cache;
+
+    /* Hybrid sector layouts point into PDL data, they are detected every time */
+    if (0U != dev_sfdp_0.hybridRegionCount)
+    {
+        return;
+    }
+
+    (void)memset(&cache, 0, sizeof(cache));
+    cache.magic = QSPI_SFDP_CACHE_MAGIC;
+    cache.size = sizeof(qspi_sfdp_cache_t);
+    (void)memcpy(cache.jedec_id, qspi_jedec_id, QSPI_JEDEC_ID_SIZE);
+    cache.numOfAddrBytes = dev_sfdp_0.numOfAddrBytes;
+    cache.memSize = dev_sfdp_0.memSize;
+    cache.eraseSize = dev_sfdp_0.eraseSize;
+    cache.programSize = dev_sfdp_0.programSize;
+    cache.stsRegBusyMask = dev_sfdp_0.stsRegBusyMask;
+    cache.stsRegQuadEnableMask = dev_sfdp_0.stsRegQuadEnableMask;
+    cache.eraseTime = dev_sfdp_0.eraseTime;
+    cache.chipEraseTime = dev_sfdp_0.chipEraseTime;
+    cache.programTime = dev_sfdp_0.programTime;
+    cache.suspend = qspi_suspend_info;
+    cache.clk_div = (uint8_t)qspi_tuned_div;
+    cache.rx_clock_sel = (uint8_t)qspi_tuned_rx_sel;
+    cache.tuned = qspi_tuned ? 1U : 0U;
+    cache.tune_addr = qspi_tune_addr;
+
+    for (uint32_t i = 0U; i < QSPI_SFDP_CACHE_CMD_NUM; i++)
+    {
+        cache.cmd[i] = *qspi_sfdp_cache_cmds[i];
+    }
+    cache.checksum = qspi_sfdp_cache_checksum(&cache);
+
+    if (0 != memcmp(&cache, qspi_sfdp_cache_data, sizeof(cache)))
+    {
+        static uint32_t row[CY_FLASH_SIZEOF_ROW / sizeof(uint32_t)];
+
+        (void)memset(row, 0, sizeof(row));
+        (void)memcpy(row, &cache, sizeof(cache));
+        (void)Cy_Flash_WriteRow((uint32_t)qspi_sfdp_cache_row, row);
+    }
+}
+#endif /* CY_SMIF_USE_SFDP_CACHE */
+
+static bool qspi_cmd_uses_quad(const cy_stc_smif_mem_cmd_t *cmd)
+{
+    return ((cmd->cmdWidth == CY_SMIF_WIDTH_QUAD) ||
+            (cmd->addrWidth == CY_SMIF_WIDTH_QUAD) ||
+            (cmd->dataWidth == CY_SMIF_WIDTH_QUAD));
+}
+
+static void qspi_set_single_cmd(cy_stc_smif_mem_cmd_t *cmd, uint32_t command)
+{
+    cmd->command = command;
+    cmd->cmdWidth = CY_SMIF_WIDTH_SINGLE;
+    cmd->addrWidth = CY_SMIF_WIDTH_SINGLE;
+    cmd->mode = 0xFFFFFFFFU;
+    cmd->dummyCycles = 0U;
+    cmd->dataWidth = CY_SMIF_WIDTH_SINGLE;
+}
+
+/* The SFDP detection picks the fastest read and program commands the part
+ * advertises (1-1-4, 1-4-4 or 4-4-4). Those only work with the QE bit set,
+ * so set it here, or fall back to single-width commands if that fails.
+ * The SMIF of this device has no DDR mode, so DTR commands are not used.
+ */
+static cy_en_smif_status_t qspi_enable_quad(cy_stc_smif_mem_config_t *mem)
+{
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+    bool quad_enabled = false;
+
+    if ((!qspi_cmd_uses_quad(&rdcmd0)) && (!qspi_cmd_uses_quad(&pgmcmd0)))
+    {
+        return CY_SMIF_SUCCESS;
+    }
+
+    if (0U != dev_sfdp_0.stsRegQuadEnableMask)
+    {
+        st = Cy_SMIF_MemIsQuadEnabled(QSPIPort, mem, &quad_enabled, &QSPI_context);
+        if ((st == CY_SMIF_SUCCESS) && (!quad_enabled))
+        {
+            st = Cy_SMIF_MemEnableQuadMode(QSPIPort, mem,
+                                           QSPI_QE_WRITE_TIMEOUT_US, &QSPI_context);
+            if (st == CY_SMIF_SUCCESS)
             {
-                Cy_SysLib_Delay(500U);
+                st = Cy_SMIF_MemIsQuadEnabled(QSPIPort, mem, &quad_enabled, &QSPI_context);
             }
-        } while ((stat != CY_SMIF_SUCCESS) && (try_count > 0U));
+        }
     }
-    return stat;
+    else
+    {
+        /* No QE bit, the quad pins are always enabled */
+        quad_enabled = true;
+    }
+
+    if ((st != CY_SMIF_SUCCESS) || (!quad_enabled))
+    {
+        bool addr_4b = (dev_sfdp_0.numOfAddrBytes == 4U);
+
+        qspi_set_single_cmd(&rdcmd0, addr_4b ? QSPI_READ_4B_CMD : QSPI_READ_CMD);
+        qspi_set_single_cmd(&pgmcmd0, addr_4b ? QSPI_PROGRAM_4B_CMD : QSPI_PROGRAM_CMD);
+
+        /* Reprogram the XIP read command without another SFDP detection */
+        mem_sfdp_0.flags &= ~CY_SMIF_FLAG_DETECT_SFDP;
+        st = Cy_SMIF_MemInit(QSPIPort, smif_blk_config, &QSPI_context);
+        mem_sfdp_0.flags |= CY_SMIF_FLAG_DETECT_SFDP;
+    }
+
+    return st;
 }
 
-uint32_t qspi_get_prog_size(void)
+#ifdef CY_SMIF_AUTO_TUNE
+static void qspi_set_timing(cy_en_clkhf_dividers_t div, uint32_t rx_sel)
 {
-    cy_stc_smif_mem_config_t **memCfg = smifBlockConfig_sfdp.memConfig;
-    return (*memCfg)->deviceCfg->programSize;
+    (void)Cy_SysClk_ClkHfSetDivider(CY_SYSCLK_CLKHF_IN_CLKPATH2, div);
+
+    /* The RX clock is only switched with the block disabled */
+    Cy_SMIF_Disable(QSPIPort);
+    SMIF_CTL(QSPIPort) = _CLR_SET_FLD32U(SMIF_CTL(QSPIPort), SMIF_CTL_CLOCK_IF_RX_SEL, rx_sel);
+    Cy_SMIF_Enable(QSPIPort, &QSPI_context);
 }
 
-uint32_t qspi_get_erase_size(void)
+/* Reads the calibration pattern: the SFDP tables, in single width, and
+ * array data at the given address, with the read command used for XIP.
+ */
+static cy_en_smif_status_t qspi_tune_read(uint32_t address, uint8_t *sfdp, uint8_t *data)
 {
-    cy_stc_smif_mem_config_t **memCfg = smifBlockConfig_sfdp.memConfig;
-    return (*memCfg)->deviceCfg->eraseSize;
+    cy_en_smif_status_t st = qspi_read_sfdp(0U, sfdp, QSPI_TUNE_SFDP_SIZE);
+
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_MemRead(QSPIPort, &mem_sfdp_0, address, data, QSPI_TUNE_DATA_SIZE, &QSPI_context);
+    }
+
+    return st;
 }
 
-uint32_t qspi_get_mem_size(void)
+/* Checks that the data drives every data line both low and high and changes
+ * from byte to byte in at least half of the bytes.
+ */
+static bool qspi_tune_pattern_ok(const uint8_t *data)
 {
-    cy_stc_smif_mem_config_t **memCfg = smifBlockConfig_sfdp.memConfig;
-    return (*memCfg)->deviceCfg->memSize;
+    uint8_t ones = 0U;
+    uint8_t zeros = 0xFFU;
+    uint32_t changes = 0U;
+
+    for (uint32_t i = 0U; i < QSPI_TUNE_DATA_SIZE; i++)
+    {
+        ones |= data[i];
+        zeros &= data[i];
+        if ((0U != i) && (data[i] != data[i - 1U]))
+        {
+            changes++;
+        }
+    }
+
+    return (0xFFU == ones) && (0U == zeros) && (changes >= (QSPI_TUNE_DATA_SIZE / 2U));
 }
 
-void qspi_deinit(uint32_t smif_id)
+/* Finds the reference pattern at the default timing: the SFDP tables, which
+ * must carry the SFDP signature, and the first sector start whose data
+ * passes qspi_tune_pattern_ok().
+ */
+static bool qspi_tune_find_pattern(uint32_t *address, uint8_t *sfdp, uint8_t *data)
 {
-    Cy_SMIF_MemDeInit(QSPIPort);
+    uint32_t step = dev_sfdp_0.eraseSize;
+    uint32_t count = (0U != step) ? (dev_sfdp_0.memSize / step) : 0U;
 
-    Cy_SMIF_Disable(QSPIPort);
+    if (count > QSPI_TUNE_SCAN_NUM)
+    {
+        count = QSPI_TUNE_SCAN_NUM;
+    }
 
-    (void)Cy_SysClk_ClkHfDisable(CY_SYSCLK_CLKHF_IN_CLKPATH2);
+    if ((qspi_read_sfdp(0U, sfdp, QSPI_TUNE_SFDP_SIZE) != CY_SMIF_SUCCESS) ||
+        (QSPI_TUNE_SFDP_SIGNATURE != ((uint32_t)sfdp[0] | ((uint32_t)sfdp[1] << 8U) |
+                                      ((uint32_t)sfdp[2] << 16U) | ((uint32_t)sfdp[3] << 24U))))
+    {
+        return false;
+    }
 
-#ifdef CM0P
-    NVIC_DisableIRQ(smifIntConfig.intrSrc);
-    Cy_SysInt_DisconnectInterruptSource(smifIntConfig.intrSrc, smifIntConfig.cm0pSrc);
-#endif
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        *address = i * step;
+        if ((Cy_SMIF_MemRead(QSPIPort, &mem_sfdp_0, *address, data, QSPI_TUNE_DATA_SIZE,
+                             &QSPI_context) == CY_SMIF_SUCCESS) &&
+            qspi_tune_pattern_ok(data))
+        {
+            return true;
+        }
+    }
 
-    Cy_GPIO_Port_Deinit(qspi_SS_Configuration[smif_id-1U].SS_Port);
-    Cy_GPIO_Port_Deinit(SCKPort);
-    Cy_GPIO_Port_Deinit(D0Port);
-    Cy_GPIO_Port_Deinit(D1Port);
-    Cy_GPIO_Port_Deinit(D2Port);
-    Cy_GPIO_Port_Deinit(D3Port);
+    return false;
 }
 
-void qspi_set_mode(cy_en_smif_mode_t mode)
+/* Publishes the timing in use for the application started by this boot */
+static void qspi_tune_publish(void)
 {
-    SMIF_Type* smif_mem = qspi_get_device();
+    (void)memset(&qspi_shared_timing, 0, sizeof(qspi_shared_timing));
 
-    Cy_SMIF_SetMode(smif_mem, mode);
+    if (qspi_tuned)
+    {
+        qspi_shared_timing.path_hz = Cy_SysClk_ClkPathGetFrequency(CY_SYSCLK_CLKHF_IN_CLKPATH0);
+        qspi_shared_timing.clk_div = (uint8_t)qspi_tuned_div;
+        qspi_shared_timing.rx_clock_sel = (uint8_t)qspi_tuned_rx_sel;
+        qspi_shared_timing.magic = QSPI_TIMING_MAGIC;
+    }
 }
 
-cy_en_smif_mode_t qspi_get_mode(void)
+/* Checks the timing loaded from the SFDP cache with one read-back of the
+ * calibration pattern, compared with a read at the default timing. A timing
+ * that fails is replaced by the default one.
+ *
+ * Returns false if the pattern is no longer there, e.g. the sector has been
+ * rewritten, and a new calibration is needed.
+ */
+static bool qspi_tune_verify(uint8_t *sfdp_ref, uint8_t *data_ref, uint8_t *sfdp, uint8_t *data)
 {
-    SMIF_Type* smif_mem = qspi_get_device();
+    bool pass;
 
-    return Cy_SMIF_GetMode(smif_mem);
+    qspi_set_timing(CY_SMIF_SYSCLK_HFCLK_DIVIDER, (uint32_t)CY_SMIF_SEL_INV_INTERNAL_CLK);
+    if ((qspi_tune_read(qspi_tune_addr, sfdp_ref, data_ref) != CY_SMIF_SUCCESS) ||
+        !qspi_tune_pattern_ok(data_ref))
+    {
+        return false;
+    }
+
+    qspi_set_timing(qspi_tuned_div, qspi_tuned_rx_sel);
+    pass = (qspi_tune_read(qspi_tune_addr, sfdp, data) == CY_SMIF_SUCCESS) &&
+           (0 == memcmp(sfdp, sfdp_ref, QSPI_TUNE_SFDP_SIZE)) &&
+           (0 == memcmp(data, data_ref, QSPI_TUNE_DATA_SIZE));
+
+    if (!pass)
+    {
+        qspi_tuned_div = CY_SMIF_SYSCLK_HFCLK_DIVIDER;
+        qspi_tuned_rx_sel = (uint32_t)CY_SMIF_SEL_INV_INTERNAL_CLK;
+        qspi_tuned = false;
+        qspi_set_timing(qspi_tuned_div, qspi_tuned_rx_sel);
+    }
+
+    return true;
+}
+
+/* Picks the fastest SMIF clock, up to CY_SMIF_CLK_HF_MAX_HZ, at which the
+ * calibration pattern reads back the same as at the default timing with an
+ * RX sampling clock whose neighbours in sampling phase pass as well. The
+ * setting thus keeps a margin on both sides of its sampling point. The
+ * default RX clock wins when several have that margin. Without a setting
+ * with margin, or without a usable pattern, e.g. on a blank part, the
+ * default timing is kept and the calibration is tried again on the next
+ * init.
+ *
+ * A part found in the SFDP cache gets the stored timing after one read-back
+ * (see qspi_tune_verify()). If that fails, the default timing is used and
+ * the next init calibrates again.
+ *
+ * Returns true if the timing to store in the SFDP cache may have changed.
+ */
+static bool qspi_tune(bool cached)
+{
+    static const cy_en_clkhf_dividers_t divs[QSPI_TUNE_DIV_NUM] =
+    {
+        CY_SYSCLK_CLKHF_NO_DIVIDE, CY_SYSCLK_CLKHF_DIVIDE_BY_2,
+        CY_SYSCLK_CLKHF_DIVIDE_BY_4, CY_SYSCLK_CLKHF_DIVIDE_BY_8
+    };
+    /* In order of sampling phase: the output clocks sample later than the
+     * internal clocks by the pad and board delay, the inverted clocks half a
+     * clock period later. The order wraps around.
+     */
+    static const cy_en_smif_clk_select_rx_t rx_sels[QSPI_TUNE_RX_NUM] =
+    {
+        CY_SMIF_SEL_INTERNAL_CLK, CY_SMIF_SEL_OUTPUT_CLK,
+        CY_SMIF_SEL_INV_INTERNAL_CLK, CY_SMIF_SEL_INV_OUTPUT_CLK
+    };
+    static uint8_t sfdp_ref[QSPI_TUNE_SFDP_SIZE];
+    static uint8_t data_ref[QSPI_TUNE_DATA_SIZE];
+    static uint8_t sfdp[QSPI_TUNE_SFDP_SIZE];
+    static uint8_t data[QSPI_TUNE_DATA_SIZE];
+    uint32_t path_hz = Cy_SysClk_ClkPathGetFrequency(CY_SYSCLK_CLKHF_IN_CLKPATH0);
+    bool found = false;
+
+    if (cached && qspi_tuned && qspi_tune_verify(sfdp_ref, data_ref, sfdp, data))
+    {
+        qspi_tune_publish();
+        return !qspi_tuned;
+    }
+
+    qspi_tuned_div = CY_SMIF_SYSCLK_HFCLK_DIVIDER;
+    qspi_tuned_rx_sel = (uint32_t)CY_SMIF_SEL_INV_INTERNAL_CLK;
+    qspi_tuned = false;
+    qspi_tune_result_count = 0U;
+    qspi_set_timing(qspi_tuned_div, qspi_tuned_rx_sel);
+
+    /* The default timing gives the reference */
+    if (!qspi_tune_find_pattern(&qspi_tune_addr, sfdp_ref, data_ref))
+    {
+        qspi_tune_publish();
+        return cached;
+    }
+
+    /* The bandwidth is measured with the cycle counter */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t d = 0U; d < QSPI_TUNE_DIV_NUM; d++)
+    {
+        uint32_t clk_hz = path_hz >> (uint32_t)divs[d];
+        bool pass[QSPI_TUNE_RX_NUM];
+
+        if (clk_hz > CY_SMIF_CLK_HF_MAX_HZ)
+        {
+            continue;
+        }
+
+        for (uint32_t r = 0U; r < QSPI_TUNE_RX_NUM; r++)
+        {
+            qspi_tune_result_t *result = &qspi_tune_results[qspi_tune_result_count++];
+
+            qspi_set_timing(divs[d], (uint32_t)rx_sels[r]);
+
+            result->clk_hz = clk_hz;
+            result->rx_clock_sel = (uint8_t)rx_sels[r];
+            result->read_kBps = 0U;
+            result->pass = (qspi_tune_read(qspi_tune_addr, sfdp, data) == CY_SMIF_SUCCESS) &&
+                           (0 == memcmp(sfdp, sfdp_ref, sizeof(sfdp))) &&
+                           (0 == memcmp(data, data_ref, sizeof(data)));
+            pass[r] = result->pass;
+
+            if (result->pass)
+            {
+                uint32_t start = DWT->CYCCNT;
+                uint32_t us;
+
+                for (uint32_t i = 0U; i < QSPI_TUNE_BW_REPEAT; i++)
+                {
+                    (void)Cy_SMIF_MemRead(QSPIPort, &mem_sfdp_0, qspi_tune_addr, data,
+                                          QSPI_TUNE_DATA_SIZE, &QSPI_context);
+                }
+                us = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000UL);
+                if (0U != us)
+                {
+                    result->read_kBps = (QSPI_TUNE_BW_REPEAT * QSPI_TUNE_DATA_SIZE * 1000UL) / us;
+                }
+            }
+        }
+
+        /* The slower dividers are still tried, for the results */
+        for (uint32_t k = 0U; (k < QSPI_TUNE_RX_NUM) && !found; k++)
+        {
+            /* Starts at the default, CY_SMIF_SEL_INV_INTERNAL_CLK */
+            uint32_t r = (k + 2U) % QSPI_TUNE_RX_NUM;
+
+            if (pass[(r + QSPI_TUNE_RX_NUM - 1U) % QSPI_TUNE_RX_NUM] && pass[r] &&
+                pass[(r + 1U) % QSPI_TUNE_RX_NUM])
+            {
+                found = true;
+                qspi_tuned_div = divs[d];
+                qspi_tuned_rx_sel = (uint32_t)rx_sels[r];
+            }
+        }
+    }
+
+    qspi_tuned = found;
+    qspi_set_timing(qspi_tuned_div, qspi_tuned_rx_sel);
+    qspi_tune_publish();
+
+    /* A cached timing is replaced even when no new one was found */
+    return found || cached;
+}
+
+/* Returns the settings tried by the last calibration and their results */
+const qspi_tune_result_t *qspi_get_tune_results(uint32_t *count)
+{
+    *count = qspi_tune_result_count;
+
+    return qspi_tune_results;
+}
+#endif /* CY_SMIF_AUTO_TUNE */
+
+cy_en_smif_status_t qspi_init(cy_stc_smif_block_config_t *blk_config)
+{
+    cy_en_smif_status_t st;
+
+    st = qspi_init_hardware();
+    if (st == CY_SMIF_SUCCESS)
+    {
+        smif_blk_config = blk_config;
+
+        bool sfdp_cached = false;
+
+#ifdef CY_SMIF_USE_SFDP_CACHE
+        /* Skip the SFDP detection when the part was seen before */
+        if ((blk_config == &smifBlockConfig_sfdp) &&
+            (qspi_read_jedec_id(mem_sfdp_0.slaveSelect, qspi_jedec_id) == CY_SMIF_SUCCESS))
+        {
+            sfdp_cached = qspi_sfdp_cache_load();
+            if (sfdp_cached)
+            {
+                mem_sfdp_0.flags &= ~CY_SMIF_FLAG_DETECT_SFDP;
+            }
+        }
+#endif
+
+        st = Cy_SMIF_MemInit(QSPIPort, smif_blk_config, &QSPI_context);
+
+#ifdef CY_SMIF_USE_SFDP_CACHE
+        mem_sfdp_0.flags |= CY_SMIF_FLAG_DETECT_SFDP;
+#endif
+
+        if ((st == CY_SMIF_SUCCESS) && (blk_config == &smifBlockConfig_sfdp))
+        {
+            st = qspi_enable_quad(&mem_sfdp_0);
+        }
+
+        if ((st == CY_SMIF_SUCCESS) && (blk_config == &smifBlockConfig_sfdp))
+        {
+            bool store = !sfdp_cached;
+
+#ifdef CY_SMIF_AUTO_TUNE
+            /* A cached part that was blank when first seen is tuned now */
+            store = qspi_tune(sfdp_cached) || store;
+#endif
+            if (!sfdp_cached)
+            {
+                qspi_read_suspend_info();
+            }
+#ifdef CY_SMIF_USE_SFDP_CACHE
+            if (store)
+            {
+                qspi_sfdp_cache_store();
+            }
+#else
+            (void)store;
+#endif
+        }
+
+        if (st == CY_SMIF_SUCCESS)
+        {
+            /* Poll a page program a few times rather than once a millisecond */
+            uint32_t delay_us = (*smif_blk_config->memConfig)->deviceCfg->programTime / QSPI_ASYNC_POLL_DIV;
+
+            if (delay_us < CY_CHECK_MEMORY_AVAILABILITY_DELAY_MIN_US)
+            {
+                delay_us = CY_CHECK_MEMORY_AVAILABILITY_DELAY_MIN_US;
+            }
+            else if (delay_us > CY_CHECK_MEMORY_AVAILABILITY_DELAY_US)
+            {
+                delay_us = CY_CHECK_MEMORY_AVAILABILITY_DELAY_US;
+            }
+            Cy_SMIF_SetReadyPollingDelay((uint16_t)delay_us, &QSPI_context);
+        }
+    }
+    return st;
+}
+
+static void qspi_init_ss_pin(uint32_t smif_id)
+{
+    GPIO_PRT_Type *SS_Port = qspi_SS_Configuration[smif_id-1U].SS_Port;
+    uint32_t SS_Pin = qspi_SS_Configuration[smif_id-1U].SS_Pin;
+    en_hsiom_sel_t SS_MuxPort = qspi_SS_Configuration[smif_id-1U].SS_Mux;
+
+    QSPI_SS_config.hsiom = SS_MuxPort;
+
+    (void)Cy_GPIO_Pin_Init(SS_Port, SS_Pin, &QSPI_SS_config);
+    Cy_GPIO_SetHSIOM(SS_Port, SS_Pin, SS_MuxPort);
+}
+
+static void qspi_deinit_ss_pin(uint32_t smif_id)
+{
+    GPIO_PRT_Type *SS_Port = qspi_SS_Configuration[smif_id-1U].SS_Port;
+    uint32_t SS_Pin = qspi_SS_Configuration[smif_id-1U].SS_Pin;
+
+    Cy_GPIO_SetHSIOM(SS_Port, SS_Pin, HSIOM_SEL_GPIO);
+    Cy_GPIO_SetDrivemode(SS_Port, SS_Pin, CY_GPIO_DM_ANALOG);
+}
+
+/* Adds the chips on the slave select lines following smif_id. A chip is only
+ * used if it has the same JEDEC ID as the first one, since all chips share
+ * the parameters found by the SFDP detection of the first one.
+ */
+static cy_en_smif_status_t qspi_init_chips(uint32_t smif_id)
+{
+    cy_en_smif_status_t st;
+    uint8_t id[QSPI_JEDEC_ID_SIZE];
+    uint32_t count = 1U;
+
+    st = qspi_read_jedec_id(mem_sfdp_0.slaveSelect, qspi_jedec_id);
+
+    /* Only the chips that fit in the XIP window are used */
+    while ((st == CY_SMIF_SUCCESS) && (count < CY_BOOT_EXT_FLASH_CHIPS) &&
+           ((smif_id + count) <= QSPI_CHIP_NUM_MAX) &&
+           (dev_sfdp_0.memSize <= (CY_XIP_SIZE / (count + 1U))))
+    {
+        cy_stc_smif_mem_config_t *mem = &mem_sfdp_chip[count - 1U];
+
+        qspi_init_ss_pin(smif_id + count);
+
+        *mem = mem_sfdp_0;
+        mem->slaveSelect = (cy_en_smif_slave_select_t)(1UL << (smif_id + count - 1U));
+        mem->flags &= ~CY_SMIF_FLAG_DETECT_SFDP;
+        mem->baseAddress = mem_sfdp_0.baseAddress + (count * dev_sfdp_0.memSize);
+        mem->memMappedSize = dev_sfdp_0.memSize;
+
+        if ((qspi_read_jedec_id(mem->slaveSelect, id) != CY_SMIF_SUCCESS) ||
+            (0 != memcmp(id, qspi_jedec_id, QSPI_JEDEC_ID_SIZE)))
+        {
+            /* Not populated (or a different part): stop at the first gap */
+            qspi_deinit_ss_pin(smif_id + count);
+            break;
+        }
+
+        mems_sfdp[count] = mem;
+        count++;
+    }
+
+    if (count > 1U)
+    {
+        /* Map the chips back to back instead of giving the first one the
+         * whole XIP window, and bring up the others without SFDP.
+         */
+        mem_sfdp_0.memMappedSize = dev_sfdp_0.memSize;
+        mem_sfdp_0.flags &= ~CY_SMIF_FLAG_DETECT_SFDP;
+        smifBlockConfig_sfdp.memCount = count;
+        qspi_chip_count = count;
+
+        st = Cy_SMIF_MemInit(QSPIPort, &smifBlockConfig_sfdp, &QSPI_context);
+        mem_sfdp_0.flags |= CY_SMIF_FLAG_DETECT_SFDP;
+
+        for (uint32_t i = 1U; (i < count) && (st == CY_SMIF_SUCCESS); i++)
+        {
+            st = qspi_enable_quad(mems_sfdp[i]);
+        }
+    }
+
+    return st;
+}
+
+cy_en_smif_status_t qspi_init_sfdp(uint32_t smif_id)
+{
+    cy_en_smif_status_t stat = CY_SMIF_SUCCESS;
+
+    cy_stc_smif_mem_config_t **memCfg = smifBlockConfig_sfdp.memConfig;
+
+    switch(smif_id)
+    {
+    case 1:
+        (*memCfg)->slaveSelect = CY_SMIF_SLAVE_SELECT_0;
+        break;
+    case 2:
+        (*memCfg)->slaveSelect = CY_SMIF_SLAVE_SELECT_1;
+        break;
+    case 3:
+        (*memCfg)->slaveSelect = CY_SMIF_SLAVE_SELECT_2;
+        break;
+#if(SMIF_CHIP_TOP_SPI_SEL_NR > 3)
+    case 4:
+        (*memCfg)->slaveSelect = CY_SMIF_SLAVE_SELECT_3;
+        break;
+#endif
+    default:
+        stat = CY_SMIF_BAD_PARAM;
+        break;
+    }
+
+    if(CY_SMIF_SUCCESS == stat)
+    {
+        qspi_init_ss_pin(smif_id);
+
+        /* A part that is still powering up usually answers within a few
+         * milliseconds, so start with a short delay and back off from there.
+         */
+        uint32_t try_count = CY_SMIF_INIT_TRY_COUNT;
+        uint32_t delay_ms = CY_SMIF_INIT_RETRY_DELAY_MIN_MS;
+        do {
+            stat = qspi_init(&smifBlockConfig_sfdp);
+
+            try_count--;
+            if ((stat != CY_SMIF_SUCCESS) && (try_count > 0U))
+            {
+                Cy_SysLib_Delay(delay_ms);
+                delay_ms = (delay_ms < (CY_SMIF_INIT_RETRY_DELAY_MAX_MS / 2U)) ?
+                           (delay_ms * 2U) : CY_SMIF_INIT_RETRY_DELAY_MAX_MS;
+            }
+        } while ((stat != CY_SMIF_SUCCESS) && (try_count > 0U));
+
+        if ((CY_SMIF_SUCCESS == stat) && (CY_BOOT_EXT_FLASH_CHIPS > 1U))
+        {
+            stat = qspi_init_chips(smif_id);
+        }
+    }
+    return stat;
+}
+
+void qspi_defer_init(uint32_t smif_id, qspi_init_callback_t callback)
+{
+    qspi_deferred_smif_id = smif_id;
+    qspi_init_callback = callback;
+    qspi_init_attempted = false;
+
+#ifdef CY_SMIF_AUTO_TUNE
+    /* No timing for the application unless the SMIF comes up in this boot */
+    (void)memset(&qspi_shared_timing, 0, sizeof(qspi_shared_timing));
+#endif
+}
+
+cy_en_smif_status_t qspi_ensure_init(void)
+{
+    /* Only one attempt (with its retries) per boot, a missing part must
+     * not cost the retry time on every access.
+     */
+    if ((!qspi_init_attempted) && (0U != qspi_deferred_smif_id))
+    {
+        qspi_init_attempted = true;
+        qspi_init_status = qspi_init_sfdp(qspi_deferred_smif_id);
+
+        if (NULL != qspi_init_callback)
+        {
+            qspi_init_callback(qspi_init_status);
+        }
+    }
+
+    return qspi_init_status;
+}
+
+bool qspi_is_initialized(void)
+{
+    return (NULL != smif_blk_config);
+}
+
+/* Number of chips concatenated into the external flash address space */
+uint32_t qspi_get_chip_count(void)
+{
+    (void)qspi_ensure_init();
+
+    return qspi_chip_count;
+}
+
+cy_en_smif_txfr_width_t qspi_get_read_width(void)
+{
+    (void)qspi_ensure_init();
+
+    return rdcmd0.dataWidth;
+}
+
+cy_en_smif_txfr_width_t qspi_get_program_width(void)
+{
+    (void)qspi_ensure_init();
+
+    return pgmcmd0.dataWidth;
+}
+
+uint32_t qspi_get_prog_size(void)
+{
+    (void)qspi_ensure_init();
+
+    cy_stc_smif_mem_config_t **memCfg = smifBlockConfig_sfdp.memConfig;
+    return (*memCfg)->deviceCfg->programSize;
+}
+
+uint32_t qspi_get_erase_size(void)
+{
+    (void)qspi_ensure_init();
+
+    cy_stc_smif_mem_config_t **memCfg = smifBlockConfig_sfdp.memConfig;
+    return (*memCfg)->deviceCfg->eraseSize;
+}
+
+uint32_t qspi_get_mem_size(void)
+{
+    (void)qspi_ensure_init();
+
+    cy_stc_smif_mem_config_t **memCfg = smifBlockConfig_sfdp.memConfig;
+    return (*memCfg)->deviceCfg->memSize * qspi_chip_count;
+}
+
+void qspi_deinit(uint32_t smif_id)
+{
+    /* Nothing to undo if the external flash was never used */
+    if (!qspi_is_initialized())
+    {
+        return;
+    }
+    smif_blk_config = NULL;
+
+    Cy_SMIF_MemDeInit(QSPIPort);
+
+    Cy_SMIF_Disable(QSPIPort);
+
+    (void)Cy_SysClk_ClkHfDisable(CY_SYSCLK_CLKHF_IN_CLKPATH2);
+
+#ifdef CM0P
+    NVIC_DisableIRQ(smifIntConfig.intrSrc);
+    Cy_SysInt_DisconnectInterruptSource(smifIntConfig.intrSrc, smifIntConfig.cm0pSrc);
+#endif
+
+    for (uint32_t i = 1U; i < qspi_chip_count; i++)
+    {
+        qspi_deinit_ss_pin(smif_id + i);
+        mems_sfdp[i] = NULL;
+    }
+    mem_sfdp_0.memMappedSize = CY_XIP_SIZE;
+    smifBlockConfig_sfdp.memCount = 1U;
+    qspi_chip_count = 1U;
+
+    Cy_GPIO_Port_Deinit(qspi_SS_Configuration[smif_id-1U].SS_Port);
+    Cy_GPIO_Port_Deinit(SCKPort);
+    Cy_GPIO_Port_Deinit(D0Port);
+    Cy_GPIO_Port_Deinit(D1Port);
+    Cy_GPIO_Port_Deinit(D2Port);
+    Cy_GPIO_Port_Deinit(D3Port);
+}
+
+void qspi_set_mode(cy_en_smif_mode_t mode)
+{
+    SMIF_Type* smif_mem = qspi_get_device();
+
+    /* Lines cached before a program or erase in normal mode are stale */
+    if (mode == CY_SMIF_MEMORY)
+    {
+        (void)Cy_SMIF_CacheInvalidate(smif_mem, CY_SMIF_CACHE_BOTH);
+    }
+
+    Cy_SMIF_SetMode(smif_mem, mode);
+}
+
+/* Enables the SMIF caches for code running from the XIP window: the fast
+ * cache serves the CM4, the slow cache the other bus masters. Prefetch
+ * fetches the next line on a miss, which suits sequential code. The cache
+ * sizes are fixed by the hardware.
+ */
+void qspi_xip_cache_enable(void)
+{
+    SMIF_Type* smif_mem = qspi_get_device();
+
+    (void)Cy_SMIF_CacheInvalidate(smif_mem, CY_SMIF_CACHE_BOTH);
+    (void)Cy_SMIF_CacheEnable(smif_mem, CY_SMIF_CACHE_BOTH);
+    (void)Cy_SMIF_CachePrefetchingEnable(smif_mem, CY_SMIF_CACHE_BOTH);
+}
+
+cy_en_smif_mode_t qspi_get_mode(void)
+{
+    SMIF_Type* smif_mem = qspi_get_device();
+
+    return Cy_SMIF_GetMode(smif_mem);
+}
+
+#ifdef QSPI_DMA_CHANNEL
+/* Starts a DMA descriptor for the next whole rows of the read job */
+static void qspi_read_dma_chunk(void)
+{
+    uint32_t rows = (qspi_read_job.len - qspi_read_job.done) / QSPI_DMA_X_COUNT;
+    cy_stc_dma_descriptor_config_t descr_config =
+    {
+        .retrigger = CY_DMA_RETRIG_IM,
+        .interruptType = CY_DMA_DESCR,
+        .triggerOutType = CY_DMA_DESCR,
+        .channelState = CY_DMA_CHANNEL_DISABLED,
+        .triggerInType = CY_DMA_DESCR,
+        .dataSize = CY_DMA_BYTE,
+        .srcTransferSize = CY_DMA_TRANSFER_SIZE_DATA,
+        .dstTransferSize = CY_DMA_TRANSFER_SIZE_DATA,
+        .descriptorType = CY_DMA_2D_TRANSFER,
+        .srcXincrement = 1,
+        .dstXincrement = 1,
+        .xCount = QSPI_DMA_X_COUNT,
+        .srcYincrement = (int32_t)QSPI_DMA_X_COUNT,
+        .dstYincrement = (int32_t)QSPI_DMA_X_COUNT,
+        .nextDescriptor = NULL,
+    };
+    cy_stc_dma_channel_config_t channel_config =
+    {
+        .descriptor = &qspi_dma_descr,
+        .preemptable = false,
+        .priority = 3UL,
+        .enable = false,
+        .bufferable = false,
+    };
+
+    if (rows > QSPI_DMA_Y_COUNT_MAX)
+    {
+        rows = QSPI_DMA_Y_COUNT_MAX;
+    }
+    qspi_read_job.chunk = rows * QSPI_DMA_X_COUNT;
+
+    descr_config.srcAddress = (void *)(mem_sfdp_0.baseAddress + qspi_read_job.address + qspi_read_job.done);
+    descr_config.dstAddress = (void *)&qspi_read_job.data[qspi_read_job.done];
+    descr_config.yCount = rows;
+
+    (void)Cy_DMA_Descriptor_Init(&qspi_dma_descr, &descr_config);
+    (void)Cy_DMA_Channel_Init(QSPI_DMA_HW, QSPI_DMA_CHANNEL, &channel_config);
+    Cy_DMA_Channel_ClearInterrupt(QSPI_DMA_HW, QSPI_DMA_CHANNEL);
+    Cy_DMA_Channel_SetInterruptMask(QSPI_DMA_HW, QSPI_DMA_CHANNEL, CY_DMA_INTR_MASK);
+    Cy_DMA_Enable(QSPI_DMA_HW);
+    Cy_DMA_Channel_Enable(QSPI_DMA_HW, QSPI_DMA_CHANNEL);
+
+    (void)Cy_TrigMux_SwTrigger(QSPI_DMA_TRIGGER, CY_TRIGGER_TWO_CYCLES);
+}
+#endif
+
+/* Copies the rest of the read job with the CPU and ends it */
+static void qspi_read_finish(void)
+{
+    uint32_t left = qspi_read_job.len - qspi_read_job.done;
+
+    if (left > 0U)
+    {
+        (void)memcpy(&qspi_read_job.data[qspi_read_job.done],
+                     (const void *)(mem_sfdp_0.baseAddress + qspi_read_job.address + qspi_read_job.done),
+                     left);
+        qspi_read_job.done = qspi_read_job.len;
+    }
+
+    qspi_set_mode(qspi_read_job.prev_mode);
+    qspi_read_job.busy = false;
+
+    (void)qspi_erase_resume();
+}
+
+/* Moves the data of the read job, by DMA if possible */
+static void qspi_read_transfer(void)
+{
+    qspi_set_mode(CY_SMIF_MEMORY);
+
+#ifdef QSPI_DMA_CHANNEL
+    if ((qspi_read_job.len >= QSPI_DMA_X_COUNT) &&
+        (0U == (DW_CH_CTL(QSPI_DMA_HW, QSPI_DMA_CHANNEL) & DW_CH_STRUCT_CH_CTL_ENABLED_Msk)))
+    {
+        qspi_read_dma_chunk();
+        return;
+    }
+#endif
+
+    /* No DMA: copy with the CPU right away */
+    qspi_read_finish();
+}
+
+/* Starts reading len bytes from the external flash address (offset from the
+ * start of the memory) to data. The SMIF is switched to memory mode and a
+ * DataWire channel copies from the XIP window, so the CPU is free until
+ * qspi_read_busy() returns false. If the channel is in use, the read is done
+ * with the CPU before this function returns. Program and erase stay on
+ * Cy_SMIF_MemWrite()/Cy_SMIF_MemEraseSector(), which need normal mode, so no
+ * other SMIF access may be made while a read is in progress. An erase started
+ * with qspi_erase_start() is suspended until the read ends; the transfer
+ * starts once the suspend has taken effect.
+ */
+cy_en_smif_status_t qspi_read_start(uint32_t address, uint8_t *data, uint32_t len)
+{
+    cy_en_smif_status_t st;
+
+    if (qspi_read_job.busy || (qspi_async.op == QSPI_ASYNC_PROGRAM))
+    {
+        return CY_SMIF_BUSY;
+    }
+
+    st = qspi_ensure_init();
+    if (st != CY_SMIF_SUCCESS)
+    {
+        return st;
+    }
+
+    if ((NULL == data) || ((address + len) > (mem_sfdp_0.memMappedSize * qspi_chip_count)))
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    qspi_read_job.data = data;
+    qspi_read_job.address = address;
+    qspi_read_job.len = len;
+    qspi_read_job.done = 0U;
+    qspi_read_job.chunk = 0U;
+    qspi_read_job.prev_mode = qspi_get_mode();
+    qspi_read_job.busy = true;
+
+    /* A background erase is suspended for the read, not waited for. If the
+     * suspend is still pending, qspi_read_busy() starts the transfer.
+     */
+    qspi_read_job.suspending = (qspi_erase_suspend() == CY_SMIF_BUSY);
+    if (!qspi_read_job.suspending)
+    {
+        qspi_read_transfer();
+    }
+
+    return CY_SMIF_SUCCESS;
+}
+
+/* Advances the read started by qspi_read_start(), returns true while it runs */
+bool qspi_read_busy(void)
+{
+    if (qspi_read_job.suspending && (!qspi_erase_suspend_pending()))
+    {
+        qspi_read_job.suspending = false;
+        qspi_read_transfer();
+    }
+
+#ifdef QSPI_DMA_CHANNEL
+    if (qspi_read_job.busy && (qspi_read_job.chunk > 0U) &&
+        (0U != (Cy_DMA_Channel_GetInterruptStatus(QSPI_DMA_HW, QSPI_DMA_CHANNEL) & CY_DMA_INTR_MASK)))
+    {
+        Cy_DMA_Channel_ClearInterrupt(QSPI_DMA_HW, QSPI_DMA_CHANNEL);
+        Cy_DMA_Channel_Disable(QSPI_DMA_HW, QSPI_DMA_CHANNEL);
+
+        qspi_read_job.done += qspi_read_job.chunk;
+        qspi_read_job.chunk = 0U;
+
+        if ((qspi_read_job.len - qspi_read_job.done) >= QSPI_DMA_X_COUNT)
+        {
+            qspi_read_dma_chunk();
+        }
+        else
+        {
+            qspi_read_finish();
+        }
+    }
+#endif
+
+    return qspi_read_job.busy;
+}
+
+cy_en_smif_status_t qspi_read_wait(void)
+{
+    while (qspi_read_busy())
+    {
+    }
+
+    return CY_SMIF_SUCCESS;
+}
+
+cy_en_smif_status_t qspi_read(uint32_t address, uint8_t *data, uint32_t len)
+{
+    cy_en_smif_status_t st = qspi_read_start(address, data, len);
+
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = qspi_read_wait();
+    }
+
+    return st;
+}
+
+static uint32_t qspi_us_to_cycles(uint32_t us)
+{
+    return us * (SystemCoreClock / 1000000UL);
+}
+
+static void qspi_async_schedule(uint32_t max_time_us)
+{
+    uint32_t poll_us = max_time_us / QSPI_ASYNC_POLL_DIV;
+
+    if (poll_us < CY_CHECK_MEMORY_AVAILABILITY_DELAY_MIN_US)
+    {
+        poll_us = CY_CHECK_MEMORY_AVAILABILITY_DELAY_MIN_US;
+    }
+
+    qspi_async.poll_cycles = qspi_us_to_cycles(poll_us);
+    qspi_async.next_poll = DWT->CYCCNT + qspi_us_to_cycles(max_time_us / QSPI_ASYNC_FIRST_POLL_DIV);
+}
+
+static void qspi_async_addr(uint32_t address, uint8_t *addr)
+{
+    uint32_t addr_len = dev_sfdp_0.numOfAddrBytes;
+
+    for (uint32_t i = 0U; i < addr_len; i++)
+    {
+        addr[i] = (uint8_t)(address >> (8U * (addr_len - 1U - i)));
+    }
+}
+
+/* Issues the erase of the next sector of a chip */
+static cy_en_smif_status_t qspi_async_issue_erase(uint32_t chip)
+{
+    cy_stc_smif_mem_config_t *mem = mems_sfdp[chip];
+    uint8_t addr[4];
+    cy_en_smif_status_t st;
+
+    qspi_async_addr(qspi_async.chip_next[chip] % dev_sfdp_0.memSize, addr);
+
+    st = Cy_SMIF_MemCmdWriteEnable(QSPIPort, mem, &QSPI_context);
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_MemCmdSectorErase(QSPIPort, mem, addr, &QSPI_context);
+    }
+
+    qspi_async.chip_next[chip] += dev_sfdp_0.eraseSize;
+    qspi_async.chip_busy |= (1UL << chip);
+    qspi_async_schedule(dev_sfdp_0.eraseTime * 1000UL);
+
+    return st;
+}
+
+/* Issues the program of the next page, the data phase is done blocking so
+ * that no SMIF interrupt is needed.
+ */
+static cy_en_smif_status_t qspi_async_issue_program(void)
+{
+    cy_stc_smif_mem_cmd_t *cmd = dev_sfdp_0.programCmd;
+    cy_stc_smif_mem_config_t *mem;
+    uint8_t addr[4];
+    uint32_t size;
+    cy_en_smif_status_t st;
+
+    qspi_async.chip = qspi_async.address / dev_sfdp_0.memSize;
+    mem = mems_sfdp[qspi_async.chip];
+    qspi_async_addr(qspi_async.address % dev_sfdp_0.memSize, addr);
+
+    /* Up to the end of the page, which never crosses a chip boundary */
+    size = dev_sfdp_0.programSize - (qspi_async.address % dev_sfdp_0.programSize);
+    if (size > (qspi_async.end - qspi_async.address))
+    {
+        size = qspi_async.end - qspi_async.address;
+    }
+
+    st = Cy_SMIF_MemCmdWriteEnable(QSPIPort, mem, &QSPI_context);
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_TransmitCommand(QSPIPort, (uint8_t)cmd->command, cmd->cmdWidth,
+                                     addr, dev_sfdp_0.numOfAddrBytes, cmd->addrWidth,
+                                     mem->slaveSelect, CY_SMIF_TX_NOT_LAST_BYTE,
+                                     &QSPI_context);
+    }
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = Cy_SMIF_TransmitDataBlocking(QSPIPort, qspi_async.data, size,
+                                          cmd->dataWidth, &QSPI_context);
+    }
+
+    qspi_async.data += size;
+    qspi_async.address += size;
+    qspi_async_schedule(dev_sfdp_0.programTime);
+
+    return st;
+}
+
+static void qspi_async_complete(cy_en_smif_status_t status)
+{
+    qspi_async.op = QSPI_ASYNC_NONE;
+    qspi_async.status = status;
+
+    if (NULL != qspi_async.callback)
+    {
+        qspi_async.callback(status, qspi_async.callback_arg);
+    }
+}
+
+/* Starts the next sector on every chip that is idle and has sectors left.
+ * With several chips, an erase that spans them runs on all in parallel.
+ */
+static cy_en_smif_status_t qspi_async_erase_step(void)
+{
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+
+    for (uint32_t chip = 0U; (chip < qspi_chip_count) && (st == CY_SMIF_SUCCESS); chip++)
+    {
+        if ((0U != (qspi_async.chip_busy & (1UL << chip))) &&
+            (!Cy_SMIF_Memory_IsBusy(QSPIPort, mems_sfdp[chip], &QSPI_context)))
+        {
+            qspi_async.chip_busy &= ~(1UL << chip);
+        }
+
+        if ((0U == (qspi_async.chip_busy & (1UL << chip))) &&
+            (qspi_async.chip_next[chip] < qspi_async.chip_end[chip]))
+        {
+            st = qspi_async_issue_erase(chip);
+        }
+    }
+
+    return st;
+}
+
+static cy_en_smif_status_t qspi_async_start(qspi_async_op_t op, uint32_t address,
+                                            const uint8_t *data, uint32_t len,
+                                            qspi_op_callback_t callback, void *arg)
+{
+    cy_en_smif_status_t st;
+    uint32_t chip_size;
+
+    if ((qspi_async.op != QSPI_ASYNC_NONE) || qspi_read_job.busy ||
+        (0U != qspi_async.suspend_depth))
+    {
+        return CY_SMIF_BUSY;
+    }
+
+    st = qspi_ensure_init();
+    if (st != CY_SMIF_SUCCESS)
+    {
+        return st;
+    }
+
+    chip_size = dev_sfdp_0.memSize;
+    if ((0U == len) || ((address + len) > (chip_size * qspi_chip_count)) ||
+        ((op == QSPI_ASYNC_ERASE) &&
+         ((0U != (address % dev_sfdp_0.eraseSize)) || (0U != (len % dev_sfdp_0.eraseSize)))))
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    /* The cycle counter times the status polls */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    qspi_async.op = op;
+    qspi_async.address = address;
+    qspi_async.end = address + len;
+    qspi_async.data = data;
+    qspi_async.chip_busy = 0U;
+    qspi_async.chip_suspended = 0U;
+    qspi_async.suspend_pending = false;
+    qspi_async.suspend_failed = false;
+    qspi_async.callback = callback;
+    qspi_async.callback_arg = arg;
+    qspi_async.status = CY_SMIF_BUSY;
+
+    if (op == QSPI_ASYNC_ERASE)
+    {
+        /* Split the range into the part of each chip */
+        for (uint32_t chip = 0U; chip < qspi_chip_count; chip++)
+        {
+            uint32_t start = chip * chip_size;
+            uint32_t end = start + chip_size;
+
+            qspi_async.chip_next[chip] = (address > start) ? address : start;
+            qspi_async.chip_end[chip] = (qspi_async.end < end) ? qspi_async.end : end;
+        }
+
+        st = qspi_async_erase_step();
+    }
+    else
+    {
+        st = qspi_async_issue_program();
+    }
+
+    if (st != CY_SMIF_SUCCESS)
+    {
+        qspi_async.op = QSPI_ASYNC_NONE;
+        qspi_async.status = st;
+    }
+
+    return st;
+}
+
+/* Starts erasing len bytes (whole sectors) at the external flash address.
+ * The erase runs in the background, qspi_async_process() must be called
+ * until it returns false; callback is then called with the result.
+ */
+cy_en_smif_status_t qspi_erase_start(uint32_t address, uint32_t len,
+                                     qspi_op_callback_t callback, void *arg)
+{
+    return qspi_async_start(QSPI_ASYNC_ERASE, address, NULL, len, callback, arg);
+}
+
+/* Starts programming len bytes at the external flash address, one page at a
+ * time. data must stay valid until the callback is called.
+ */
+cy_en_smif_status_t qspi_program_start(uint32_t address, const uint8_t *data, uint32_t len,
+                                       qspi_op_callback_t callback, void *arg)
+{
+    if (NULL == data)
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    return qspi_async_start(QSPI_ASYNC_PROGRAM, address, data, len, callback, arg);
+}
+
+/* Advances the running erase or program. The device status is read no
+ * earlier than the SFDP time of the operation allows, so calling this often
+ * costs little. Returns true while the operation runs.
+ */
+bool qspi_async_process(void)
+{
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+
+    if (qspi_async.op == QSPI_ASYNC_NONE)
+    {
+        return false;
+    }
+
+    /* Nothing is started or polled while the erase is suspended */
+    if (0U != qspi_async.suspend_depth)
+    {
+        (void)qspi_erase_suspend_pending();
+        return true;
+    }
+
+    if ((int32_t)(DWT->CYCCNT - qspi_async.next_poll) < 0)
+    {
+        return true;
+    }
+
+    if (qspi_async.op == QSPI_ASYNC_ERASE)
+    {
+        st = qspi_async_erase_step();
+        if ((st == CY_SMIF_SUCCESS) && (0U != qspi_async.chip_busy))
+        {
+            qspi_async.next_poll = DWT->CYCCNT + qspi_async.poll_cycles;
+            return true;
+        }
+    }
+    else
+    {
+        if (Cy_SMIF_Memory_IsBusy(QSPIPort, mems_sfdp[qspi_async.chip], &QSPI_context))
+        {
+            qspi_async.next_poll = DWT->CYCCNT + qspi_async.poll_cycles;
+            return true;
+        }
+
+        if (qspi_async.address < qspi_async.end)
+        {
+            st = qspi_async_issue_program();
+            if (st == CY_SMIF_SUCCESS)
+            {
+                return true;
+            }
+        }
+    }
+
+    qspi_async_complete(st);
+
+    return false;
+}
+
+cy_en_smif_status_t qspi_async_wait(void)
+{
+    while (qspi_async_process())
+    {
+    }
+
+    return qspi_async.status;
+}
+
+static cy_en_smif_status_t qspi_suspend_cmd(uint32_t chip, uint8_t command)
+{
+    return Cy_SMIF_TransmitCommand(QSPIPort, command, dev_sfdp_0.eraseCmd->cmdWidth,
+                                   NULL, 0U, CY_SMIF_WIDTH_SINGLE,
+                                   mems_sfdp[chip]->slaveSelect, CY_SMIF_TX_LAST_BYTE,
+                                   &QSPI_context);
+}
+
+/* Waits until the chip is ready, up to timeout_us */
+static bool qspi_wait_ready(uint32_t chip, uint32_t timeout_us)
+{
+    bool busy = Cy_SMIF_Memory_IsBusy(QSPIPort, mems_sfdp[chip], &QSPI_context);
+
+    while (busy && (timeout_us > 0U))
+    {
+        Cy_SysLib_DelayUs(1U);
+        timeout_us--;
+        busy = Cy_SMIF_Memory_IsBusy(QSPIPort, mems_sfdp[chip], &QSPI_context);
+    }
+
+    return !busy;
+}
+
+/* Sends the resume command to the chips with a suspended sector */
+static cy_en_smif_status_t qspi_resume_chips(void)
+{
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+
+    for (uint32_t chip = 0U; chip < qspi_chip_count; chip++)
+    {
+        if (0U != (qspi_async.chip_suspended & (1UL << chip)))
+        {
+            cy_en_smif_status_t chip_st = qspi_suspend_cmd(chip, qspi_suspend_info.resume_cmd);
+
+            if (chip_st != CY_SMIF_SUCCESS)
+            {
+                st = chip_st;
+            }
+        }
+    }
+
+    qspi_async.chip_suspended = 0U;
+
+    return st;
+}
+
+/* Tries to bring the erase to a stop without waiting. The sector erase of
+ * every busy chip is suspended with the SFDP suspend command, once the part
+ * has had the SFDP minimum time since the last resume; otherwise frequent
+ * reads could keep the erase from ever completing. A part without a suspend
+ * command, or one that failed to suspend, finishes its running sectors
+ * instead. Returns CY_SMIF_BUSY until no chip erases.
+ */
+static cy_en_smif_status_t qspi_erase_suspend_step(void)
+{
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+    cy_en_smif_mode_t mode;
+
+    if ((0U != qspi_suspend_info.suspend_cmd) && (!qspi_async.suspend_failed) &&
+        ((DWT->CYCCNT - qspi_async.resume_time) <
+         qspi_us_to_cycles(qspi_suspend_info.resume_interval_us)))
+    {
+        return CY_SMIF_BUSY;
+    }
+
+    if (((0U == qspi_suspend_info.suspend_cmd) || qspi_async.suspend_failed) &&
+        ((int32_t)(DWT->CYCCNT - qspi_async.next_poll) < 0))
+    {
+        return CY_SMIF_BUSY;
+    }
+
+    /* Commands are only sent in normal mode */
+    mode = qspi_get_mode();
+    qspi_set_mode(CY_SMIF_NORMAL);
+
+    if ((0U != qspi_suspend_info.suspend_cmd) && (!qspi_async.suspend_failed))
+    {
+        for (uint32_t chip = 0U; (chip < qspi_chip_count) && (st == CY_SMIF_SUCCESS); chip++)
+        {
+            if ((0U != (qspi_async.chip_busy & (1UL << chip))) &&
+                Cy_SMIF_Memory_IsBusy(QSPIPort, mems_sfdp[chip], &QSPI_context))
+            {
+                st = qspi_suspend_cmd(chip, qspi_suspend_info.suspend_cmd);
+                if (st == CY_SMIF_SUCCESS)
+                {
+                    qspi_async.chip_suspended |= (1UL << chip);
+                }
+            }
+        }
+
+        /* The suspend latency is short, tens of microseconds */
+        for (uint32_t chip = 0U; (chip < qspi_chip_count) && (st == CY_SMIF_SUCCESS); chip++)
+        {
+            if ((0U != (qspi_async.chip_suspended & (1UL << chip))) &&
+                (!qspi_wait_ready(chip, qspi_suspend_info.latency_us)))
+            {
+                st = CY_SMIF_EXCEED_TIMEOUT;
+            }
+        }
+
+        if (st != CY_SMIF_SUCCESS)
+        {
+            (void)qspi_resume_chips();
+            qspi_async.suspend_failed = true;
+        }
+    }
+
+    if ((0U == qspi_suspend_info.suspend_cmd) || qspi_async.suspend_failed)
+    {
+        st = CY_SMIF_SUCCESS;
+
+        for (uint32_t chip = 0U; chip < qspi_chip_count; chip++)
+        {
+            if (0U != (qspi_async.chip_busy & (1UL << chip)))
+            {
+                if (Cy_SMIF_Memory_IsBusy(QSPIPort, mems_sfdp[chip], &QSPI_context))
+                {
+                    st = CY_SMIF_BUSY;
+                }
+                else
+                {
+                    qspi_async.chip_busy &= ~(1UL << chip);
+                }
+            }
+        }
+
+        if (st == CY_SMIF_BUSY)
+        {
+            qspi_async.next_poll = DWT->CYCCNT + qspi_async.poll_cycles;
+        }
+    }
+
+    qspi_set_mode(mode);
+
+    return st;
+}
+
+/* Advances a suspend requested by qspi_erase_suspend(), returns true while
+ * it has not taken effect.
+ */
+bool qspi_erase_suspend_pending(void)
+{
+    if (qspi_async.suspend_pending && (qspi_erase_suspend_step() == CY_SMIF_SUCCESS))
+    {
+        qspi_async.suspend_pending = false;
+    }
+
+    return qspi_async.suspend_pending;
+}
+
+/* Suspends the erase started with qspi_erase_start(), if any, so that the
+ * memory can be read, e.g. through the XIP window. No further sector is
+ * started until the matching qspi_erase_resume(). Calls may be nested.
+ * Does not wait: returns CY_SMIF_BUSY while the suspend is pending, see
+ * qspi_erase_suspend_step(). qspi_erase_suspend_pending() and
+ * qspi_async_process() complete it.
+ */
+cy_en_smif_status_t qspi_erase_suspend(void)
+{
+    qspi_async.suspend_depth++;
+
+    if ((1U == qspi_async.suspend_depth) && (qspi_async.op == QSPI_ASYNC_ERASE))
+    {
+        qspi_async.suspend_pending = true;
+    }
+
+    return qspi_erase_suspend_pending() ? CY_SMIF_BUSY : CY_SMIF_SUCCESS;
+}
+
+/* Resumes the erase suspended by qspi_erase_suspend() */
+cy_en_smif_status_t qspi_erase_resume(void)
+{
+    cy_en_smif_status_t st;
+    cy_en_smif_mode_t mode;
+
+    if (0U == qspi_async.suspend_depth)
+    {
+        return CY_SMIF_BAD_PARAM;
+    }
+
+    qspi_async.suspend_depth--;
+    if (0U != qspi_async.suspend_depth)
+    {
+        return CY_SMIF_SUCCESS;
+    }
+
+    qspi_async.suspend_pending = false;
+    qspi_async.suspend_failed = false;
+
+    mode = qspi_get_mode();
+    qspi_set_mode(CY_SMIF_NORMAL);
+    st = qspi_resume_chips();
+    qspi_set_mode(mode);
+
+    /* A poll already due is kept: reads closer together than the poll
+     * interval would otherwise postpone it forever, and no further sector
+     * would be started.
+     */
+    qspi_async.resume_time = DWT->CYCCNT;
+    if ((int32_t)(qspi_async.next_poll - (qspi_async.resume_time + qspi_async.poll_cycles)) > 0)
+    {
+        qspi_async.next_poll = qspi_async.resume_time + qspi_async.poll_cycles;
+    }
+
+    return st;
+}
+
+#ifdef CY_SMIF_WRAP_MEM_API
+/* The flash PAL addresses the external flash as one memory through the
+ * configuration of the first chip. With several chips the calls are linked
+ * (-Wl,--wrap) to the functions below, which split them at chip boundaries.
+ */
+cy_en_smif_status_t __real_Cy_SMIF_MemRead(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                           uint32_t address, uint8_t rxBuffer[], uint32_t length,
+                                           cy_stc_smif_context_t const *context);
+cy_en_smif_status_t __real_Cy_SMIF_MemWrite(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                            uint32_t address, uint8_t const txBuffer[], uint32_t length,
+                                            cy_stc_smif_context_t const *context);
+cy_en_smif_status_t __real_Cy_SMIF_MemEraseSector(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                                  uint32_t address, uint32_t length,
+                                                  cy_stc_smif_context_t const *context);
+
+/* Returns the chip holding address and the bytes of length that fit in it */
+static bool qspi_chip_split(uint32_t address, uint32_t length, uint32_t *chip, uint32_t *chunk)
+{
+    uint32_t chip_size = dev_sfdp_0.memSize;
+    uint32_t left;
+
+    *chip = address / chip_size;
+    left = chip_size - (address % chip_size);
+    *chunk = (length < left) ? length : left;
+
+    return (*chip < qspi_chip_count);
+}
+
+cy_en_smif_status_t __wrap_Cy_SMIF_MemRead(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                           uint32_t address, uint8_t rxBuffer[], uint32_t length,
+                                           cy_stc_smif_context_t const *context)
+{
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+    uint32_t chip;
+    uint32_t chunk;
+
+    if (memConfig != &mem_sfdp_0)
+    {
+        return __real_Cy_SMIF_MemRead(base, memConfig, address, rxBuffer, length, context);
+    }
+
+    while ((length > 0U) && (st == CY_SMIF_SUCCESS))
+    {
+        if (!qspi_chip_split(address, length, &chip, &chunk))
+        {
+            return CY_SMIF_BAD_PARAM;
+        }
+        st = __real_Cy_SMIF_MemRead(base, mems_sfdp[chip], address % dev_sfdp_0.memSize,
+                                    rxBuffer, chunk, context);
+        address += chunk;
+        rxBuffer += chunk;
+        length -= chunk;
+    }
+
+    return st;
+}
+
+cy_en_smif_status_t __wrap_Cy_SMIF_MemWrite(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                            uint32_t address, uint8_t const txBuffer[], uint32_t length,
+                                            cy_stc_smif_context_t const *context)
+{
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+    uint32_t chip;
+    uint32_t chunk;
+
+    if (memConfig != &mem_sfdp_0)
+    {
+        return __real_Cy_SMIF_MemWrite(base, memConfig, address, txBuffer, length, context);
+    }
+
+    while ((length > 0U) && (st == CY_SMIF_SUCCESS))
+    {
+        if (!qspi_chip_split(address, length, &chip, &chunk))
+        {
+            return CY_SMIF_BAD_PARAM;
+        }
+        st = __real_Cy_SMIF_MemWrite(base, mems_sfdp[chip], address % dev_sfdp_0.memSize,
+                                     txBuffer, chunk, context);
+        address += chunk;
+        txBuffer += chunk;
+        length -= chunk;
+    }
+
+    return st;
+}
+
+cy_en_smif_status_t __wrap_Cy_SMIF_MemEraseSector(SMIF_Type *base, cy_stc_smif_mem_config_t const *memConfig,
+                                                  uint32_t address, uint32_t length,
+                                                  cy_stc_smif_context_t const *context)
+{
+    cy_en_smif_status_t st = CY_SMIF_SUCCESS;
+    uint32_t chip;
+    uint32_t chunk;
+
+    if (memConfig != &mem_sfdp_0)
+    {
+        return __real_Cy_SMIF_MemEraseSector(base, memConfig, address, length, context);
+    }
+
+    while ((length > 0U) && (st == CY_SMIF_SUCCESS))
+    {
+        if (!qspi_chip_split(address, length, &chip, &chunk))
+        {
+            return CY_SMIF_BAD_PARAM;
+        }
+        st = __real_Cy_SMIF_MemEraseSector(base, mems_sfdp[chip], address % dev_sfdp_0.memSize,
+                                           chunk, context);
+        address += chunk;
+        length -= chunk;
+    }
+
+    return st;
+}
+#endif /* CY_SMIF_WRAP_MEM_API */
+
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+/* With the secondary slot in the external flash, the UBM middleware writes
+ * the upgrade image to the SMIF XIP window with the internal flash driver.
+ * Its calls are linked (-Wl,--wrap, see flash_trace.c) to the
+ * qspi_flash_*_row() functions below. The internal flash rows are passed on
+ * and the external ones are programmed through the SMIF. The external flash
+ * erases whole sectors, so a row is read back first: a blank row is only
+ * programmed. Erasing or rewriting a row that is not blank erases its sector
+ * and programs back the other rows of the sector written since startup
+ * (read-modify-write). Rows written before startup are dropped when their
+ * sector is erased this way, and sectors above QSPI_ROW_SECTOR_MAX cannot
+ * keep any row: the write then fails instead.
+ */
+cy_en_flashdrv_status_t __real_Cy_Flash_EraseRow(uint32_t rowAddr);
+cy_en_flashdrv_status_t __real_Cy_Flash_ProgramRow(uint32_t rowAddr, const uint32_t *data);
+cy_en_flashdrv_status_t __real_Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data);
+
+/* External flash covered by the row emulation */
+#ifndef QSPI_ROW_MAP_SIZE
+#define QSPI_ROW_MAP_SIZE                   (0x100000UL)
+#endif
+
+/* Largest sector whose rows can be kept over an erase */
+#ifndef QSPI_ROW_SECTOR_MAX
+#define QSPI_ROW_SECTOR_MAX                 (0x1000UL)
+#endif
+
+#define QSPI_ROW_COUNT                      (QSPI_ROW_MAP_SIZE / CY_FLASH_SIZEOF_ROW)
+
+/* Rows written since startup. Only these are kept when their sector is
+ * erased for another row, the rows written before (e.g. by a previous
+ * image) are not part of the upgrade being written.
+ */
+static uint32_t qspi_row_written[(QSPI_ROW_COUNT + 31UL) / 32UL];
+
+/* Rows of the sector being rewritten, or the row being blank checked */
+static uint32_t qspi_row_buf[QSPI_ROW_SECTOR_MAX / sizeof(uint32_t)];
+
+static bool qspi_row_is_ext(uint32_t rowAddr)
+{
+    return ((rowAddr >= CY_XIP_BASE) && ((rowAddr - CY_XIP_BASE) < CY_XIP_SIZE));
+}
+
+static bool qspi_row_test(uint32_t offset)
+{
+    uint32_t row = offset / CY_FLASH_SIZEOF_ROW;
+
+    return (0UL != (qspi_row_written[row / 32UL] & (1UL << (row % 32UL))));
+}
+
+static void qspi_row_mark(uint32_t offset, bool written)
+{
+    uint32_t row = offset / CY_FLASH_SIZEOF_ROW;
+
+    if (written)
+    {
+        qspi_row_written[row / 32UL] |= (1UL << (row % 32UL));
+    }
+    else
+    {
+        qspi_row_written[row / 32UL] &= ~(1UL << (row % 32UL));
+    }
+}
+
+/* Checks the arguments and brings up the SMIF */
+static cy_en_flashdrv_status_t qspi_row_check(uint32_t offset)
+{
+    if ((0U != (offset % CY_FLASH_SIZEOF_ROW)) || (offset >= QSPI_ROW_MAP_SIZE))
+    {
+        return CY_FLASH_DRV_INVALID_INPUT_PARAMETERS;
+    }
+
+    return (CY_SMIF_SUCCESS == qspi_ensure_init()) ? CY_FLASH_DRV_SUCCESS : CY_FLASH_DRV_ERR_UNC;
+}
+
+/* Tells whether a row is erased, by reading it back */
+static cy_en_flashdrv_status_t qspi_row_blank(uint32_t offset, bool *blank)
+{
+    if (CY_SMIF_SUCCESS != qspi_read(offset, (uint8_t *)qspi_row_buf, CY_FLASH_SIZEOF_ROW))
+    {
+        return CY_FLASH_DRV_ERR_UNC;
+    }
+
+    *blank = true;
+    for (uint32_t i = 0U; i < (CY_FLASH_SIZEOF_ROW / sizeof(uint32_t)); i++)
+    {
+        if (0xFFFFFFFFUL != qspi_row_buf[i])
+        {
+            *blank = false;
+            break;
+        }
+    }
+
+    return CY_FLASH_DRV_SUCCESS;
+}
+
+static cy_en_flashdrv_status_t qspi_row_program(uint32_t offset, const uint32_t *data)
+{
+    cy_en_smif_status_t st;
+
+    if ((NULL == data) || (0U != (offset % CY_FLASH_SIZEOF_ROW)) || (offset >= QSPI_ROW_MAP_SIZE))
+    {
+        return CY_FLASH_DRV_INVALID_INPUT_PARAMETERS;
+    }
+
+    st = qspi_program_start(offset, (const uint8_t *)data, CY_FLASH_SIZEOF_ROW, NULL, NULL);
+    if (st == CY_SMIF_SUCCESS)
+    {
+        st = qspi_async_wait();
+    }
+
+    if (st != CY_SMIF_SUCCESS)
+    {
+        return CY_FLASH_DRV_ERR_UNC;
+    }
+
+    qspi_row_mark(offset, true);
+
+    return CY_FLASH_DRV_SUCCESS;
+}
+
+/* Erases the sector of the row at offset and programs back the other rows
+ * of the sector written since startup, then data at offset if not NULL.
+ */
+static cy_en_flashdrv_status_t qspi_row_rewrite(uint32_t offset, const uint32_t *data)
+{
+    cy_en_flashdrv_status_t st = CY_FLASH_DRV_SUCCESS;
+    cy_en_smif_status_t smif_st;
+    uint32_t sector = offset - (offset % dev_sfdp_0.eraseSize);
+    uint32_t keep = 0UL;
+
+    qspi_row_mark(offset, false);
+
+    for (uint32_t row = sector; row < (sector + dev_sfdp_0.eraseSize); row += CY_FLASH_SIZEOF_ROW)
+    {
+        if ((row < QSPI_ROW_MAP_SIZE) && qspi_row_test(row))
+        {
+            keep++;
+        }
+    }
+
+    if ((0UL != keep) && (dev_sfdp_0.eraseSize > QSPI_ROW_SECTOR_MAX))
+    {
+        return CY_FLASH_DRV_ERR_UNC;
+    }
+
+    for (uint32_t row = sector; (row < (sector + dev_sfdp_0.eraseSize)) && (0UL != keep); row += CY_FLASH_SIZEOF_ROW)
+    {
+        if ((row < QSPI_ROW_MAP_SIZE) && qspi_row_test(row) &&
+            (CY_SMIF_SUCCESS != qspi_read(row, (uint8_t *)&qspi_row_buf[(row - sector) / sizeof(uint32_t)],
+                                          CY_FLASH_SIZEOF_ROW)))
+        {
+            return CY_FLASH_DRV_ERR_UNC;
+        }
+    }
+
+    smif_st = qspi_erase_start(sector, dev_sfdp_0.eraseSize, NULL, NULL);
+    if (smif_st == CY_SMIF_SUCCESS)
+    {
+        smif_st = qspi_async_wait();
+    }
+    if (smif_st != CY_SMIF_SUCCESS)
+    {
+        return CY_FLASH_DRV_ERR_UNC;
+    }
+
+    for (uint32_t row = sector; (row < (sector + dev_sfdp_0.eraseSize)) && (0UL != keep); row += CY_FLASH_SIZEOF_ROW)
+    {
+        if ((st == CY_FLASH_DRV_SUCCESS) && (row < QSPI_ROW_MAP_SIZE) && qspi_row_test(row))
+        {
+            st = qspi_row_program(row, &qspi_row_buf[(row - sector) / sizeof(uint32_t)]);
+        }
+    }
+
+    if ((st == CY_FLASH_DRV_SUCCESS) && (NULL != data))
+    {
+        st = qspi_row_program(offset, data);
+    }
+
+    return st;
+}
+
+static cy_en_flashdrv_status_t qspi_row_erase(uint32_t offset)
+{
+    cy_en_flashdrv_status_t st = qspi_row_check(offset);
+    bool blank = false;
+
+    if (st == CY_FLASH_DRV_SUCCESS)
+    {
+        st = qspi_row_blank(offset, &blank);
+    }
+
+    if (st == CY_FLASH_DRV_SUCCESS)
+    {
+        if (blank)
+        {
+            qspi_row_mark(offset, false);
+        }
+        else
+        {
+            st = qspi_row_rewrite(offset, NULL);
+        }
+    }
+
+    return st;
+}
+
+static cy_en_flashdrv_status_t qspi_row_write(uint32_t offset, const uint32_t *data)
+{
+    cy_en_flashdrv_status_t st = qspi_row_check(offset);
+    bool blank = false;
+
+    if (NULL == data)
+    {
+        return CY_FLASH_DRV_INVALID_INPUT_PARAMETERS;
+    }
+
+    if (st == CY_FLASH_DRV_SUCCESS)
+    {
+        st = qspi_row_blank(offset, &blank);
+    }
+
+    if (st == CY_FLASH_DRV_SUCCESS)
+    {
+        st = blank ? qspi_row_program(offset, data) : qspi_row_rewrite(offset, data);
+    }
+
+    return st;
+}
+
+/* Cy_Flash_EraseRow() for the internal flash and the SMIF XIP window */
+cy_en_flashdrv_status_t qspi_flash_erase_row(uint32_t rowAddr)
+{
+    return qspi_row_is_ext(rowAddr) ? qspi_row_erase(rowAddr - CY_XIP_BASE) :
+                                      __real_Cy_Flash_EraseRow(rowAddr);
+}
+
+/* Cy_Flash_ProgramRow() for the internal flash and the SMIF XIP window */
+cy_en_flashdrv_status_t qspi_flash_program_row(uint32_t rowAddr, const uint32_t *data)
+{
+    return qspi_row_is_ext(rowAddr) ? qspi_row_program(rowAddr - CY_XIP_BASE, data) :
+                                      __real_Cy_Flash_ProgramRow(rowAddr, data);
+}
+
+/* Cy_Flash_WriteRow() for the internal flash and the SMIF XIP window */
+cy_en_flashdrv_status_t qspi_flash_write_row(uint32_t rowAddr, const uint32_t *data)
+{
+    return qspi_row_is_ext(rowAddr) ? qspi_row_write(rowAddr - CY_XIP_BASE, data) :
+                                      __real_Cy_Flash_WriteRow(rowAddr, data);
 }
+#endif /* CY_FLASH_WRAP_EXT_SLOT */
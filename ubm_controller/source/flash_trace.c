@@ -0,0 +1,99 @@
+/******************************************************************************
+* File Name:   flash_trace.c
+*
+* Description: Entry points of the internal flash driver calls of the
+*              application, linked to the functions below with -Wl,--wrap
+*              (see the Makefile).
+*
+*              With UBM_TRACE_FLASH every row operation is a trace event,
+*              which shows e.g. the FRU (emulated EEPROM) writes on the trace.
+*              With CY_FLASH_WRAP_EXT_SLOT the rows of the SMIF XIP window go
+*              to the external flash through flash_qspi.c, the other rows to
+*              the PDL driver.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if defined(CY_FLASH_WRAP_EXT_SLOT) || defined(UBM_TRACE_FLASH)
+
+#include "cy_pdl.h"
+
+#ifdef UBM_TRACE_FLASH
+#include "ubm_log.h"
+#endif
+
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+#include "flash_qspi_ext.h"
+#endif
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#ifdef UBM_TRACE_FLASH
+#define FLASH_TRACE_BEGIN(name)             UBM_TRACE_BEGIN(name)
+#define FLASH_TRACE_END(name)               UBM_TRACE_END(name)
+#else
+#define FLASH_TRACE_BEGIN(name)
+#define FLASH_TRACE_END(name)
+#endif
+
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+#define FLASH_ERASE_ROW(rowAddr)            qspi_flash_erase_row(rowAddr)
+#define FLASH_PROGRAM_ROW(rowAddr, data)    qspi_flash_program_row((rowAddr), (data))
+#define FLASH_WRITE_ROW(rowAddr, data)      qspi_flash_write_row((rowAddr), (data))
+#else
+#define FLASH_ERASE_ROW(rowAddr)            __real_Cy_Flash_EraseRow(rowAddr)
+#define FLASH_PROGRAM_ROW(rowAddr, data)    __real_Cy_Flash_ProgramRow((rowAddr), (data))
+#define FLASH_WRITE_ROW(rowAddr, data)      __real_Cy_Flash_WriteRow((rowAddr), (data))
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_en_flashdrv_status_t __real_Cy_Flash_EraseRow(uint32_t rowAddr);
+cy_en_flashdrv_status_t __real_Cy_Flash_ProgramRow(uint32_t rowAddr, const uint32_t *data);
+cy_en_flashdrv_status_t __real_Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data);
+
+cy_en_flashdrv_status_t __wrap_Cy_Flash_EraseRow(uint32_t rowAddr);
+cy_en_flashdrv_status_t __wrap_Cy_Flash_ProgramRow(uint32_t rowAddr, const uint32_t *data);
+cy_en_flashdrv_status_t __wrap_Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data);
+
+cy_en_flashdrv_status_t __wrap_Cy_Flash_EraseRow(uint32_t rowAddr)
+{
+    cy_en_flashdrv_status_t st;
+
+    FLASH_TRACE_BEGIN("flash: erase row");
+    st = FLASH_ERASE_ROW(rowAddr);
+    FLASH_TRACE_END("flash: erase row");
+
+    return st;
+}
+
+cy_en_flashdrv_status_t __wrap_Cy_Flash_ProgramRow(uint32_t rowAddr, const uint32_t *data)
+{
+    cy_en_flashdrv_status_t st;
+
+    FLASH_TRACE_BEGIN("flash: program row");
+    st = FLASH_PROGRAM_ROW(rowAddr, data);
+    FLASH_TRACE_END("flash: program row");
+
+    return st;
+}
+
+cy_en_flashdrv_status_t __wrap_Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data)
+{
+    cy_en_flashdrv_status_t st;
+
+    FLASH_TRACE_BEGIN("flash: write row");
+    st = FLASH_WRITE_ROW(rowAddr, data);
+    FLASH_TRACE_END("flash: write row");
+
+    return st;
+}
+
+#endif /* CY_FLASH_WRAP_EXT_SLOT || UBM_TRACE_FLASH */
+
+/* [] END OF FILE */
@@ -33,6 +33,28 @@
 /* UBM header file */
 #include "mtb_ubm.h"
 #include "mtb_ubm_config.h"
+
+/* Boot phase timestamps recorded by the bootloader */
+#include "boot_timing.h"
+
+/* Tokenized log, drained by the hosts */
+#include "ubm_log.h"
+
+/* Stack and heap high-water marks */
+#include "ram_usage.h"
+
+/* Coalescing of the CHANGE_DETECT# signals */
+#include "change_detect.h"
+
+#ifdef CLOCK_GOVERNOR
+/* CM4 clock scaling when idle */
+#include "clock_governor.h"
+#endif
+
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+/* External flash holding the secondary slot */
+#include "flash_qspi_ext.h"
+#endif
 /*******************************************************************************
 * Macros
 ********************************************************************************/
@@ -46,6 +68,19 @@
     #define FW_VERSION 0x20
 #endif
 
+/* Report the reset to UBM ready time, in milliseconds, in the vendor-specific
+ * field of the Silicon Identity and Version command so that it can be
+ * collected per unit by the hosts. Replaces the vendor-specific value of the
+ * configuration, off by default. */
+#ifndef REPORT_BOOT_TIME
+#define REPORT_BOOT_TIME                (0U)
+#endif
+
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+/* Slave Select line of the external flash, as in the bootloader */
+#define QSPI_SLAVE_SELECT_LINE          (1UL)
+#endif
+
 /*******************************************************************************
 * Function Prototypes
 ********************************************************************************/
@@ -55,6 +90,9 @@ mtb_stc_ubm_backplane_cfg_t ubm_backplane_configuration;
 mtb_stc_ubm_backplane_control_signals_t ubm_backplane_control_signals;
 mtb_stc_ubm_context_t ubm_context;
 
+/* Boot phase timestamps, filled in by the bootloader before the jump */
+BOOT_SHARED_SECTION boot_timing_t boot_timing;
+
 /* The size of data to store in EEPROM. Note the flash size used will be
  * the closest multiple of the flash row size */
 #define DATA_SIZE                       (256)
@@ -540,6 +578,13 @@ mtb_stc_ubm_backplane_control_signals_t ubm_backplane_control_signals =
  ******************************************************************************/
 int main(void)
 {
+    bool boot_timing_valid = boot_timing_is_valid();
+
+    if (boot_timing_valid)
+    {
+        boot_timing_mark(BOOT_TIMING_APP_ENTRY);
+    }
+
     /* Update watchdog timer to mark successful start up of application */
     cy_wdg_kick();
     cy_wdg_free();
@@ -550,26 +595,94 @@ int main(void)
     result = cybsp_init();
     CY_ASSERT(result == CY_RSLT_SUCCESS);
 
+    /* Keeps the records of the previous run */
+    ubm_log_init();
+
+    /* Paints the unused stack, before any interrupt uses it */
+    ram_usage_init();
+
     /* Enable global interrupts */
     __enable_irq();
-    
+
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+    /* The SMIF is brought up by the first write of an upgrade image, a
+     * normal start does not wait for it.
+     */
+    qspi_defer_init(QSPI_SLAVE_SELECT_LINE, NULL);
+#endif
 
     CY_ASSERT(result == CY_RSLT_SUCCESS);
     
     (void) result; /* To avoid compiler warning in release build */
 
+    if (boot_timing_valid)
+    {
+        UBM_LOG("Started, reset reason 0x%x, swap type %d",
+                boot_timing.reset_reason, boot_timing.swap_type);
+
+        /* Only set by a bootloader built with USE_CRYPTO_SELF_TEST=1 */
+        if (0UL != boot_timing.crypto_ecdsa_cycles)
+        {
+            UBM_LOG("Boot: crypto SHA-256 %u us, ECDSA verify %u us",
+                    boot_timing_to_us(boot_timing.crypto_sha256_cycles),
+                    boot_timing_to_us(boot_timing.crypto_ecdsa_cycles));
+        }
+    }
+
     mtb_en_ubm_status_t status = mtb_ubm_init(&ubm_backplane_configuration, &ubm_backplane_control_signals, &ubm_context);
 
+    UBM_LOG("UBM init status %u", status);
+    UBM_TRACE_INSTANT("ubm: init done", status);
+
     if (status != MTB_UBM_STATUS_SUCCESS)
     {
     	CY_ASSERT(0);
     }
 
+    /* The pins are configured by mtb_ubm_init() */
+    change_detect_init(&ubm_backplane_control_signals);
+
+#ifdef CLOCK_GOVERNOR
+    clock_governor_init();
+#endif
+
+    if (boot_timing_valid)
+    {
+        boot_timing_mark(BOOT_TIMING_APP_READY);
+        UBM_LOG("Boot: UBM ready %u us after reset",
+                boot_timing_to_us(boot_timing.stamp[BOOT_TIMING_APP_READY]));
+
+#if (REPORT_BOOT_TIME)
+        /* The middleware answers the command from the configuration given
+         * to mtb_ubm_init(). A command served before this point reports the
+         * configured vendor-specific value.
+         */
+        uint32_t boot_time_ms = boot_timing_to_us(boot_timing.stamp[BOOT_TIMING_APP_READY]) / 1000UL;
+
+        ubm_backplane_configuration.silicon_identity.vendor_specific =
+            (uint16_t)((boot_time_ms > UINT16_MAX) ? UINT16_MAX : boot_time_ms);
+#endif /* REPORT_BOOT_TIME */
+    }
+
 
     for (;;)
     {
+        bool busy;
+
+        change_detect_poll();
+        ram_usage_update();
 
     	/* User application */
+
+        busy = change_detect_pending();
+#ifdef CY_FLASH_WRAP_EXT_SLOT
+        busy = qspi_async_process() || qspi_read_busy() || busy;
+#endif
+#ifdef CLOCK_GOVERNOR
+        clock_governor_idle(busy);
+#else
+        (void)busy;
+#endif
     }
 
     return 0;
@@ -83,8 +83,11 @@ extern "C" {
  *  configuration file ubm_flash_map/psoc62_swap_single_custom.json. */
 #define MTB_UBM_UPGRADE_AREA_SIZE               USER_APP_SIZE
 
-/** The starting address of the upgrade image area. */
-#define MTB_UBM_UPGRADE_IMAGE_START_ADDRESS     (MTB_UBM_UPGRADE_AREA_START_ADDRESS + MTB_UBM_UPGRADE_AREA_SIZE)
+/** The starting address of the upgrade image area. This is the secondary slot,
+ *  or with direct-XIP the slot the running image is not linked for. With the
+ *  secondary slot in the external flash this is an address in the SMIF XIP
+ *  window, the writes to it are redirected to the SMIF by flash_qspi.c. */
+#define MTB_UBM_UPGRADE_IMAGE_START_ADDRESS     USER_APP_UPGRADE_START
 #endif /* (MTB_UBM_UPDATE_MODE_CAPABILITIES != MTB_UBM_UPDATE_NOT_SUPPORTED) */
 
 /** Special chips are used to control the RefClk signal of the PCIe. The UBM
@@ -0,0 +1,142 @@
+/******************************************************************************
+* File Name:   ram_usage.c
+*
+* Description: RAM usage of the UBM controller application, see ram_usage.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#include <stddef.h>
+#include <unistd.h>
+#include "cy_device_headers.h"
+#include "ram_usage.h"
+#include "ubm_log.h"
+#include "clock_governor.h"
+
+/*******************************************************************************
+* External symbols, defined by the linker script
+********************************************************************************/
+extern uint32_t __ram_vectors_start__[], __ram_vectors_end__[];
+extern uint32_t __data_start__[], __data_end__[];
+extern uint32_t __noinit_start__[], __noinit_end__[];
+extern uint32_t __bss_start__[], __bss_end__[];
+extern uint32_t __HeapBase[], __HeapLimit[];
+extern uint32_t __StackLimit[], __StackTop[];
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Bounds of the RAM regions, indexed by ram_usage_region_t */
+static uint32_t * const ram_usage_bounds[RAM_USAGE_REGIONS][2] =
+{
+    [RAM_USAGE_VECTORS] = { __ram_vectors_start__, __ram_vectors_end__ },
+    [RAM_USAGE_DATA]    = { __data_start__, __data_end__ },
+    [RAM_USAGE_NOINIT]  = { __noinit_start__, __noinit_end__ },
+    [RAM_USAGE_BSS]     = { __bss_start__, __bss_end__ },
+    [RAM_USAGE_HEAP]    = { __HeapBase, __HeapLimit },
+    [RAM_USAGE_STACK]   = { __StackLimit, __StackTop },
+};
+
+static uint32_t stack_max;
+static uint32_t heap_max;
+static uint32_t last_update;
+
+/*******************************************************************************
+* Function Name: ram_usage_init
+********************************************************************************
+* Summary:
+*  Paints the part of the stack below the current stack pointer and logs the
+*  size of the static RAM sections. Called at the start of main(), before the
+*  interrupts are enabled.
+*
+*******************************************************************************/
+void ram_usage_init(void)
+{
+    uint32_t *word = __StackLimit;
+    uint32_t *sp = (uint32_t *)__get_MSP();
+
+    while (word < sp)
+    {
+        *word = RAM_USAGE_PAINT;
+        word++;
+    }
+
+    UBM_LOG("RAM: static %u bytes, heap and stack %u bytes",
+            (uint32_t)__bss_end__ - (uint32_t)__ram_vectors_start__,
+            (uint32_t)__StackTop - (uint32_t)__HeapBase);
+}
+
+/*******************************************************************************
+* Function Name: ram_usage_update
+********************************************************************************
+* Summary:
+*  Updates the high-water marks of the stack and the heap, and logs them when
+*  they have grown by RAM_USAGE_LOG_STEP. Called from the main loop, the
+*  stack scan, which reads the words not used so far, runs once every
+*  RAM_USAGE_PERIOD_MS.
+*
+*******************************************************************************/
+void ram_usage_update(void)
+{
+    const uint32_t *word = __StackLimit;
+    uint32_t now = clock_governor_cycles();
+    uint32_t used;
+
+    if ((now - last_update) < (RAM_USAGE_PERIOD_MS * (SystemCoreClock / 1000UL)))
+    {
+        return;
+    }
+    last_update = now;
+
+    while ((word < __StackTop) && (RAM_USAGE_PAINT == *word))
+    {
+        word++;
+    }
+
+    used = (uint32_t)__StackTop - (uint32_t)word;
+    if (used >= (stack_max + RAM_USAGE_LOG_STEP))
+    {
+        UBM_LOG("RAM: stack high water %u of %u bytes",
+                used, (uint32_t)__StackTop - (uint32_t)__StackLimit);
+    }
+    if (used > stack_max)
+    {
+        stack_max = used;
+    }
+
+    used = (uint32_t)sbrk(0) - (uint32_t)__HeapBase;
+    if (used >= (heap_max + RAM_USAGE_LOG_STEP))
+    {
+        UBM_LOG("RAM: heap high water %u of %u bytes",
+                used, (uint32_t)__HeapLimit - (uint32_t)__HeapBase);
+    }
+    if (used > heap_max)
+    {
+        heap_max = used;
+    }
+}
+
+/*******************************************************************************
+* Function Name: ram_usage_get
+********************************************************************************
+* Summary:
+*  Returns the size of the RAM regions and the high-water marks, as of the
+*  last stack scan of ram_usage_update().
+*
+* Parameters:
+*  usage - Filled in with the RAM usage
+*
+*******************************************************************************/
+void ram_usage_get(ram_usage_t *usage)
+{
+    for (size_t i = 0U; i < (size_t)RAM_USAGE_REGIONS; i++)
+    {
+        usage->size[i] = (uint32_t)ram_usage_bounds[i][1] - (uint32_t)ram_usage_bounds[i][0];
+    }
+
+    usage->stack_max = stack_max;
+    usage->heap_max = heap_max;
+}
@@ -0,0 +1,72 @@
+/******************************************************************************
+* File Name:   ram_usage.h
+*
+* Description: RAM usage of the UBM controller application: the size of the
+*              static RAM sections, as placed by the linker script, and the
+*              high-water marks of the stack and the heap.
+*
+*              The unused part of the stack is painted with a pattern at
+*              startup, ram_usage_update() finds the deepest word overwritten
+*              since, every RAM_USAGE_PERIOD_MS. The heap high-water mark is
+*              the top of the heap given by sbrk(). A new high-water mark is
+*              recorded in the log.
+*
+*              The RAM used by each component is not in the image: it is
+*              printed from the map file by scripts/ram_report.py after each
+*              build.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(RAM_USAGE_H)
+#define RAM_USAGE_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Value of the stack words not used since startup */
+#define RAM_USAGE_PAINT                     (0x5AA55AA5UL)
+
+/* Minimum growth of a high-water mark to be logged, in bytes */
+#define RAM_USAGE_LOG_STEP                  (64UL)
+
+/* Interval of the stack scans of ram_usage_update() */
+#ifndef RAM_USAGE_PERIOD_MS
+#define RAM_USAGE_PERIOD_MS                 (100UL)
+#endif
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+/* RAM sections of the application, in address order */
+typedef enum
+{
+    RAM_USAGE_VECTORS = 0,  /* Interrupt vectors copied to RAM */
+    RAM_USAGE_DATA,         /* Initialized data and RAM functions */
+    RAM_USAGE_NOINIT,       /* Not initialized, including the log ring */
+    RAM_USAGE_BSS,          /* Zero initialized data */
+    RAM_USAGE_HEAP,         /* Heap, up to the stack */
+    RAM_USAGE_STACK,        /* Main stack */
+    RAM_USAGE_REGIONS
+} ram_usage_region_t;
+
+typedef struct
+{
+    uint32_t size[RAM_USAGE_REGIONS];   /* Size of each region, in bytes */
+    uint32_t stack_max;                 /* Deepest stack use, in bytes */
+    uint32_t heap_max;                  /* Highest heap top, in bytes */
+} ram_usage_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void ram_usage_init(void);
+void ram_usage_update(void);
+void ram_usage_get(ram_usage_t *usage);
+
+#endif /* RAM_USAGE_H */
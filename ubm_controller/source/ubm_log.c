@@ -0,0 +1,175 @@
+/******************************************************************************
+* File Name:   ubm_log.c
+*
+* Description: Tokenized binary logging of the UBM controller, see ubm_log.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#include <string.h>
+#include "cy_device_headers.h"
+#include "ubm_log.h"
+#include "clock_governor.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Marks the ring as initialized, checked after a reset */
+#define UBM_LOG_MAGIC                       (0x474F4C55UL)
+
+#define UBM_LOG_RING_MSK                    (UBM_LOG_RING_RECORDS - 1UL)
+#define UBM_LOG_SEQ_MSK                     (0xFFUL)
+
+/* Header of a record that is being written, no record has three arguments */
+#define UBM_LOG_HEADER_BUSY                 (3UL << UBM_LOG_NARGS_POS)
+
+#if ((UBM_LOG_RING_RECORDS & UBM_LOG_RING_MSK) != 0UL) || (UBM_LOG_RING_RECORDS > 128UL)
+#error "UBM_LOG_RING_RECORDS must be a power of two not above 128"
+#endif
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef struct
+{
+    uint32_t magic;
+    uint32_t head;          /* Records reserved since the ring was cleared */
+    uint32_t tail;          /* Next record to drain */
+    ubm_log_record_t ring[UBM_LOG_RING_RECORDS];
+} ubm_log_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Not cleared by the startup code, the records of the previous run are
+ * drained after a reset.
+ */
+CY_NOINIT static volatile ubm_log_t ubm_log;
+
+/*******************************************************************************
+* Function Name: ubm_log_init
+********************************************************************************
+* Summary:
+*  Clears the ring unless it holds the records of the previous run, and
+*  enables the DWT cycle counter used for the timestamps. Called once at the
+*  start of main().
+*
+*******************************************************************************/
+void ubm_log_init(void)
+{
+    if (UBM_LOG_MAGIC != ubm_log.magic)
+    {
+        (void)memset((void *)&ubm_log, 0, sizeof(ubm_log));
+        ubm_log.magic = UBM_LOG_MAGIC;
+    }
+
+    /* Already running when started by the bootloader */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/*******************************************************************************
+* Function Name: ubm_log_write
+********************************************************************************
+* Summary:
+*  Stores one record, called through UBM_LOG(). Safe to call from interrupts:
+*  the record index is reserved with an exclusive access, and the header is
+*  written last so that the reader skips a record that is not complete.
+*
+* Parameters:
+*  header - Token and argument count
+*  arg0   - First argument
+*  arg1   - Second argument
+*
+*******************************************************************************/
+void ubm_log_write(uint32_t header, uint32_t arg0, uint32_t arg1)
+{
+    volatile ubm_log_record_t *rec;
+    uint32_t seq;
+
+    do
+    {
+        seq = __LDREXW(&ubm_log.head);
+    } while (0UL != __STREXW(seq + 1UL, &ubm_log.head));
+
+    rec = &ubm_log.ring[seq & UBM_LOG_RING_MSK];
+    rec->header = UBM_LOG_HEADER_BUSY;
+    rec->stamp = clock_governor_cycles();
+    rec->arg[0] = arg0;
+    rec->arg[1] = arg1;
+    __DMB();
+    rec->header = header | (seq << UBM_LOG_SEQ_POS);
+}
+
+/*******************************************************************************
+* Function Name: ubm_log_drain
+********************************************************************************
+* Summary:
+*  Moves the complete records, oldest first, to buf. Overwritten records are
+*  reported by a record with the UBM_LOG_TOKEN_LOST token. Only one caller
+*  may drain at a time, normally the handler of the host read command.
+*
+* Parameters:
+*  buf  - Destination of the records
+*  size - Size of buf, in bytes
+*
+* Return:
+*  size_t - Number of bytes written to buf, a multiple of UBM_LOG_RECORD_SIZE
+*
+*******************************************************************************/
+size_t ubm_log_drain(uint8_t *buf, size_t size)
+{
+    ubm_log_record_t rec;
+    uint32_t head = ubm_log.head;
+    uint32_t tail = ubm_log.tail;
+    size_t len = 0U;
+
+    if ((head - tail) > UBM_LOG_RING_RECORDS)
+    {
+        if (size < UBM_LOG_RECORD_SIZE)
+        {
+            return 0U;
+        }
+
+        rec.header = UBM_LOG_TOKEN_LOST | (1UL << UBM_LOG_NARGS_POS);
+        rec.stamp = clock_governor_cycles();
+        rec.arg[0] = head - tail - UBM_LOG_RING_RECORDS;
+        rec.arg[1] = 0UL;
+        (void)memcpy(buf, &rec, sizeof(rec));
+        len = sizeof(rec);
+        tail = head - UBM_LOG_RING_RECORDS;
+    }
+
+    while ((tail != head) && ((size - len) >= UBM_LOG_RECORD_SIZE))
+    {
+        volatile const ubm_log_record_t *slot = &ubm_log.ring[tail & UBM_LOG_RING_MSK];
+
+        rec.header = slot->header;
+        __DMB();
+        rec.stamp = slot->stamp;
+        rec.arg[0] = slot->arg[0];
+        rec.arg[1] = slot->arg[1];
+        __DMB();
+
+        /* Stop at a record still being written, and at one a writer has
+         * overwritten while it was copied (reported as lost next time)
+         */
+        if ((((rec.header >> UBM_LOG_SEQ_POS) & UBM_LOG_SEQ_MSK) != (tail & UBM_LOG_SEQ_MSK)) ||
+            (UBM_LOG_HEADER_BUSY == (rec.header & UBM_LOG_HEADER_BUSY)) ||
+            ((ubm_log.head - tail) > UBM_LOG_RING_RECORDS))
+        {
+            break;
+        }
+
+        (void)memcpy(&buf[len], &rec, sizeof(rec));
+        len += sizeof(rec);
+        tail++;
+    }
+
+    ubm_log.tail = tail;
+
+    return len;
+}
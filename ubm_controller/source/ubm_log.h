@@ -0,0 +1,126 @@
+/******************************************************************************
+* File Name:   ubm_log.h
+*
+* Description: Tokenized binary logging and event trace of the UBM controller.
+*
+*              A log call stores no text on the device. The format string is
+*              placed in the ".ubm_log_fmt" section, which the linker script
+*              keeps in the ELF file only, and its offset in that section is
+*              the token of the record. A record is four words: header (token,
+*              kind, argument count and sequence number), DWT cycle count and
+*              up to two 32-bit arguments. The records go into a ring in the
+*              ".noinit" RAM section, so a log survives a reset, and are read
+*              out with ubm_log_drain(). scripts/ubm_log.py turns the drained
+*              records back into text using the ELF file, or into a
+*              Chrome/Perfetto trace.
+*
+*              Trace events (begin, end and instant) are records of their own
+*              kind, named by a string like the log format. Their second word
+*              is the active exception number (0 in the main loop), which
+*              gives the track of the event.
+*
+*              Writers may be in the main loop and in interrupts, the ring
+*              index is reserved with an exclusive access. When the ring is
+*              full the oldest records are overwritten.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#if !defined(UBM_LOG_H)
+#define UBM_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cy_device_headers.h"
+#include "cy_syslib.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of records in the ring, a power of two */
+#ifndef UBM_LOG_RING_RECORDS
+#define UBM_LOG_RING_RECORDS                (128UL)
+#endif
+
+/* Size of a drained record, in bytes */
+#define UBM_LOG_RECORD_SIZE                 (sizeof(ubm_log_record_t))
+
+/* Header fields */
+#define UBM_LOG_TOKEN_MSK                   (0x000FFFFFUL)
+#define UBM_LOG_KIND_POS                    (20U)
+#define UBM_LOG_NARGS_POS                   (22U)
+#define UBM_LOG_SEQ_POS                     (24U)
+
+/* Token of the record ubm_log_drain() puts in place of overwritten records,
+ * its first argument is the number of records lost.
+ */
+#define UBM_LOG_TOKEN_LOST                  (0UL)
+
+/* Places a format string in the section that is not loaded to the device */
+#define UBM_LOG_FMT_SECTION                 CY_SECTION(".ubm_log_fmt") CY_USED
+
+/* UBM_LOG(fmt, ...) logs fmt with zero to two integer arguments. Only
+ * integer conversions (%d, %u, %x, %c) are supported, the arguments are
+ * stored as 32-bit words.
+ */
+#define UBM_LOG(...) \
+    UBM_LOG_SELECT_(__VA_ARGS__, UBM_LOG_2_, UBM_LOG_1_, UBM_LOG_0_, 0)(__VA_ARGS__)
+
+#define UBM_LOG_SELECT_(_0, _1, _2, name, ...)  name
+
+#define UBM_LOG_0_(fmt)                     UBM_LOG_(fmt, 0U, 0UL, 0UL)
+#define UBM_LOG_1_(fmt, a0)                 UBM_LOG_(fmt, 1U, (a0), 0UL)
+#define UBM_LOG_2_(fmt, a0, a1)             UBM_LOG_(fmt, 2U, (a0), (a1))
+
+#define UBM_LOG_(fmt, nargs, a0, a1) \
+    UBM_LOG_RECORD_(fmt, UBM_LOG_KIND_TEXT, nargs, a0, a1)
+
+/* Trace events. The name identifies a begin with its end and is shown on
+ * the trace, an instant event carries one integer argument.
+ */
+#define UBM_TRACE_BEGIN(name) \
+    UBM_LOG_RECORD_(name, UBM_LOG_KIND_BEGIN, 0U, 0UL, __get_IPSR())
+#define UBM_TRACE_END(name) \
+    UBM_LOG_RECORD_(name, UBM_LOG_KIND_END, 0U, 0UL, __get_IPSR())
+#define UBM_TRACE_INSTANT(name, arg) \
+    UBM_LOG_RECORD_(name, UBM_LOG_KIND_INSTANT, 1U, (arg), __get_IPSR())
+
+#define UBM_LOG_RECORD_(fmt, kind, nargs, a0, a1) \
+    do { \
+        static const char ubm_log_fmt_[] UBM_LOG_FMT_SECTION = fmt; \
+        ubm_log_write(((uint32_t)(uintptr_t)ubm_log_fmt_ & UBM_LOG_TOKEN_MSK) | \
+                      ((uint32_t)(kind) << UBM_LOG_KIND_POS) | \
+                      ((uint32_t)(nargs) << UBM_LOG_NARGS_POS), \
+                      (uint32_t)(a0), (uint32_t)(a1)); \
+    } while (false)
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef enum
+{
+    UBM_LOG_KIND_TEXT = 0,      /* UBM_LOG() */
+    UBM_LOG_KIND_BEGIN,         /* UBM_TRACE_BEGIN() */
+    UBM_LOG_KIND_END,           /* UBM_TRACE_END() */
+    UBM_LOG_KIND_INSTANT        /* UBM_TRACE_INSTANT() */
+} ubm_log_kind_t;
+
+typedef struct
+{
+    uint32_t header;        /* Token, kind, argument count, low bits of the sequence */
+    uint32_t stamp;         /* DWT cycle count, clock_governor_cycles() */
+    uint32_t arg[2];
+} ubm_log_record_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void ubm_log_init(void);
+void ubm_log_write(uint32_t header, uint32_t arg0, uint32_t arg1);
+size_t ubm_log_drain(uint8_t *buf, size_t size);
+
+#endif /* UBM_LOG_H */